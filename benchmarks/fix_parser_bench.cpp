@@ -0,0 +1,73 @@
+#include "FixParser.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <string_view>
+
+namespace {
+
+constexpr std::string_view kNewOrder = "8=FIX.4.2|35=D|11=1234567|55=NVDA|54=1|44=13550|38=200|";
+constexpr std::string_view kModifyOrder = "8=FIX.4.2|35=G|11=1234567|55=NVDA|54=1|44=13575|38=150|";
+constexpr std::string_view kCancelOrder = "8=FIX.4.2|35=F|11=1234567|";
+constexpr std::string_view kBadPrefix = "8=FIX.4.4|35=D|11=1234567|55=NVDA|54=1|44=13550|38=200|";
+
+void BM_ParseFixFields(benchmark::State& state, std::string_view message)
+{
+    for (auto _ : state) {
+        Fix::ParsedFixFields fields;
+        const bool ok = Fix::parseFixFields(message, fields);
+        benchmark::DoNotOptimize(ok);
+        benchmark::DoNotOptimize(fields);
+    }
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * message.size()));
+}
+BENCHMARK_CAPTURE(BM_ParseFixFields, new_order, kNewOrder);
+BENCHMARK_CAPTURE(BM_ParseFixFields, modify, kModifyOrder);
+BENCHMARK_CAPTURE(BM_ParseFixFields, cancel, kCancelOrder);
+BENCHMARK_CAPTURE(BM_ParseFixFields, rejected_prefix, kBadPrefix);
+
+template <typename T>
+void BM_ParseInteger(benchmark::State& state, std::string_view text)
+{
+    for (auto _ : state) {
+        T value{};
+        const bool ok = Fix::parseInteger(text, value);
+        benchmark::DoNotOptimize(ok);
+        benchmark::DoNotOptimize(value);
+    }
+}
+
+// BENCHMARK_CAPTURE cannot take a template-id directly.
+void BM_ParseU32(benchmark::State& state, std::string_view text) { BM_ParseInteger<std::uint32_t>(state, text); }
+void BM_ParseU64(benchmark::State& state, std::string_view text) { BM_ParseInteger<std::uint64_t>(state, text); }
+
+BENCHMARK_CAPTURE(BM_ParseU32, short, std::string_view("200"));
+BENCHMARK_CAPTURE(BM_ParseU32, long, std::string_view("4000000000"));
+BENCHMARK_CAPTURE(BM_ParseU32, invalid, std::string_view("12a45"));
+BENCHMARK_CAPTURE(BM_ParseU64, long, std::string_view("18000000000000000000"));
+
+// Full field extraction as processFixMessage does it for a new order.
+void BM_ParseNewOrder(benchmark::State& state)
+{
+    for (auto _ : state) {
+        Fix::ParsedFixFields fields;
+        std::uint64_t orderId = 0;
+        std::uint32_t price = 0;
+        std::uint32_t quantity = 0;
+        Side side;
+        const bool ok = Fix::parseFixFields(kNewOrder, fields) &&
+                        Fix::hasRequiredFields(fields, fields.msgType) &&
+                        Fix::parseInteger(fields.orderId, orderId) &&
+                        Fix::parseInteger(fields.price, price) &&
+                        Fix::parseInteger(fields.quantity, quantity) &&
+                        Fix::parseSide(fields.side, side);
+        benchmark::DoNotOptimize(ok);
+        benchmark::DoNotOptimize(orderId);
+        benchmark::DoNotOptimize(price);
+        benchmark::DoNotOptimize(quantity);
+    }
+}
+BENCHMARK(BM_ParseNewOrder);
+
+} // namespace
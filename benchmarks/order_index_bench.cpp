@@ -0,0 +1,99 @@
+#include "Order.h"
+#include "OrderbookPolicies.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace {
+
+// Same footprint as BasicOrderbook's locator: order pointer, level handle, book.
+struct BenchLocator {
+    OrderPointer order_{ nullptr };
+    void* location_{ nullptr };
+    void* book_{ nullptr };
+
+    bool isActive() const { return book_ != nullptr; }
+};
+
+// Matches the engine's preallocated order capacity.
+constexpr std::size_t kDirectCapacity = 5'000'000;
+constexpr std::size_t kProbeCount = 1 << 16;
+
+// Index filled with ids 1..occupancy, plus a shuffled probe list of resident ids.
+template <typename Index>
+struct Fixture {
+    std::unique_ptr<Index> index = std::make_unique<Index>(kDirectCapacity);
+    std::vector<OrderId> probes;
+
+    explicit Fixture(std::size_t occupancy)
+    {
+        static int dummyBook = 0;
+        for (OrderId id = 1; id <= occupancy; ++id) {
+            index->upsert(id, BenchLocator{ nullptr, nullptr, &dummyBook });
+        }
+        std::mt19937_64 rng(42);
+        std::uniform_int_distribution<OrderId> dist(1, occupancy);
+        probes.resize(kProbeCount);
+        for (auto& probe : probes) {
+            probe = dist(rng);
+        }
+    }
+};
+
+template <typename Index>
+void BM_IndexLookup(benchmark::State& state)
+{
+    Fixture<Index> fixture(static_cast<std::size_t>(state.range(0)));
+    std::size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(fixture.index->find(fixture.probes[i]));
+        i = (i + 1) & (kProbeCount - 1);
+    }
+}
+
+// Erase a resident id and insert it back: the steady-state cancel/add pair.
+template <typename Index>
+void BM_IndexEraseInsert(benchmark::State& state)
+{
+    Fixture<Index> fixture(static_cast<std::size_t>(state.range(0)));
+    int book = 0;
+    std::size_t i = 0;
+    for (auto _ : state) {
+        const OrderId id = fixture.probes[i];
+        fixture.index->erase(id);
+        fixture.index->upsert(id, BenchLocator{ nullptr, nullptr, &book });
+        i = (i + 1) & (kProbeCount - 1);
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * 2));
+}
+
+// Lookups for ids that were never inserted (duplicate-id checks on new orders).
+template <typename Index>
+void BM_IndexMiss(benchmark::State& state)
+{
+    const auto occupancy = static_cast<OrderId>(state.range(0));
+    Fixture<Index> fixture(static_cast<std::size_t>(occupancy));
+    OrderId id = occupancy + 1;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(fixture.index->contains(id));
+        id = (id < 2 * occupancy) ? id + 1 : occupancy + 1;
+    }
+}
+
+using Direct = DirectOrderIndex<BenchLocator>;
+using Hash = HashOrderIndex<BenchLocator>;
+
+#define ORDER_INDEX_OCCUPANCIES RangeMultiplier(10)->Range(1'000, 1'000'000)
+
+BENCHMARK_TEMPLATE(BM_IndexLookup, Direct)->ORDER_INDEX_OCCUPANCIES;
+BENCHMARK_TEMPLATE(BM_IndexLookup, Hash)->ORDER_INDEX_OCCUPANCIES;
+BENCHMARK_TEMPLATE(BM_IndexEraseInsert, Direct)->ORDER_INDEX_OCCUPANCIES;
+BENCHMARK_TEMPLATE(BM_IndexEraseInsert, Hash)->ORDER_INDEX_OCCUPANCIES;
+BENCHMARK_TEMPLATE(BM_IndexMiss, Direct)->ORDER_INDEX_OCCUPANCIES;
+BENCHMARK_TEMPLATE(BM_IndexMiss, Hash)->ORDER_INDEX_OCCUPANCIES;
+
+} // namespace
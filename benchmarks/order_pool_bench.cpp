@@ -0,0 +1,46 @@
+#include "OrderPool.h"
+#include "OrderbookPolicies.h"
+
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <cstdint>
+
+namespace {
+
+constexpr std::size_t kBatch = 64;
+constexpr std::size_t kChunkSize = 4096;
+
+// One pool shared by every benchmark thread, sized so the timed loop never grows it.
+template <typename Lock>
+BasicOrderPool<Order, Lock>& sharedPool()
+{
+    static BasicOrderPool<Order, Lock> pool(kChunkSize, (1 << 20) / kChunkSize);
+    return pool;
+}
+
+// A batch of allocations followed by a batch of frees, so the free list sees
+// real churn rather than the same slot bouncing back and forth.
+template <typename Lock>
+void BM_OrderPoolAllocateFree(benchmark::State& state)
+{
+    auto& pool = sharedPool<Lock>();
+    std::array<Order*, kBatch> orders{};
+    const OrderId base = static_cast<OrderId>(state.thread_index()) << 32;
+
+    for (auto _ : state) {
+        for (std::size_t i = 0; i < kBatch; ++i) {
+            orders[i] = pool.allocate(base + i, 10000u, 5u, Side::BUY, SymbolId{ 0 });
+        }
+        benchmark::DoNotOptimize(orders.data());
+        for (std::size_t i = 0; i < kBatch; ++i) {
+            pool.deallocate(orders[i]);
+        }
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * kBatch));
+}
+BENCHMARK_TEMPLATE(BM_OrderPoolAllocateFree, std::mutex)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_OrderPoolAllocateFree, SpinLock)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_OrderPoolAllocateFree, NullLock)->Threads(1);
+
+} // namespace
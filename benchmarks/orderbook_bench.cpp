@@ -0,0 +1,153 @@
+#include "Orderbook.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+
+namespace {
+
+constexpr SymbolId kSymbol = 0;
+constexpr std::uint32_t kBasePrice = 10'000;
+
+// Books preallocate their pools, so one instance per type is shared across runs.
+// Every benchmark leaves its book empty.
+template <typename Book>
+Book& sharedBook()
+{
+    static Book book;
+    return book;
+}
+
+template <typename Book>
+auto makeOrder(OrderId orderId, std::uint32_t price, std::uint32_t quantity, Side side)
+{
+    return std::make_shared<typename Book::Order>(orderId, price, quantity, side, kSymbol);
+}
+
+// One aggressive buy sweeping `depth` ask levels of one lot each. Only the
+// crossing addOrder (i.e. matchOrders) is timed; rebuilding the ladder is not.
+template <typename Book>
+void BM_MatchSweep(benchmark::State& state)
+{
+    auto& book = sharedBook<Book>();
+    const auto depth = static_cast<std::uint32_t>(state.range(0));
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        for (std::uint32_t level = 0; level < depth; ++level) {
+            book.addOrder(makeOrder<Book>(level + 1, kBasePrice + level, 1, Side::SELL));
+        }
+        auto aggressor = makeOrder<Book>(depth + 1, kBasePrice + depth - 1, depth, Side::BUY);
+        state.ResumeTiming();
+
+        auto trades = book.addOrder(aggressor);
+        benchmark::DoNotOptimize(trades.data());
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * depth));
+    state.counters["levels"] = depth;
+}
+
+// One aggressive buy taking a single ask level queued `depth` orders deep: the
+// per-order fill loop against a deep FIFO, where level layout matters most.
+template <typename Book>
+void BM_QueueSweep(benchmark::State& state)
+{
+    auto& book = sharedBook<Book>();
+    const auto depth = static_cast<std::uint32_t>(state.range(0));
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        for (std::uint32_t i = 0; i < depth; ++i) {
+            book.addOrder(makeOrder<Book>(i + 1, kBasePrice, 1 + i % 3, Side::SELL));
+        }
+        auto aggressor = makeOrder<Book>(depth + 1, kBasePrice, 3 * depth, Side::BUY);
+        state.ResumeTiming();
+
+        auto trades = book.addOrder(aggressor);
+        benchmark::DoNotOptimize(trades.data());
+
+        state.PauseTiming();
+        book.cancelOrder(depth + 1); // the aggressor's remainder
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * depth));
+    state.counters["orders"] = depth;
+}
+
+// Cancel the order currently in the middle of a single long price level, then
+// (untimed) re-queue it at the back so the queue length stays constant.
+template <typename Book>
+void BM_CancelMiddle(benchmark::State& state)
+{
+    auto& book = sharedBook<Book>();
+    const auto queueLength = static_cast<OrderId>(state.range(0));
+
+    std::deque<OrderId> queue;
+    for (OrderId id = 1; id <= queueLength; ++id) {
+        book.addOrder(makeOrder<Book>(id, kBasePrice, 1, Side::BUY));
+        queue.push_back(id);
+    }
+
+    for (auto _ : state) {
+        const auto middle = queue.begin() + static_cast<std::ptrdiff_t>(queue.size() / 2);
+        const OrderId victim = *middle;
+
+        book.cancelOrder(victim);
+
+        state.PauseTiming();
+        queue.erase(middle);
+        queue.push_back(victim);
+        book.addOrder(makeOrder<Book>(victim, kBasePrice, 1, Side::BUY));
+        state.ResumeTiming();
+    }
+
+    for (const OrderId id : queue) {
+        book.cancelOrder(id);
+    }
+    state.counters["queue_length"] = static_cast<double>(queueLength);
+}
+
+// A one-lot buy that misses the ask (range 0) or takes one lot of it (range 1),
+// sent as IOC or as the limit order plus cancel that clients used before IOC.
+// Building the order is timed in both.
+template <typename Book, bool kImmediate>
+void BM_ImmediateOrCancel(benchmark::State& state)
+{
+    auto& book = sharedBook<Book>();
+    const bool crosses = state.range(0) != 0;
+    book.addOrder(makeOrder<Book>(1, kBasePrice, 4'000'000'000u, Side::SELL));
+
+    OrderId orderId = 2;
+    for (auto _ : state) {
+        auto order = makeOrder<Book>(orderId, crosses ? kBasePrice : kBasePrice - 1, 1, Side::BUY);
+        if constexpr (kImmediate) {
+            order->setTimeInForce(TimeInForce::ImmediateOrCancel);
+        }
+        auto trades = book.addOrder(order);
+        benchmark::DoNotOptimize(trades.data());
+        if (!kImmediate && !crosses) {
+            book.cancelOrder(orderId);
+        }
+        ++orderId;
+    }
+
+    book.cancelOrder(1);
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()));
+}
+
+BENCHMARK_TEMPLATE(BM_MatchSweep, Orderbook)->RangeMultiplier(4)->Range(1, 1024);
+BENCHMARK_TEMPLATE(BM_MatchSweep, SingleThreadedOrderbook)->RangeMultiplier(4)->Range(1, 1024);
+BENCHMARK_TEMPLATE(BM_MatchSweep, SoALevelOrderbook)->RangeMultiplier(4)->Range(1, 1024);
+BENCHMARK_TEMPLATE(BM_QueueSweep, Orderbook)->RangeMultiplier(8)->Range(8, 4096);
+BENCHMARK_TEMPLATE(BM_QueueSweep, SoALevelOrderbook)->RangeMultiplier(8)->Range(8, 4096);
+BENCHMARK_TEMPLATE(BM_CancelMiddle, Orderbook)->RangeMultiplier(10)->Range(1'000, 100'000);
+BENCHMARK_TEMPLATE(BM_CancelMiddle, SingleThreadedOrderbook)->RangeMultiplier(10)->Range(1'000, 100'000);
+BENCHMARK_TEMPLATE(BM_CancelMiddle, SoALevelOrderbook)->RangeMultiplier(10)->Range(1'000, 100'000);
+BENCHMARK_TEMPLATE(BM_ImmediateOrCancel, Orderbook, false)->Arg(0)->Arg(1);
+BENCHMARK_TEMPLATE(BM_ImmediateOrCancel, Orderbook, true)->Arg(0)->Arg(1);
+BENCHMARK_TEMPLATE(BM_ImmediateOrCancel, SoALevelOrderbook, false)->Arg(0)->Arg(1);
+BENCHMARK_TEMPLATE(BM_ImmediateOrCancel, SoALevelOrderbook, true)->Arg(0)->Arg(1);
+
+} // namespace
@@ -1,15 +1,40 @@
 #include "om/Orderbook.h"
+#include "perf/PerfCounters.h"
+#include "server/LowLatency.h"
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <optional>
 #include <random>
+#include <sstream>
 #include <string>
+#include <string_view>
+#include <thread>
 #include <vector>
 
 namespace {
 
-std::vector<std::string> buildWorkload(std::size_t count) {
+constexpr std::size_t kLatencySampleStride = 256;
+const std::vector<std::size_t> kDefaultFootprintSizes = {10'000, 100'000, 1'000'000, 10'000'000};
+// Relative to the workspace root under `bazel run`, else the working directory.
+constexpr std::string_view kDefaultContentionCsv = "results/engine_compare/engine_contention_scaling.csv";
+constexpr AccountId kRiskAccounts = 64;
+
+struct PassResult {
+    std::size_t processed = 0;
+    double elapsedSec = 0.0;
+    std::vector<double> latenciesUs;
+    std::optional<PerfSample> counters;
+};
+
+// With `accounts`, orders carry tag 1 round-robin over accounts 0..accounts-1.
+std::vector<std::string> buildWorkload(std::size_t count, AccountId accounts = 0) {
     std::vector<std::string> messages;
     messages.reserve(count);
 
@@ -32,47 +57,629 @@ std::vector<std::string> buildWorkload(std::size_t count) {
             "|54=" + std::string(side) +
             "|44=" + std::to_string(price) +
             "|38=" + std::to_string(qty) + "|");
+        if (accounts != 0) {
+            messages.back() += "1=" + std::to_string(i % accounts) + "|";
+        }
     }
 
     return messages;
 }
 
-} // namespace
-
-int main(int argc, char** argv) {
-    const int durationSec = (argc > 1) ? std::max(1, std::atoi(argv[1])) : 10;
-    const std::size_t workloadSize = (argc > 2) ? static_cast<std::size_t>(std::max(1000, std::atoi(argv[2]))) : 2'000'000;
-
-    std::cout << "Engine benchmark starting\n";
-    std::cout << "Duration: " << durationSec << "s\n";
-    std::cout << "Pre-generated messages: " << workloadSize << "\n";
+// Every limit set, none tight enough to reject the workload: each order pays
+// for the full check and the exposure updates on accept, fill and removal.
+RiskConfig benchmarkRiskConfig() {
+    RiskConfig config;
+    config.accountCount = kRiskAccounts;
+    config.defaultLimits.maxOrderQuantity = 1'000;
+    config.defaultLimits.maxOrderNotional = 1'000'000'000;
+    config.defaultLimits.priceBandBps = 5'000;
+    config.defaultLimits.maxOpenOrders = 10'000'000;
+    config.defaultLimits.maxNetPosition = 1'000'000'000;
+    return config;
+}
 
-    Orderbook orderbook;
-    const auto messages = buildWorkload(workloadSize);
+template <typename Book>
+PassResult runPass(const std::vector<std::string>& messages, int durationSec, PerfCounters* counters,
+                   const RiskConfig* risk) {
+    Book orderbook;
+    if (risk) {
+        orderbook.enableRiskChecks(*risk);
+    }
+    PassResult result;
+    result.latenciesUs.reserve(static_cast<std::size_t>(durationSec) * 64 * 1024);
 
-    std::size_t processed = 0;
     std::size_t idx = 0;
 
+    // Counters cover the message loop only, not book construction or pool preallocation.
+    if (counters) {
+        counters->start();
+    }
+
     const auto start = std::chrono::steady_clock::now();
     const auto deadline = start + std::chrono::seconds(durationSec);
     while (std::chrono::steady_clock::now() < deadline) {
-        orderbook.processFixMessage(messages[idx]);
-        ++processed;
+        if (result.processed % kLatencySampleStride == 0) {
+            const auto t0 = std::chrono::steady_clock::now();
+            orderbook.processFixMessage(messages[idx]);
+            const auto t1 = std::chrono::steady_clock::now();
+            result.latenciesUs.push_back(std::chrono::duration<double, std::micro>(t1 - t0).count());
+        } else {
+            orderbook.processFixMessage(messages[idx]);
+        }
+        ++result.processed;
         ++idx;
         if (idx == messages.size()) {
             idx = 0;
         }
     }
     const auto end = std::chrono::steady_clock::now();
+    if (counters) {
+        result.counters = counters->stop();
+    }
+
+    result.elapsedSec = std::chrono::duration<double>(end - start).count();
+    return result;
+}
 
-    const std::chrono::duration<double> elapsed = end - start;
-    const double throughput = elapsed.count() > 0.0
-        ? static_cast<double>(processed) / elapsed.count()
+double percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    const std::size_t rank = static_cast<std::size_t>(p * static_cast<double>(sorted.size() - 1));
+    return sorted[rank];
+}
+
+void report(const std::string& label, PassResult result) {
+    const double throughput = result.elapsedSec > 0.0
+        ? static_cast<double>(result.processed) / result.elapsedSec
         : 0.0;
 
-    std::cout << "Processed: " << processed << " messages\n";
-    std::cout << "Elapsed: " << elapsed.count() << "s\n";
+    std::sort(result.latenciesUs.begin(), result.latenciesUs.end());
+    double sum = 0.0;
+    for (const double v : result.latenciesUs) {
+        sum += v;
+    }
+    const double mean = result.latenciesUs.empty() ? 0.0 : sum / static_cast<double>(result.latenciesUs.size());
+    const double p50 = percentile(result.latenciesUs, 0.50);
+    const double p999 = percentile(result.latenciesUs, 0.999);
+
+    std::cout << "[" << label << "]\n";
+    std::cout << "Processed: " << result.processed << " messages\n";
+    std::cout << "Elapsed: " << result.elapsedSec << "s\n";
     std::cout << "Throughput: " << throughput << " msgs/s\n";
+    std::cout << "Latency samples: " << result.latenciesUs.size() << "\n";
+    std::cout << "Mean latency (us): " << mean << "\n";
+    std::cout << "P50 latency (us): " << p50 << "\n";
+    std::cout << "P99 latency (us): " << percentile(result.latenciesUs, 0.99) << "\n";
+    std::cout << "P99.9 latency (us): " << p999 << "\n";
+    std::cout << "Max latency (us): " << (result.latenciesUs.empty() ? 0.0 : result.latenciesUs.back()) << "\n";
+    std::cout << "Jitter P99.9-P50 (us): " << (p999 - p50) << "\n";
+
+    if (!result.counters || result.processed == 0) {
+        return;
+    }
+    const PerfSample& sample = *result.counters;
+    const double messages = static_cast<double>(result.processed);
+    const auto perMessage = [&](PerfEvent event) {
+        std::cout << "  " << std::left << std::setw(24) << (std::string(perfEventName(event)) + "/msg:") << std::right;
+        if (sample.has(event)) {
+            std::cout << static_cast<double>(sample.get(event)) / messages << "\n";
+        } else {
+            std::cout << "n/a\n";
+        }
+    };
+    std::cout << "Hardware counters (user space, per message):\n";
+    perMessage(PerfEvent::Cycles);
+    perMessage(PerfEvent::Instructions);
+    std::cout << "  " << std::left << std::setw(24) << "IPC:" << std::right;
+    if (sample.has(PerfEvent::Cycles) && sample.has(PerfEvent::Instructions) && sample.get(PerfEvent::Cycles) > 0) {
+        std::cout << static_cast<double>(sample.get(PerfEvent::Instructions)) /
+                         static_cast<double>(sample.get(PerfEvent::Cycles)) << "\n";
+    } else {
+        std::cout << "n/a\n";
+    }
+    perMessage(PerfEvent::L1dMisses);
+    perMessage(PerfEvent::LlcMisses);
+    perMessage(PerfEvent::BranchMisses);
+    perMessage(PerfEvent::DtlbMisses);
+    if (sample.minCoverage < 1.0) {
+        std::cout << "  (counters multiplexed, scaled from " << sample.minCoverage * 100.0 << "% coverage)\n";
+    }
+}
+
+// Builds a resting, non-crossing book of `orders` orders over every symbol, both
+// sides and up to 100 prices per side, and returns its memory footprint.
+template <typename Book>
+OrderbookMemoryStats measureFootprint(std::size_t orders) {
+    Book orderbook;
+    std::string message;
+    for (std::size_t i = 0; i < orders; ++i) {
+        const bool buy = (i / kKnownSymbolCount) % 2 == 0;
+        const std::size_t offset = 1 + (i / (2 * kKnownSymbolCount)) % 100;
+        message = "8=FIX.4.2|35=D|11=" + std::to_string(i + 1) +
+                  "|55=" + std::to_string(i % kKnownSymbolCount) +
+                  "|54=" + (buy ? "1" : "2") +
+                  "|44=" + std::to_string(buy ? 100'000 - offset : 100'000 + offset) + "|38=1|";
+        orderbook.processFixMessage(message);
+    }
+    return orderbook.memoryStats();
+}
+
+void reportFootprint(const std::string& label, const std::vector<std::size_t>& sizes,
+                     OrderbookMemoryStats (*measure)(std::size_t)) {
+    const OrderbookMemoryStats empty = measure(0);
+    const auto perOrder = [](std::size_t bytes, std::size_t orders) {
+        return static_cast<double>(bytes) / static_cast<double>(orders);
+    };
+
+    std::cout << "[memory: " << label << "]\n";
+    std::cout << "Empty book: " << empty.totalBytes() / (1024 * 1024) << " MiB ("
+              << empty.orderSlotsReserved << " order slots of " << empty.orderSlotBytes << " bytes reserved)\n";
+    std::cout << std::setw(10) << "orders" << std::setw(11) << "total MiB" << std::setw(10) << "B/order"
+              << std::setw(10) << "marginal" << std::setw(8) << "pool" << std::setw(8) << "index"
+              << std::setw(8) << "ctrl" << std::setw(8) << "queue" << std::setw(8) << "levels"
+              << std::setw(8) << "books" << std::setw(9) << "levels#" << "\n";
+    std::cout << std::fixed << std::setprecision(1);
+    for (const std::size_t orders : sizes) {
+        const OrderbookMemoryStats stats = measure(orders);
+        std::cout << std::setw(10) << orders
+                  << std::setw(11) << static_cast<double>(stats.totalBytes()) / (1024.0 * 1024.0)
+                  << std::setw(10) << perOrder(stats.totalBytes(), orders)
+                  << std::setw(10) << perOrder(stats.totalBytes() - empty.totalBytes(), orders)
+                  << std::setw(8) << perOrder(stats.orderPoolBytes, orders)
+                  << std::setw(8) << perOrder(stats.orderIndexBytes, orders)
+                  << std::setw(8) << perOrder(stats.controlBlockBytes, orders)
+                  << std::setw(8) << perOrder(stats.levelQueueBytes, orders)
+                  << std::setw(8) << perOrder(stats.priceLevelBytes, orders)
+                  << std::setw(8) << perOrder(stats.symbolBookBytes + stats.topOfBookBytes, orders)
+                  << std::setw(9) << stats.priceLevels << "\n";
+    }
+    std::cout << std::defaultfloat << std::setprecision(6);
+    std::cout << "(B/order = total / orders; marginal excludes the empty book's preallocation; "
+                 "component columns are bytes per order)\n";
+}
+
+enum class SymbolSharing { Disjoint, Overlap };
+
+const char* sharingName(SymbolSharing sharing) {
+    return sharing == SymbolSharing::Disjoint ? "disjoint" : "overlap";
+}
+
+// One pre-generated workload per producer thread, same order mix as buildWorkload.
+// Order ids interleave across threads so they never collide. Disjoint: thread t
+// only trades symbols s with s % threads == t. Overlap: every thread draws from
+// the whole universe.
+std::vector<std::vector<std::string>> buildThreadWorkloads(std::size_t threads, std::size_t perThread,
+                                                           SymbolSharing sharing) {
+    std::vector<std::vector<std::string>> workloads(threads);
+    for (std::size_t t = 0; t < threads; ++t) {
+        std::mt19937 rng(static_cast<std::mt19937::result_type>(12345 + t));
+        std::uniform_int_distribution<int> sideDist(0, 1);
+        const std::size_t symbolSlots = sharing == SymbolSharing::Disjoint
+            ? (kKnownSymbolCount - 1 - t) / threads + 1
+            : kKnownSymbolCount;
+        std::uniform_int_distribution<std::size_t> slotDist(0, symbolSlots - 1);
+        std::uniform_int_distribution<int> priceDist(90'000, 110'000);
+        std::uniform_int_distribution<int> qtyDist(1, 10);
+
+        auto& messages = workloads[t];
+        messages.reserve(perThread);
+        for (std::size_t i = 0; i < perThread; ++i) {
+            const std::size_t slot = slotDist(rng);
+            const std::size_t symbol = sharing == SymbolSharing::Disjoint ? t + slot * threads : slot;
+            messages.push_back(
+                std::string("8=FIX.4.2|35=D|11=") + std::to_string(i * threads + t + 1) +
+                "|55=" + std::to_string(symbol) +
+                "|54=" + (sideDist(rng) == 0 ? "1" : "2") +
+                "|44=" + std::to_string(priceDist(rng)) +
+                "|38=" + std::to_string(qtyDist(rng)) + "|");
+        }
+    }
+    return workloads;
+}
+
+struct ThreadResult {
+    std::size_t processed = 0;
+    std::vector<double> latenciesUs;
+};
+
+struct ContentionResult {
+    double elapsedSec = 0.0;
+    std::vector<ThreadResult> threads;
+    LockContentionStats book;
+    LockContentionStats orderPool;
+};
+
+// All producers share one engine. They start together and stop at the deadline;
+// lock counters cover the measured interval only.
+template <typename Book>
+ContentionResult runContention(const std::vector<std::vector<std::string>>& workloads, int durationSec) {
+    Book orderbook;
+    ContentionResult result;
+    result.threads.resize(workloads.size());
+
+    std::atomic<std::size_t> ready{ 0 };
+    std::atomic<bool> go{ false };
+    std::atomic<bool> stop{ false };
+    std::vector<std::thread> producers;
+    for (std::size_t t = 0; t < workloads.size(); ++t) {
+        producers.emplace_back([&, t] {
+            const auto& messages = workloads[t];
+            ThreadResult& mine = result.threads[t];
+            mine.latenciesUs.reserve(static_cast<std::size_t>(durationSec) * 16 * 1024);
+            ready.fetch_add(1);
+            while (!go.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+            std::size_t idx = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                if (mine.processed % kLatencySampleStride == 0) {
+                    const auto t0 = std::chrono::steady_clock::now();
+                    orderbook.processFixMessage(messages[idx]);
+                    const auto t1 = std::chrono::steady_clock::now();
+                    mine.latenciesUs.push_back(std::chrono::duration<double, std::micro>(t1 - t0).count());
+                } else {
+                    orderbook.processFixMessage(messages[idx]);
+                }
+                ++mine.processed;
+                if (++idx == messages.size()) {
+                    idx = 0;
+                }
+            }
+        });
+    }
+
+    while (ready.load() < workloads.size()) {
+        std::this_thread::yield();
+    }
+    const auto before = orderbook.lockContention();
+    const auto start = std::chrono::steady_clock::now();
+    go.store(true, std::memory_order_release);
+    std::this_thread::sleep_for(std::chrono::seconds(durationSec));
+    stop.store(true, std::memory_order_relaxed);
+    for (auto& producer : producers) {
+        producer.join();
+    }
+    result.elapsedSec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    const auto after = orderbook.lockContention();
+    result.book = after.book - before.book;
+    result.orderPool = after.orderPool - before.orderPool;
+    return result;
+}
+
+using ContentionRunner = ContentionResult (*)(const std::vector<std::vector<std::string>>&, int);
+
+struct ContentionPoint {
+    std::size_t threads;
+    ContentionResult result;
+};
+
+void reportContention(const std::string& label, SymbolSharing sharing, const std::vector<ContentionPoint>& points,
+                      std::ostream* csv, std::string_view engineName) {
+    const auto perMessage = [](std::uint64_t value, std::size_t messages) {
+        return messages == 0 ? 0.0 : static_cast<double>(value) / static_cast<double>(messages);
+    };
+    const auto percent = [](std::uint64_t part, std::uint64_t whole) {
+        return whole == 0 ? 0.0 : 100.0 * static_cast<double>(part) / static_cast<double>(whole);
+    };
+
+    std::cout << "[contention: " << label << ", " << sharingName(sharing) << " symbols]\n";
+    std::cout << std::setw(8) << "threads" << std::setw(13) << "msgs/s" << std::setw(8) << "scale"
+              << std::setw(9) << "p50 us" << std::setw(9) << "p99 us" << std::setw(10) << "p99.9 us"
+              << std::setw(14) << "book wait ns" << std::setw(8) << "cont%"
+              << std::setw(14) << "pool wait ns" << std::setw(8) << "cont%" << "\n";
+
+    double baseline = 0.0;
+    for (const auto& [threads, result] : points) {
+        std::size_t processed = 0;
+        std::vector<double> all;
+        for (const auto& thread : result.threads) {
+            processed += thread.processed;
+            all.insert(all.end(), thread.latenciesUs.begin(), thread.latenciesUs.end());
+        }
+        std::sort(all.begin(), all.end());
+        const double throughput = result.elapsedSec > 0.0 ? static_cast<double>(processed) / result.elapsedSec : 0.0;
+        if (baseline == 0.0) {
+            baseline = throughput;
+        }
+
+        std::cout << std::fixed << std::setprecision(2)
+                  << std::setw(8) << threads << std::setw(13) << std::setprecision(0) << throughput
+                  << std::setprecision(2) << std::setw(8) << (baseline > 0.0 ? throughput / baseline : 0.0)
+                  << std::setw(9) << percentile(all, 0.50) << std::setw(9) << percentile(all, 0.99)
+                  << std::setw(10) << percentile(all, 0.999)
+                  << std::setw(14) << perMessage(result.book.waitNs, processed)
+                  << std::setw(8) << percent(result.book.contended, result.book.acquisitions)
+                  << std::setw(14) << perMessage(result.orderPool.waitNs, processed)
+                  << std::setw(8) << percent(result.orderPool.contended, result.orderPool.acquisitions) << "\n";
+        for (std::size_t t = 0; t < result.threads.size() && result.threads.size() > 1; ++t) {
+            auto latencies = result.threads[t].latenciesUs;
+            std::sort(latencies.begin(), latencies.end());
+            std::cout << "          thread " << t << ": " << result.threads[t].processed << " msgs, p50/p99/p99.9 us "
+                      << percentile(latencies, 0.50) << " / " << percentile(latencies, 0.99) << " / "
+                      << percentile(latencies, 0.999) << "\n";
+        }
+        std::cout << std::defaultfloat << std::setprecision(6);
+
+        if (csv == nullptr) {
+            continue;
+        }
+        const auto row = [&](const std::string& thread, std::size_t messages, const std::vector<double>& sorted,
+                             bool withLocks) {
+            *csv << engineName << ',' << sharingName(sharing) << ',' << threads << ',' << thread << ',' << messages
+                 << ',' << (result.elapsedSec > 0.0 ? static_cast<double>(messages) / result.elapsedSec : 0.0)
+                 << ',' << percentile(sorted, 0.50) << ',' << percentile(sorted, 0.99) << ','
+                 << percentile(sorted, 0.999);
+            if (withLocks) {
+                *csv << ',' << result.book.acquisitions << ',' << result.book.contended << ',' << result.book.waitNs
+                     << ',' << result.orderPool.acquisitions << ',' << result.orderPool.contended << ','
+                     << result.orderPool.waitNs;
+            } else {
+                *csv << ",,,,,,";
+            }
+            *csv << '\n';
+        };
+        row("all", processed, all, true);
+        for (std::size_t t = 0; t < result.threads.size(); ++t) {
+            auto latencies = result.threads[t].latenciesUs;
+            std::sort(latencies.begin(), latencies.end());
+            row(std::to_string(t), result.threads[t].processed, latencies, false);
+        }
+    }
+    std::cout << "(scale = throughput / first row; wait columns are lock wait ns per message "
+                 "and the share of acquisitions that had to wait)\n";
+}
+
+using PassRunner = PassResult (*)(const std::vector<std::string>&, int, PerfCounters*, const RiskConfig*);
+using FootprintProbe = OrderbookMemoryStats (*)(std::size_t);
+
+struct EngineVariant {
+    const char* name;
+    const char* description;
+    PassRunner run;
+    FootprintProbe footprint;
+    // Same policies with a ProfiledLock; null for engines that are not thread-safe
+    // or differ from another variant only off the lock path.
+    ContentionRunner contention;
+};
+
+// Each entry is a separate BasicOrderbook instantiation, so the comparison covers
+// what the compiler does with the policy rather than a runtime switch.
+const std::vector<EngineVariant>& engineVariants() {
+    static const std::vector<EngineVariant> variants = {
+        { "mutex", "Orderbook (std::mutex, direct index)", &runPass<Orderbook>, &measureFootprint<Orderbook>,
+          &runContention<ProfiledOrderbook> },
+        { "spin", "SpinLockOrderbook", &runPass<SpinLockOrderbook>, &measureFootprint<SpinLockOrderbook>,
+          &runContention<ProfiledSpinLockOrderbook> },
+        { "none", "SingleThreadedOrderbook (no lock)", &runPass<SingleThreadedOrderbook>, &measureFootprint<SingleThreadedOrderbook>,
+          nullptr },
+        { "hash", "HashIndexOrderbook (hash order index)", &runPass<HashIndexOrderbook>, &measureFootprint<HashIndexOrderbook>,
+          nullptr },
+        { "wide", "WideOrderbook (64-bit price/qty)", &runPass<WideOrderbook>, &measureFootprint<WideOrderbook>,
+          nullptr },
+        { "soa", "SoALevelOrderbook (structure-of-arrays levels)", &runPass<SoALevelOrderbook>,
+          &measureFootprint<SoALevelOrderbook>, nullptr },
+    };
+    return variants;
+}
+
+const EngineVariant* findEngine(std::string_view name) {
+    for (const auto& variant : engineVariants()) {
+        if (name == variant.name) {
+            return &variant;
+        }
+    }
+    return nullptr;
+}
+
+std::vector<std::size_t> parseSizeList(std::string_view text) {
+    std::vector<std::size_t> values;
+    std::stringstream list{ std::string(text) };
+    std::string value;
+    while (std::getline(list, value, ',')) {
+        if (!value.empty()) {
+            values.push_back(std::stoull(value));
+        }
+    }
+    return values;
+}
+
+// Runs each thread count with both symbol layouts (or one) and writes every
+// row to the CSV as well.
+int runContentionMode(const std::vector<const EngineVariant*>& engines, std::vector<std::size_t> threadCounts,
+                      const std::vector<SymbolSharing>& sharings, int durationSec, std::size_t workloadSize,
+                      const std::string& csvPath) {
+    if (threadCounts.size() == 1) {
+        // --threads=N: powers of two up to N, then N.
+        const std::size_t maxThreads = threadCounts.front();
+        threadCounts.clear();
+        for (std::size_t n = 1; n < maxThreads; n *= 2) {
+            threadCounts.push_back(n);
+        }
+        threadCounts.push_back(maxThreads);
+    }
+    for (const std::size_t threads : threadCounts) {
+        if (threads == 0 || threads > kKnownSymbolCount) {
+            std::cerr << "Thread counts must be between 1 and " << kKnownSymbolCount << "\n";
+            return 1;
+        }
+    }
+
+    std::ofstream csv;
+    if (!csvPath.empty()) {
+        const std::filesystem::path path(csvPath);
+        if (path.has_parent_path()) {
+            std::filesystem::create_directories(path.parent_path());
+        }
+        csv.open(path);
+        if (!csv) {
+            std::cerr << "Cannot write " << csvPath << "\n";
+            return 1;
+        }
+        csv << std::fixed << std::setprecision(3);
+        csv << "engine,symbols,threads,thread,processed,throughput_msgs_s,p50_us,p99_us,p999_us,"
+               "book_acquisitions,book_contended,book_wait_ns,pool_acquisitions,pool_contended,pool_wait_ns\n";
+    }
+
+    const std::size_t maxThreads = *std::max_element(threadCounts.begin(), threadCounts.end());
+    const std::size_t perThread = std::max<std::size_t>(1000, workloadSize / maxThreads);
+    std::cout << "Contention benchmark: " << durationSec << "s per point, " << perThread
+              << " pre-generated messages per thread, hardware threads: " << std::thread::hardware_concurrency() << "\n";
+
+    for (const auto* engine : engines) {
+        if (engine->contention == nullptr) {
+            std::cout << "[contention: " << engine->description << "] skipped, no profiled lock variant\n";
+            continue;
+        }
+        for (const SymbolSharing sharing : sharings) {
+            std::vector<ContentionPoint> points;
+            for (const std::size_t threads : threadCounts) {
+                const auto workloads = buildThreadWorkloads(threads, perThread, sharing);
+                points.push_back({ threads, engine->contention(workloads, durationSec) });
+            }
+            reportContention(engine->description, sharing, points, csv.is_open() ? &csv : nullptr, engine->name);
+        }
+    }
+    if (csv.is_open()) {
+        std::cout << "Wrote scaling curves to " << csvPath << "\n";
+    }
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    // Positional: [durationSec] [workloadSize] [pinnedCpu]; --engines=a,b,... and --no-perf anywhere.
+    // --memory[=N,N,...] reports the footprint per resting order instead of timing.
+    // --threads=N or --threads=A,B,... runs producer threads against one engine
+    // (--symbols=disjoint|overlap, both by default; --contention-csv=PATH).
+    // --risk runs each engine with pre-trade risk checks off, then on.
+    std::vector<std::string> positional;
+    std::vector<std::size_t> threadCounts;
+    std::vector<SymbolSharing> sharings;
+    std::optional<std::string> contentionCsv;
+    std::vector<const EngineVariant*> engines;
+    bool usePerfCounters = true;
+    std::vector<std::size_t> footprintSizes;
+    bool compareRisk = false;
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg(argv[i]);
+        if (arg == "--no-perf") {
+            usePerfCounters = false;
+        } else if (arg == "--risk") {
+            compareRisk = true;
+        } else if (arg == "--memory") {
+            footprintSizes = kDefaultFootprintSizes;
+        } else if (arg.rfind("--memory=", 0) == 0) {
+            footprintSizes = parseSizeList(arg.substr(9));
+        } else if (arg.rfind("--threads=", 0) == 0) {
+            threadCounts = parseSizeList(arg.substr(10));
+        } else if (arg == "--symbols=disjoint") {
+            sharings = { SymbolSharing::Disjoint };
+        } else if (arg == "--symbols=overlap") {
+            sharings = { SymbolSharing::Overlap };
+        } else if (arg.rfind("--contention-csv=", 0) == 0) {
+            contentionCsv = std::string(arg.substr(17));
+        } else if (arg.rfind("--engines=", 0) == 0) {
+            std::stringstream list{ std::string(arg.substr(10)) };
+            std::string name;
+            while (std::getline(list, name, ',')) {
+                if (name.empty()) {
+                    continue;
+                }
+                const auto* engine = findEngine(name);
+                if (!engine) {
+                    std::cerr << "Unknown engine '" << name << "' (available:";
+                    for (const auto& variant : engineVariants()) {
+                        std::cerr << " " << variant.name;
+                    }
+                    std::cerr << ")\n";
+                    return 1;
+                }
+                engines.push_back(engine);
+            }
+        } else {
+            positional.emplace_back(arg);
+        }
+    }
+    if (engines.empty()) {
+        engines.push_back(&engineVariants().front());
+    }
+
+    if (!footprintSizes.empty()) {
+        for (const auto* engine : engines) {
+            reportFootprint(engine->description, footprintSizes, engine->footprint);
+        }
+        return 0;
+    }
+
+    const int durationSec = (positional.size() > 0) ? std::max(1, std::atoi(positional[0].c_str())) : 10;
+    const std::size_t workloadSize = (positional.size() > 1) ? static_cast<std::size_t>(std::max(1000, std::atoi(positional[1].c_str()))) : 2'000'000;
+
+    if (!threadCounts.empty()) {
+        if (sharings.empty()) {
+            sharings = { SymbolSharing::Disjoint, SymbolSharing::Overlap };
+        }
+        if (!contentionCsv) {
+            const char* workspace = std::getenv("BUILD_WORKSPACE_DIRECTORY");
+            contentionCsv = (std::filesystem::path(workspace ? workspace : ".") / kDefaultContentionCsv).string();
+        }
+        return runContentionMode(engines, threadCounts, sharings, durationSec, workloadSize, *contentionCsv);
+    }
+    // Optional CPU: run a second pass pinned to it with mlockall, to compare jitter.
+    const int pinnedCpu = (positional.size() > 2) ? std::atoi(positional[2].c_str()) : -1;
+
+    std::cout << "Engine benchmark starting\n";
+    std::cout << "Duration: " << durationSec << "s\n";
+    std::cout << "Pre-generated messages: " << workloadSize << "\n";
+    std::cout << "Latency sample stride: every " << kLatencySampleStride << " messages\n";
+
+    // The risk comparison tags both passes with accounts so they parse the same messages.
+    const auto messages = buildWorkload(workloadSize, compareRisk ? kRiskAccounts : 0);
+
+    std::optional<PerfCounters> perfCounters;
+    if (usePerfCounters) {
+        perfCounters.emplace();
+        if (!perfCounters->available()) {
+            std::cout << "Hardware counters unavailable: " << perfCounters->unavailableReason() << "\n";
+            perfCounters.reset();
+        }
+    }
+    PerfCounters* counters = perfCounters ? &*perfCounters : nullptr;
+
+    if (compareRisk) {
+        const RiskConfig risk = benchmarkRiskConfig();
+        const auto nsPerMessage = [](const PassResult& result) {
+            return result.processed == 0 ? 0.0 : result.elapsedSec * 1e9 / static_cast<double>(result.processed);
+        };
+        for (const auto* engine : engines) {
+            PassResult off = engine->run(messages, durationSec, counters, nullptr);
+            PassResult on = engine->run(messages, durationSec, counters, &risk);
+            const double offNs = nsPerMessage(off);
+            const double onNs = nsPerMessage(on);
+            report(std::string("risk off: ") + engine->description, std::move(off));
+            report(std::string("risk on: ") + engine->description, std::move(on));
+            std::cout << "Risk check cost: " << (onNs - offNs) << " ns/msg (" << offNs << " -> " << onNs << ")\n";
+        }
+        return 0;
+    }
+
+    for (const auto* engine : engines) {
+        report(std::string("default: ") + engine->description, engine->run(messages, durationSec, counters, nullptr));
+    }
+
+    if (pinnedCpu >= 0) {
+        if (!pinCurrentThread(pinnedCpu)) {
+            std::cerr << "Failed to pin to CPU " << pinnedCpu << ", low-latency pass runs unpinned\n";
+        }
+        if (!lockAndPrefaultMemory()) {
+            std::cerr << "mlockall failed (check RLIMIT_MEMLOCK), low-latency pass runs unlocked\n";
+        }
+        for (const auto* engine : engines) {
+            report(std::string("low-latency: pinned + mlockall: ") + engine->description,
+                   engine->run(messages, durationSec, counters, nullptr));
+        }
+    }
 
     return 0;
 }
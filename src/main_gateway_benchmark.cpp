@@ -0,0 +1,209 @@
+#include "shm/ShmClient.h"
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <vector>
+
+// Round-trip latency of one order-entry client against a running main_server,
+// over TCP and over the shared-memory gateway (main_server --shm=NAME). Each
+// request waits for its reply before the next is sent, so the numbers are the
+// transport's round trip plus one engine command.
+//
+//   main_gateway_benchmark [--tcp=HOST:PORT] [--shm=NAME] [--count=N] [--warmup=N]
+//
+// The workload alternates a new order with its cancel on symbol 0, so the book
+// stays empty and every command costs the same.
+
+namespace {
+
+constexpr std::string_view kDefaultTcpEndpoint = "127.0.0.1:8000";
+constexpr std::size_t kDefaultCount = 100'000;
+constexpr std::size_t kDefaultWarmup = 10'000;
+// Far from anything a test client rests, so nothing matches.
+constexpr std::uint64_t kFirstOrderId = 900'000'000;
+
+class TcpTransport {
+public:
+    explicit TcpTransport(std::string_view endpoint) {
+        const std::size_t colon = endpoint.rfind(':');
+        if (colon == std::string_view::npos) {
+            throw std::invalid_argument("Expected HOST:PORT, got " + std::string(endpoint));
+        }
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(static_cast<std::uint16_t>(std::stoi(std::string(endpoint.substr(colon + 1)))));
+        if (inet_pton(AF_INET, std::string(endpoint.substr(0, colon)).c_str(), &address.sin_addr) != 1) {
+            throw std::invalid_argument("Bad IPv4 address in " + std::string(endpoint));
+        }
+        fd_ = socket(AF_INET, SOCK_STREAM, 0);
+        if (fd_ < 0 || connect(fd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+            throw std::runtime_error("Cannot connect to " + std::string(endpoint));
+        }
+        const int one = 1;
+        setsockopt(fd_, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    }
+    ~TcpTransport() {
+        if (fd_ >= 0) {
+            close(fd_);
+        }
+    }
+    TcpTransport(const TcpTransport&) = delete;
+    TcpTransport& operator=(const TcpTransport&) = delete;
+
+    bool request(const std::string& frame, std::string& reply) {
+        line_.assign(frame);
+        line_.push_back('\n');
+        for (std::size_t sent = 0; sent < line_.size();) {
+            const ssize_t n = send(fd_, line_.data() + sent, line_.size() - sent, 0);
+            if (n <= 0) {
+                return false;
+            }
+            sent += static_cast<std::size_t>(n);
+        }
+        std::size_t end;
+        while ((end = buffer_.find('\n')) == std::string::npos) {
+            char chunk[4096];
+            const ssize_t n = recv(fd_, chunk, sizeof(chunk), 0);
+            if (n <= 0) {
+                return false;
+            }
+            buffer_.append(chunk, static_cast<std::size_t>(n));
+        }
+        reply.assign(buffer_, 0, end);
+        buffer_.erase(0, end + 1);
+        return true;
+    }
+
+private:
+    int fd_ = -1;
+    std::string line_;
+    std::string buffer_;
+};
+
+class ShmTransport {
+public:
+    explicit ShmTransport(const std::string& name) : client_(name) {}
+
+    bool request(const std::string& frame, std::string& reply) {
+        return client_.request(frame, reply, std::chrono::seconds(5));
+    }
+
+private:
+    ShmClient client_;
+};
+
+std::vector<std::string> buildWorkload(std::size_t count) {
+    std::vector<std::string> frames;
+    frames.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        const std::string id = std::to_string(kFirstOrderId + i / 2);
+        if (i % 2 == 0) {
+            frames.push_back("8=FIX.4.2|35=D|11=" + id + "|55=0|54=1|44=1|38=1|");
+        } else {
+            frames.push_back("8=FIX.4.2|35=F|11=" + id + "|");
+        }
+    }
+    return frames;
+}
+
+double percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    const std::size_t rank = static_cast<std::size_t>(p * static_cast<double>(sorted.size() - 1));
+    return sorted[rank];
+}
+
+template <typename Transport>
+bool run(const std::string& label, Transport& transport, const std::vector<std::string>& frames, std::size_t warmup) {
+    std::string reply;
+    std::vector<double> rttUs;
+    rttUs.reserve(frames.size());
+    std::size_t errors = 0;
+
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < frames.size(); ++i) {
+        const auto sent = std::chrono::steady_clock::now();
+        if (!transport.request(frames[i], reply)) {
+            std::cerr << label << ": no reply to request " << i << "\n";
+            return false;
+        }
+        const auto received = std::chrono::steady_clock::now();
+        if (reply == "ERR") {
+            ++errors;
+        }
+        if (i >= warmup) {
+            rttUs.push_back(std::chrono::duration<double, std::micro>(received - sent).count());
+        }
+    }
+    const double elapsedSec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::sort(rttUs.begin(), rttUs.end());
+    double sum = 0.0;
+    for (const double v : rttUs) {
+        sum += v;
+    }
+    std::cout << "[" << label << "]\n";
+    std::cout << "Round trips: " << rttUs.size() << " (after " << warmup << " warm-up)\n";
+    std::cout << "Rejected: " << errors << "\n";
+    std::cout << "Throughput: " << static_cast<double>(frames.size()) / elapsedSec << " req/s\n";
+    std::cout << "Mean RTT (us): " << (rttUs.empty() ? 0.0 : sum / static_cast<double>(rttUs.size())) << "\n";
+    std::cout << "P50 RTT (us): " << percentile(rttUs, 0.50) << "\n";
+    std::cout << "P99 RTT (us): " << percentile(rttUs, 0.99) << "\n";
+    std::cout << "P99.9 RTT (us): " << percentile(rttUs, 0.999) << "\n";
+    std::cout << "Max RTT (us): " << (rttUs.empty() ? 0.0 : rttUs.back()) << "\n";
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string tcpEndpoint(kDefaultTcpEndpoint);
+    std::string shmName;
+    std::size_t count = kDefaultCount;
+    std::size_t warmup = kDefaultWarmup;
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg(argv[i]);
+        if (arg.rfind("--tcp=", 0) == 0) {
+            tcpEndpoint = std::string(arg.substr(6));
+        } else if (arg.rfind("--shm=", 0) == 0) {
+            shmName = std::string(arg.substr(6));
+        } else if (arg.rfind("--count=", 0) == 0) {
+            count = std::stoul(std::string(arg.substr(8)));
+        } else if (arg.rfind("--warmup=", 0) == 0) {
+            warmup = std::stoul(std::string(arg.substr(9)));
+        } else {
+            std::cerr << "Usage: main_gateway_benchmark [--tcp=HOST:PORT] [--shm=NAME] [--count=N] [--warmup=N]\n";
+            return 1;
+        }
+    }
+
+    // Each transport runs the same ids; the cancels leave the book as it was.
+    const std::vector<std::string> frames = buildWorkload(count + warmup + (count + warmup) % 2);
+    try {
+        TcpTransport tcp(tcpEndpoint);
+        if (!run("tcp " + tcpEndpoint, tcp, frames, warmup)) {
+            return 1;
+        }
+        if (!shmName.empty()) {
+            ShmTransport shm(shmName);
+            if (!run("shm " + shmName, shm, frames, warmup)) {
+                return 1;
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Fatal: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
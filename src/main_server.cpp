@@ -1,9 +1,315 @@
 #include "server/Server.h"
 #include "om/Orderbook.h"
+#include "om/SymbolTable.h"
+#include "server/LowLatency.h"
+#include "replication/Replication.h"
 
-int main() {
-    Orderbook orderbook;
-    Server server(8000, &orderbook); // Use desired port
-    server.run();
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <stdexcept>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+
+namespace {
+
+constexpr std::string_view kSymbolsFlag = "--symbols=";
+constexpr std::string_view kSymbolUniverseFlag = "--symbol-universe=";
+constexpr std::string_view kCpusFlag = "--cpus=";
+constexpr std::string_view kBusySpinFlag = "--busy-spin";
+constexpr std::string_view kMlockFlag = "--mlock";
+constexpr std::string_view kUdpPortFlag = "--udp-port=";
+constexpr std::string_view kMaxOutboundFlag = "--max-outbound-bytes=";
+constexpr std::string_view kOverflowPolicyFlag = "--overflow-policy=";
+constexpr std::string_view kMaxInboundRateFlag = "--max-inbound-rate=";
+constexpr std::string_view kReplicateToFlag = "--replicate-to=";
+constexpr std::string_view kReplicationModeFlag = "--replication-mode=";
+constexpr std::string_view kStandbyOfFlag = "--standby-of=";
+constexpr std::string_view kNoCancelOnDisconnectFlag = "--no-cancel-on-disconnect";
+constexpr std::string_view kExpiryTickFlag = "--expiry-tick-ms=";
+constexpr std::string_view kEndOfDayFlag = "--end-of-day=";
+constexpr std::string_view kTradeTapeFlag = "--trade-tape"; // optionally =SPILL_DIR
+constexpr std::string_view kRiskLimitsFlag = "--risk-limits=";
+constexpr std::string_view kRiskAccountsFlag = "--risk-accounts=";
+constexpr std::string_view kShmFlag = "--shm=";             // segment name
+constexpr std::string_view kShmSlotsFlag = "--shm-slots=";
+constexpr auto kStandbyConnectTimeout = std::chrono::seconds(30);
+constexpr auto kDefaultExpiryTick = std::chrono::milliseconds(10);
+
+OverflowPolicy parseOverflowPolicy(std::string_view name) {
+    if (name == "disconnect") {
+        return OverflowPolicy::Disconnect;
+    }
+    if (name == "conflate") {
+        return OverflowPolicy::Conflate;
+    }
+    if (name == "pause") {
+        return OverflowPolicy::PauseReading;
+    }
+    throw std::invalid_argument("Unknown overflow policy: " + std::string(name));
+}
+
+ReplicationMode parseReplicationMode(std::string_view name) {
+    if (name == "async") {
+        return ReplicationMode::Async;
+    }
+    if (name == "semisync") {
+        return ReplicationMode::SemiSync;
+    }
+    throw std::invalid_argument("Unknown replication mode: " + std::string(name));
+}
+
+// 1..kInvalidSymbolId-1; the top id is reserved for "no symbol".
+SymbolId parseSymbolUniverse(std::string_view text) {
+    std::size_t parsed = 0;
+    const std::string digits(text);
+    const unsigned long long size = digits.empty() || digits[0] == '-' ? 0 : std::stoull(digits, &parsed);
+    if (parsed != digits.size() || size == 0 || size >= kInvalidSymbolId) {
+        throw std::invalid_argument("Invalid --symbol-universe: " + digits + " (expected 1.." +
+                                    std::to_string(kInvalidSymbolId - 1) + ")");
+    }
+    return static_cast<SymbolId>(size);
+}
+
+// "HH:MM" (UTC) -> minutes after midnight.
+int parseEndOfDay(std::string_view text) {
+    const auto colon = text.find(':');
+    if (colon == std::string_view::npos) {
+        throw std::invalid_argument("Expected HH:MM for --end-of-day");
+    }
+    const int hours = std::stoi(std::string(text.substr(0, colon)));
+    const int minutes = std::stoi(std::string(text.substr(colon + 1)));
+    if (hours < 0 || hours > 23 || minutes < 0 || minutes > 59) {
+        throw std::invalid_argument("Invalid --end-of-day time: " + std::string(text));
+    }
+    return hours * 60 + minutes;
+}
+
+// "QTY,NOTIONAL,BAND_BPS,OPEN_ORDERS,NET_POSITION", 0 (or a missing field) for no limit.
+RiskLimits parseRiskLimits(std::string_view text) {
+    std::uint64_t values[5] = {};
+    std::size_t field = 0;
+    while (!text.empty()) {
+        if (field == 5) {
+            throw std::invalid_argument("Too many fields in --risk-limits");
+        }
+        const auto comma = text.find(',');
+        const std::string_view value = text.substr(0, comma);
+        if (!value.empty()) {
+            values[field] = std::stoull(std::string(value));
+        }
+        ++field;
+        text = comma == std::string_view::npos ? std::string_view{} : text.substr(comma + 1);
+    }
+    RiskLimits limits;
+    limits.maxOrderQuantity = values[0];
+    limits.maxOrderNotional = values[1];
+    limits.priceBandBps = static_cast<std::uint32_t>(values[2]);
+    limits.maxOpenOrders = static_cast<std::uint32_t>(values[3]);
+    limits.maxNetPosition = values[4];
+    return limits;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string symbolsPath;
+    SymbolId symbolUniverseSize = kKnownSymbolCount;
+    LowLatencyConfig lowLatency;
+    int udpPort = 0;
+    BackpressureConfig backpressure;
+    std::string replicateTo;
+    std::string standbyOf;
+    ReplicationMode replicationMode = ReplicationMode::Async;
+    bool cancelOnDisconnect = true;
+    std::chrono::milliseconds expiryTick = kDefaultExpiryTick;
+    int endOfDayMinuteUtc = -1;
+    std::optional<TradeTapeConfig> tradeTape;
+    std::optional<RiskConfig> risk;
+    std::optional<ShmGatewayConfig> shm;
+
+    try {
+        for (int i = 1; i < argc; ++i) {
+            const std::string_view arg(argv[i]);
+            if (arg.rfind(kSymbolsFlag, 0) == 0) {
+                symbolsPath = std::string(arg.substr(kSymbolsFlag.size()));
+            } else if (arg.rfind(kSymbolUniverseFlag, 0) == 0) {
+                symbolUniverseSize = parseSymbolUniverse(arg.substr(kSymbolUniverseFlag.size()));
+            } else if (arg.rfind(kCpusFlag, 0) == 0) {
+                lowLatency.cpus = parseCpuList(arg.substr(kCpusFlag.size()));
+            } else if (arg == kBusySpinFlag) {
+                lowLatency.busySpin = true;
+            } else if (arg == kMlockFlag) {
+                lowLatency.lockMemory = true;
+            } else if (arg.rfind(kUdpPortFlag, 0) == 0) {
+                udpPort = std::stoi(std::string(arg.substr(kUdpPortFlag.size())));
+            } else if (arg.rfind(kMaxOutboundFlag, 0) == 0) {
+                backpressure.maxOutboundBytes = std::stoul(std::string(arg.substr(kMaxOutboundFlag.size())));
+            } else if (arg.rfind(kOverflowPolicyFlag, 0) == 0) {
+                backpressure.overflowPolicy = parseOverflowPolicy(arg.substr(kOverflowPolicyFlag.size()));
+            } else if (arg.rfind(kMaxInboundRateFlag, 0) == 0) {
+                backpressure.maxInboundPerSecond = static_cast<std::uint32_t>(
+                    std::stoul(std::string(arg.substr(kMaxInboundRateFlag.size()))));
+            } else if (arg.rfind(kReplicateToFlag, 0) == 0) {
+                replicateTo = std::string(arg.substr(kReplicateToFlag.size()));
+            } else if (arg.rfind(kReplicationModeFlag, 0) == 0) {
+                replicationMode = parseReplicationMode(arg.substr(kReplicationModeFlag.size()));
+            } else if (arg.rfind(kStandbyOfFlag, 0) == 0) {
+                standbyOf = std::string(arg.substr(kStandbyOfFlag.size()));
+            } else if (arg == kNoCancelOnDisconnectFlag) {
+                cancelOnDisconnect = false;
+            } else if (arg.rfind(kExpiryTickFlag, 0) == 0) {
+                expiryTick = std::chrono::milliseconds(std::stoul(std::string(arg.substr(kExpiryTickFlag.size()))));
+            } else if (arg.rfind(kEndOfDayFlag, 0) == 0) {
+                endOfDayMinuteUtc = parseEndOfDay(arg.substr(kEndOfDayFlag.size()));
+            } else if (arg == kTradeTapeFlag) {
+                tradeTape.emplace();
+            } else if (arg.rfind(kTradeTapeFlag, 0) == 0 && arg.size() > kTradeTapeFlag.size() + 1 &&
+                       arg[kTradeTapeFlag.size()] == '=') {
+                tradeTape.emplace().spillDirectory = std::string(arg.substr(kTradeTapeFlag.size() + 1));
+            } else if (arg.rfind(kRiskLimitsFlag, 0) == 0) {
+                if (!risk) {
+                    risk.emplace();
+                }
+                risk->defaultLimits = parseRiskLimits(arg.substr(kRiskLimitsFlag.size()));
+            } else if (arg.rfind(kRiskAccountsFlag, 0) == 0) {
+                if (!risk) {
+                    risk.emplace();
+                }
+                risk->accountCount = static_cast<AccountId>(std::stoul(std::string(arg.substr(kRiskAccountsFlag.size()))));
+            } else if (arg.rfind(kShmFlag, 0) == 0) {
+                if (!shm) {
+                    shm.emplace();
+                }
+                shm->name = std::string(arg.substr(kShmFlag.size()));
+            } else if (arg.rfind(kShmSlotsFlag, 0) == 0) {
+                if (!shm) {
+                    shm.emplace();
+                }
+                shm->slots = static_cast<std::uint32_t>(std::stoul(std::string(arg.substr(kShmSlotsFlag.size()))));
+            } else {
+                std::cerr << "Unknown argument: " << arg << "\n";
+                std::cerr << "Usage: main_server [--symbols=FILE] [--symbol-universe=N]"
+                             " [--cpus=LIST] [--busy-spin] [--mlock] [--udp-port=N]"
+                             " [--max-outbound-bytes=N] [--overflow-policy=disconnect|conflate|pause]"
+                             " [--max-inbound-rate=N] [--replicate-to=ENDPOINT]"
+                             " [--replication-mode=async|semisync] [--standby-of=ENDPOINT]"
+                             " [--no-cancel-on-disconnect] [--expiry-tick-ms=N] [--end-of-day=HH:MM]"
+                             " [--trade-tape[=SPILL_DIR]]"
+                             " [--risk-limits=QTY,NOTIONAL,BAND_BPS,OPEN,POSITION] [--risk-accounts=N]"
+                             " [--shm=NAME] [--shm-slots=N]\n";
+                return 1;
+            }
+        }
+
+        // A promoted standby would start a fresh journal at sequence 1 with no state
+        // transfer, so a standby attached to it would mirror only post-takeover
+        // commands onto an empty book and still be allowed to take over.
+        if (!standbyOf.empty() && !replicateTo.empty()) {
+            throw std::invalid_argument("--standby-of cannot be combined with --replicate-to: a promoted standby "
+                                        "has no state transfer to seed a new standby");
+        }
+
+        // Process-wide, so once here rather than in every thread (which only prefault their stacks).
+        if (lowLatency.lockMemory && !lockProcessMemory()) {
+            std::cerr << "mlockall failed (check RLIMIT_MEMLOCK), continuing unlocked\n";
+        }
+
+        SymbolTable symbols = symbolsPath.empty() ? SymbolTable{} : SymbolTable::loadFromFile(symbolsPath);
+        if (!symbols.empty()) {
+            std::cout << "Loaded " << symbols.size() << " symbols from " << symbolsPath << std::endl;
+        }
+
+        Orderbook orderbook(std::move(symbols), symbolUniverseSize);
+        if (tradeTape) {
+            orderbook.enableTradeTape(*tradeTape);
+        }
+        if (risk) {
+            orderbook.enableRiskChecks(*risk);
+        }
+
+        if (!standbyOf.empty()) {
+            // Mirror the primary until it goes away, then take over its port below.
+            std::cout << "Standby: replicating from " << standbyOf << std::endl;
+            ReplicationStandby standby(standbyOf, orderbook);
+            std::uint64_t applied = 0;
+            try {
+                applied = standby.run(kStandbyConnectTimeout);
+            } catch (const ReplicationDivergence& e) {
+                std::cerr << "Standby: " << e.what() << "; book diverged from the primary, refusing to take over\n";
+                return 2;
+            }
+            std::cout << "Standby: primary lost after sequence " << applied << ", taking over" << std::endl;
+
+            if (cancelOnDisconnect) {
+                // Every session of the old primary is gone. UDP sequencing state is not
+                // replicated either, so UDP clients start over from sequence 1.
+                std::size_t cancelled = 0;
+                for (const SessionId session : orderbook.sessionsWithOrders()) {
+                    cancelled += orderbook.cancelSessionOrders(session);
+                }
+                std::cout << "Standby: cancelled " << cancelled << " orders of disconnected sessions" << std::endl;
+            }
+        }
+
+        Server server(8000, &orderbook, lowLatency, backpressure); // Use desired port
+        server.setCancelOnDisconnect(cancelOnDisconnect);
+        if (!standbyOf.empty()) {
+            // Orders left from the old primary keep its TCP session ids (UDP and shm
+            // ids carry their own high bits); start new connections above them.
+            SessionId highestTcpSession = kNoSession;
+            for (const SessionId session : orderbook.sessionsWithOrders()) {
+                if ((session & (Udp::kEngineSessionBit | Shm::kEngineSessionBit)) == 0) {
+                    highestTcpSession = std::max(highestTcpSession, session);
+                }
+            }
+            server.reserveSessionIds(highestTcpSession);
+        }
+
+        std::unique_ptr<ReplicationPrimary> replication;
+        if (!replicateTo.empty()) {
+            replication = std::make_unique<ReplicationPrimary>(replicateTo, replicationMode);
+            replication->start();
+            server.setReplication(replication.get());
+            std::cout << "Replicating to standby at " << replicateTo
+                      << (replicationMode == ReplicationMode::SemiSync ? " (semi-sync)" : " (async)") << std::endl;
+        }
+        std::thread udpThread;
+        if (udpPort > 0) {
+            udpThread = std::thread(&Server::runUdp, &server, udpPort);
+        }
+        std::unique_ptr<ShmGateway> shmGateway;
+        std::thread shmThread;
+        if (shm) {
+            if (shm->name.empty()) {
+                throw std::invalid_argument("--shm-slots needs --shm=NAME");
+            }
+            shmGateway = std::make_unique<ShmGateway>(*shm);
+            shmThread = std::thread(&Server::runShm, &server, std::ref(*shmGateway));
+        }
+        std::thread expiryThread;
+        if (expiryTick.count() > 0) {
+            expiryThread = std::thread(&Server::runExpiry, &server, expiryTick, endOfDayMinuteUtc);
+        }
+        server.run();
+        if (udpThread.joinable()) {
+            udpThread.join();
+        }
+        if (shmThread.joinable()) {
+            shmThread.join();
+        }
+        if (expiryThread.joinable()) {
+            expiryThread.join();
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Fatal: " << e.what() << "\n";
+        return 1;
+    }
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,235 @@
+#pragma once
+
+#include <charconv>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <system_error>
+
+#include "OrderType.h"
+#include "Side.h"
+
+// Simplified FIX 4.2 parsing (tag=value|tag=value|...), see docs/design_v1.md.
+namespace Fix {
+
+constexpr std::string_view kBeginPrefix = "8=FIX.4.2|";
+constexpr std::string_view kTagAccount = "1"; // numeric account id, see RiskChecks.h
+constexpr std::string_view kTagMsgType = "35";
+constexpr std::string_view kTagOrderId = "11";
+constexpr std::string_view kTagSymbol = "55";
+constexpr std::string_view kTagSide = "54";
+constexpr std::string_view kTagPrice = "44";
+constexpr std::string_view kTagQuantity = "38";
+constexpr std::string_view kTagOrdType = "40";
+constexpr std::string_view kTagStopPrice = "99";
+constexpr std::string_view kTagTimeInForce = "59";
+constexpr std::string_view kTagTransactTime = "60";
+constexpr std::string_view kTagExpireTime = "126";
+constexpr std::string_view kTagMassCancelType = "530";
+
+constexpr char kMsgNew = 'D';
+constexpr char kMsgModify = 'G';
+constexpr char kMsgCancel = 'F';
+constexpr char kMsgMassCancel = 'q';
+// Engine-internal clock tick (never accepted from a client session): advances
+// order expiry to tag 60 (epoch milliseconds); with 59=0 it also ends the day.
+constexpr char kMsgClock = 'U';
+
+// Tag 530 values we accept.
+constexpr std::string_view kMassCancelBySymbol = "1";
+constexpr std::string_view kMassCancelAll = "7";
+
+struct ParsedFixFields {
+    char msgType = '\0';
+    std::string_view account;
+    std::string_view orderId;
+    std::string_view symbol;
+    std::string_view side;
+    std::string_view price;
+    std::string_view quantity;
+    std::string_view ordType;
+    std::string_view stopPrice;
+    std::string_view timeInForce;
+    std::string_view expireTime;
+    std::string_view transactTime;
+    std::string_view massCancelType;
+};
+
+inline bool isSupportedMsgType(char msgType)
+{
+    return msgType == kMsgCancel || msgType == kMsgModify || msgType == kMsgNew || msgType == kMsgMassCancel ||
+           msgType == kMsgClock;
+}
+
+inline bool hasRequiredFields(const ParsedFixFields& fields, char msgType)
+{
+    if (msgType == kMsgCancel) {
+        return !fields.orderId.empty();
+    }
+    if (msgType == kMsgModify) {
+        return !fields.orderId.empty() && !fields.symbol.empty() && !fields.side.empty() &&
+               !fields.price.empty() && !fields.quantity.empty();
+    }
+    if (msgType == kMsgNew) {
+        // Stop (40=3) orders carry a stop price instead of a limit price; market
+        // (40=1) orders carry neither.
+        const bool isMarket = fields.ordType == "1";
+        const bool isStop = fields.ordType == "3";
+        const bool isStopLimit = fields.ordType == "4";
+        // Good-till-date (59=6) orders carry their expiry in tag 126.
+        const bool isGoodTillDate = fields.timeInForce == "6";
+        return !fields.orderId.empty() && !fields.symbol.empty() && !fields.side.empty() &&
+               !fields.quantity.empty() && (isMarket || isStop || !fields.price.empty()) &&
+               (!(isStop || isStopLimit) || !fields.stopPrice.empty()) &&
+               (!isGoodTillDate || !fields.expireTime.empty());
+    }
+    if (msgType == kMsgMassCancel) {
+        return fields.massCancelType == kMassCancelAll ||
+               (fields.massCancelType == kMassCancelBySymbol && !fields.symbol.empty());
+    }
+    if (msgType == kMsgClock) {
+        return !fields.transactTime.empty();
+    }
+    return false;
+}
+
+inline bool parseFixFields(const std::string_view message, ParsedFixFields& out)
+{
+    if (message.rfind(kBeginPrefix, 0) != 0) {
+        return false;
+    }
+
+    size_t start = 0;
+    while (start < message.size()) {
+        size_t end = message.find('|', start);
+        if (end == std::string::npos) {
+            end = message.size();
+        }
+
+        if (end > start) {
+            size_t sep = message.find('=', start);
+            if (sep != std::string::npos && sep > start && sep < end) {
+                const std::string_view tag(message.data() + start, sep - start);
+                const std::string_view value(message.data() + sep + 1, end - sep - 1);
+
+                if (tag == kTagMsgType) {
+                    if (value.size() == 1) {
+                        out.msgType = value.front();
+                    }
+                } else if (tag == kTagOrderId) {
+                    out.orderId = value;
+                } else if (tag == kTagSymbol) {
+                    out.symbol = value;
+                } else if (tag == kTagSide) {
+                    out.side = value;
+                } else if (tag == kTagPrice) {
+                    out.price = value;
+                } else if (tag == kTagQuantity) {
+                    out.quantity = value;
+                } else if (tag == kTagOrdType) {
+                    out.ordType = value;
+                } else if (tag == kTagStopPrice) {
+                    out.stopPrice = value;
+                } else if (tag == kTagTimeInForce) {
+                    out.timeInForce = value;
+                } else if (tag == kTagExpireTime) {
+                    out.expireTime = value;
+                } else if (tag == kTagTransactTime) {
+                    out.transactTime = value;
+                } else if (tag == kTagMassCancelType) {
+                    out.massCancelType = value;
+                } else if (tag == kTagAccount) {
+                    out.account = value;
+                }
+            }
+        }
+
+        start = end + 1;
+    }
+
+    return isSupportedMsgType(out.msgType);
+}
+
+template <typename T>
+bool parseInteger(std::string_view text, T& out)
+{
+    if (text.empty()) {
+        return false;
+    }
+
+    const char* begin = text.data();
+    const char* end = begin + text.size();
+    const auto [ptr, ec] = std::from_chars(begin, end, out);
+    return ec == std::errc() && ptr == end;
+}
+
+inline bool parseSide(std::string_view field, Side& side)
+{
+    if (field == "1") {
+        side = Side::BUY;
+        return true;
+    }
+    if (field == "2") {
+        side = Side::SELL;
+        return true;
+    }
+    return false;
+}
+
+inline bool parseOrderType(std::string_view field, OrderType& type)
+{
+    if (field == "1") {
+        type = OrderType::Market;
+        return true;
+    }
+    if (field.empty() || field == "2") {
+        type = OrderType::Limit;
+        return true;
+    }
+    if (field == "3") {
+        type = OrderType::Stop;
+        return true;
+    }
+    if (field == "4") {
+        type = OrderType::StopLimit;
+        return true;
+    }
+    return false;
+}
+
+inline bool parseTimeInForce(std::string_view field, TimeInForce& timeInForce)
+{
+    if (field.empty() || field == "1") {
+        timeInForce = TimeInForce::GoodTillCancel;
+        return true;
+    }
+    if (field == "0") {
+        timeInForce = TimeInForce::Day;
+        return true;
+    }
+    if (field == "3") {
+        timeInForce = TimeInForce::ImmediateOrCancel;
+        return true;
+    }
+    if (field == "4") {
+        timeInForce = TimeInForce::FillOrKill;
+        return true;
+    }
+    if (field == "6") {
+        timeInForce = TimeInForce::GoodTillDate;
+        return true;
+    }
+    return false;
+}
+
+} // namespace Fix
+
+namespace Response {
+constexpr std::string_view kOk = "OK";
+constexpr std::string_view kErr = "ERR";
+constexpr std::string_view kCreated = "ID:";
+constexpr std::string_view kMassCancelled = "CXL:"; // followed by the number of orders cancelled
+constexpr std::string_view kExpired = "EXPIRED:"; // followed by an order id (reports) or a count (clock ticks)
+constexpr std::string_view kRiskRejected = "RISK:"; // followed by the failed check, see riskRejectName()
+constexpr std::string_view kFilled = "FILL:"; // followed by the quantity an IOC, FOK or market order executed
+} // namespace Response
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "Usings.h"
+
+// Point-in-time memory footprint of an Orderbook, see BasicOrderbook::memoryStats().
+// Pool, index, control-block and table sizes are exact; map and list node sizes
+// assume the usual node layout (payload plus links), without malloc headers.
+struct OrderbookMemoryStats {
+    // Order pool: preallocated slots, whether or not an order occupies them.
+    std::size_t orderSlotBytes = 0;
+    std::size_t orderSlotsReserved = 0;
+    std::size_t orderSlotsLive = 0;
+    std::size_t orderSlotsHighWater = 0;
+    std::size_t orderPoolBytes = 0;
+
+    // OrderId -> locator index (dense part plus hash overflow).
+    std::size_t orderIndexBytes = 0;
+    std::size_t orderIndexOverflowEntries = 0;
+
+    // One shared_ptr control block per live pooled order, allocated outside the pool.
+    std::size_t controlBlockBytes = 0;
+
+    // Per-level order queues and the price -> level map nodes.
+    std::size_t levelQueueBytes = 0;
+    std::size_t priceLevelBytes = 0;
+
+    std::size_t stopBytes = 0;        // stop trigger books and their index
+    std::size_t sessionBytes = 0;     // session table
+    std::size_t expiryWheelBytes = 0; // timer wheel buckets (the timers live in the orders)
+    std::size_t symbolBookBytes = 0;  // book table, slab chunks and free list
+    std::size_t topOfBookBytes = 0;   // chunk table and the seqlock slots of allocated chunks
+    std::size_t tradeTapeBytes = 0;   // heap and mapped tape segments, when enabled
+    std::size_t riskBytes = 0;        // per-account limits and per-symbol exposure arrays, when enabled
+
+    std::size_t restingOrders = 0;
+    std::size_t priceLevels = 0;
+    std::size_t pendingStops = 0;
+    std::size_t activeBooks = 0;
+
+    struct SymbolUsage {
+        SymbolId symbolId;
+        std::size_t bidLevels;
+        std::size_t askLevels;
+        std::size_t orders;
+    };
+    std::vector<SymbolUsage> symbols; // active books only, by SymbolId
+
+    std::size_t totalBytes() const
+    {
+        return orderPoolBytes + orderIndexBytes + controlBlockBytes + levelQueueBytes + priceLevelBytes +
+               stopBytes + sessionBytes + expiryWheelBytes + symbolBookBytes + topOfBookBytes + tradeTapeBytes +
+               riskBytes;
+    }
+};
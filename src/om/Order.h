@@ -4,17 +4,24 @@
 #include <memory>
 
 #include "Usings.h"
+#include "OrderType.h"
 #include "Side.h"
+#include "TimerWheel.h"
 
-class Order 
+template <typename Policies>
+class BasicOrderbook;
+
+template <typename PriceT, typename QuantityT>
+class BasicOrder 
 {
 public:
-    Order(
+    BasicOrder(
         OrderId id,
-        Price price,
-        Quantity quantity,
+        PriceT price,
+        QuantityT quantity,
         Side side,
-        SymbolId symbolId
+        SymbolId symbolId,
+        SessionId sessionId = kNoSession
     )
     : orderId_{id}
     , price_{price}
@@ -22,17 +29,30 @@ public:
     , unfilledQuantity_{quantity}
     , side_{side}
     , symbolId_{symbolId}
+    , sessionId_{sessionId}
     { }
 
     OrderId getOrderId() const { return orderId_; } 
-    Price getPrice() const { return price_; }
-    Quantity getQuantity() const { return quantity_; }
-    Quantity getUnfilledQuantity() const { return unfilledQuantity_; }
+    PriceT getPrice() const { return price_; }
+    QuantityT getQuantity() const { return quantity_; }
+    QuantityT getUnfilledQuantity() const { return unfilledQuantity_; }
     Side getSide() const { return side_; }
     SymbolId getSymbolId() const { return symbolId_; }
+    SessionId getSessionId() const { return sessionId_; }
+    AccountId getAccountId() const { return accountId_; }
+    TimeInForce getTimeInForce() const { return timeInForce_; }
+    // Epoch milliseconds; only meaningful for GoodTillDate.
+    std::uint64_t getExpireTime() const { return expiryTimer_.deadline; }
+
+    void setTimeInForce(TimeInForce timeInForce, std::uint64_t expireTime = 0) {
+        timeInForce_ = timeInForce;
+        expiryTimer_.deadline = timeInForce == TimeInForce::GoodTillDate ? expireTime : 0;
+    }
+
+    void setAccountId(AccountId accountId) { accountId_ = accountId; }
 
     bool isFilled() const { return unfilledQuantity_ == 0; }
-    void fill(Quantity qty) { 
+    void fill(QuantityT qty) { 
         if (qty > unfilledQuantity_) {
             return; // Or throw an exception
         }
@@ -41,14 +61,26 @@ public:
 
 
 private:
+    template <typename Policies>
+    friend class BasicOrderbook;
+
     OrderId orderId_;
-    Price price_;
-    Quantity quantity_;
-    Quantity unfilledQuantity_;
+    PriceT price_;
+    QuantityT quantity_;
+    QuantityT unfilledQuantity_;
     Side side_;
     SymbolId symbolId_;
-};
+    SessionId sessionId_;
+    TimeInForce timeInForce_ = TimeInForce::GoodTillCancel;
+    AccountId accountId_ = kDefaultAccount;
 
+    // Intrusive links in the owning session's list of resting orders (Orderbook only).
+    BasicOrder* sessionPrev_ = nullptr;
+    BasicOrder* sessionNext_ = nullptr;
+    // GoodTillDate orders sit in the Orderbook's expiry wheel; the deadline lives here.
+    TimerHook<BasicOrder> expiryTimer_;
+};
 
+using Order = BasicOrder<Price, Quantity>;
 using OrderPointer = std::shared_ptr<Order>;
 using OrderPointers = std::list<OrderPointer>;
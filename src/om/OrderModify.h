@@ -2,10 +2,11 @@
 
 #include "Order.h"
 
-class OrderModify
+template <typename PriceT, typename QuantityT>
+class BasicOrderModify
 {
 public:
-    OrderModify(OrderId orderId, Price price, Quantity quantity, Side side, SymbolId symbolId)
+    BasicOrderModify(OrderId orderId, PriceT price, QuantityT quantity, Side side, SymbolId symbolId)
     : orderId_{ orderId }
     , price_{ price }
     , quantity_{ quantity }
@@ -14,14 +15,14 @@ public:
     { }
 
     OrderId getOrderId() const { return orderId_; }
-    Price getPrice() const { return price_; }
-    Quantity getQuantity() const { return quantity_; }
+    PriceT getPrice() const { return price_; }
+    QuantityT getQuantity() const { return quantity_; }
     Side getSide() const { return side_; }
     SymbolId getSymbolId() const { return symbolId_; }
 
-    OrderPointer toOrderPointer() const 
+    std::shared_ptr<BasicOrder<PriceT, QuantityT>> toOrderPointer() const 
     {
-        return std::make_shared<Order>(
+        return std::make_shared<BasicOrder<PriceT, QuantityT>>(
             getOrderId(),
             getPrice(),
             getQuantity(),
@@ -31,8 +32,10 @@ public:
     }
 private:
     OrderId orderId_;
-    Price price_;
-    Quantity quantity_;
+    PriceT price_;
+    QuantityT quantity_;
     Side side_;
     SymbolId symbolId_;
-};
\ No newline at end of file
+};
+
+using OrderModify = BasicOrderModify<Price, Quantity>;
\ No newline at end of file
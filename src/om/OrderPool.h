@@ -9,9 +9,20 @@
 
 #include "Order.h"
 
-class OrderPool {
+template <typename OrderT, typename LockT = std::mutex>
+class BasicOrderPool {
 public:
-    explicit OrderPool(std::size_t chunkSize = 4096, std::size_t initialChunkCount = 0)
+    struct Stats {
+        std::size_t slotBytes;
+        std::size_t chunkCount;
+        std::size_t capacity;      // slots reserved
+        std::size_t live;          // slots holding an order
+        std::size_t highWaterMark; // most slots ever live at once
+
+        std::size_t reservedBytes() const { return capacity * slotBytes; }
+    };
+
+    explicit BasicOrderPool(std::size_t chunkSize = 4096, std::size_t initialChunkCount = 0)
         : chunkSize_(chunkSize) {
         chunks_.reserve(initialChunkCount);
         for (std::size_t i = 0; i < initialChunkCount; ++i) {
@@ -39,7 +50,7 @@ public:
     }
 
     template <typename... Args>
-    Order* allocate(Args&&... args) {
+    OrderT* allocate(Args&&... args) {
         Slot* slot = nullptr;
         {
             std::scoped_lock lock(mutex_);
@@ -48,40 +59,53 @@ public:
             }
             slot = freeList_;
             freeList_ = freeList_->next;
+            if (++live_ > highWaterMark_) {
+                highWaterMark_ = live_;
+            }
         }
 
         try {
-            return new (slot->storage) Order(std::forward<Args>(args)...);
+            return new (slot->storage) OrderT(std::forward<Args>(args)...);
         } catch (...) {
             std::scoped_lock lock(mutex_);
             slot->next = freeList_;
             freeList_ = slot;
+            --live_;
             throw;
         }
     }
 
-    void deallocate(Order* order) {
+    void deallocate(OrderT* order) {
         if (order == nullptr) {
             return;
         }
 
-        order->~Order();
+        order->~OrderT();
         Slot* slot = slotFromOrder(order);
 
         std::scoped_lock lock(mutex_);
         slot->next = freeList_;
         freeList_ = slot;
+        --live_;
+    }
+
+    Stats stats() const {
+        std::scoped_lock lock(mutex_);
+        return Stats{sizeof(Slot), chunks_.size(), chunks_.size() * chunkSize_, live_, highWaterMark_};
     }
 
+    // For lock policies that report on themselves (ProfiledLock).
+    const LockT& mutex() const { return mutex_; }
+
 private:
     struct Slot {
-        alignas(Order) unsigned char storage[sizeof(Order)];
+        alignas(OrderT) unsigned char storage[sizeof(OrderT)];
         Slot* next = nullptr;
     };
 
     static_assert(offsetof(Slot, storage) == 0, "Slot storage must be first field");
 
-    static Slot* slotFromOrder(Order* order) {
+    static Slot* slotFromOrder(OrderT* order) {
         return reinterpret_cast<Slot*>(order);
     }
 
@@ -97,5 +121,9 @@ private:
     std::size_t chunkSize_;
     std::vector<std::unique_ptr<Slot[]>> chunks_;
     Slot* freeList_ = nullptr;
-    std::mutex mutex_;
+    std::size_t live_ = 0;
+    std::size_t highWaterMark_ = 0;
+    mutable LockT mutex_;
 };
+
+using OrderPool = BasicOrderPool<Order>;
@@ -0,0 +1,26 @@
+#pragma once
+
+// FIX tag 40 (OrdType) values the engine accepts.
+enum class OrderType
+{
+    Market,    // 40=1: takes liquidity at any price and never rests (immediate-or-cancel unless 59=4)
+    Limit,     // 40=2 (default when tag 40 is absent)
+    Stop,      // 40=3: becomes a market order when a trade reaches the stop price
+    StopLimit, // 40=4: becomes a limit order when a trade reaches the stop price
+};
+
+// FIX tag 59 (TimeInForce) values the engine accepts.
+enum class TimeInForce
+{
+    Day,               // 59=0: cancelled by the end-of-day sweep
+    GoodTillCancel,    // 59=1 (default when tag 59 is absent)
+    ImmediateOrCancel, // 59=3: matches what it can on arrival, the rest is cancelled
+    FillOrKill,        // 59=4: matches its whole quantity on arrival or nothing
+    GoodTillDate,      // 59=6: expires at tag 126 (ExpireTime, epoch milliseconds)
+};
+
+// Orders that execute on arrival and never rest.
+inline bool isImmediate(TimeInForce timeInForce)
+{
+    return timeInForce == TimeInForce::ImmediateOrCancel || timeInForce == TimeInForce::FillOrKill;
+}
@@ -1,76 +1,335 @@
 #pragma once
 
 #include <array>
-#include <map>
+#include <atomic>
+#include <functional>
 #include <iostream>
-#include <mutex>
+#include <list>
+#include <map>
+#include <memory>
+#include <optional>
 #include <string>
+#include <type_traits>
 #include <unordered_map>
+#include <vector>
 
 #include "Usings.h"
+#include "MemoryStats.h"
 #include "Side.h"
 #include "Order.h"
 #include "TradeInfo.h"
 #include "Trade.h"
 #include "OrderModify.h"
 #include "OrderPool.h"
+#include "OrderType.h"
+#include "OrderbookPolicies.h"
+#include "RiskChecks.h"
+#include "SeqLock.h"
+#include "SymbolTable.h"
+#include "TimerWheel.h"
+#include "TopOfBook.h"
+#include "TradeTape.h"
 
-class Orderbook 
+// Matching engine, specialised at compile time by a policy bundle (see
+// OrderbookPolicies.h). `Orderbook` is the default, mutex-guarded instantiation.
+template <typename Policies>
+class BasicOrderbook
 {
+public:
+    using Price = typename Policies::Price;
+    using Quantity = typename Policies::Quantity;
+    using Lock = typename Policies::Lock;
+    using Order = BasicOrder<Price, Quantity>;
+    using OrderPointer = std::shared_ptr<Order>;
+    using OrderModify = BasicOrderModify<Price, Quantity>;
+    using TradeInfo = BasicTradeInfo<Price, Quantity>;
+    using Trade = BasicTrade<Price, Quantity>;
+    using Trades = std::vector<Trade>;
+    using TopOfBook = BasicTopOfBook<Price, Quantity>;
+    using TradeTape = BasicTradeTape<Price, Quantity>;
+    using RiskChecks = BasicRiskChecks<Price, Quantity>;
+    using Level = typename Policies::template Level<OrderPointer>;
+    using Bids = typename Policies::template PriceLevels<Price, Level, std::greater<Price>>;
+    using Asks = typename Policies::template PriceLevels<Price, Level, std::less<Price>>;
+
+    // Cancel report for an order removed by expiry or the end-of-day sweep.
+    struct ExpiredOrder {
+        OrderId orderId_;
+        SessionId sessionId_;
+    };
+    using ExpiredOrders = std::vector<ExpiredOrder>;
+
 private:
+    using SymbolCapacity = typename Policies::SymbolCapacity;
+
     static constexpr std::size_t kPreallocatedOrderCapacity = 5'000'000;
-    static constexpr std::size_t kSymbolCount = static_cast<std::size_t>(kKnownSymbolCount);
+    static constexpr std::size_t kSymbolBookChunkSize = 64;
+
+    BasicOrderPool<Order, Lock> orderPool_;
+    SymbolTable symbolTable_;
+
+    // A stop waits, keyed by its stop price, until a trade in its symbol reaches it.
+    struct PendingStop {
+        OrderPointer order_;
+        OrderType type_;
+    };
+    using StopQueue = std::list<PendingStop>;
 
-    OrderPool orderPool_;
+    struct StopBook {
+        std::map<Price, StopQueue, std::less<Price>> buyStops_;     // fire when a trade prints >= key
+        std::map<Price, StopQueue, std::greater<Price>> sellStops_; // fire when a trade prints <= key
+
+        bool empty() const { return buyStops_.empty() && sellStops_.empty(); }
+    };
 
     struct SymbolBook {
-        std::map<Price, OrderPointers, std::greater<Price>> bids_;
-        std::map<Price, OrderPointers, std::less<Price>> asks_;
+        Bids bids_;
+        Asks asks_;
+        SymbolId symbolId_{ kInvalidSymbolId };
+        Price lastTradePrice_{};
+        Quantity lastTradeQuantity_{};
+        // Allocated with the first stop and released with the last, so symbols
+        // without stops pay one null check after matching.
+        std::unique_ptr<StopBook> stops_;
+    };
+
+    struct StopLocator {
+        typename StopQueue::iterator location_;
+        SymbolBook* book_;
+        Price stopPrice_;
+        Side side_;
     };
 
     struct OrderLocator {
         OrderPointer order_{ nullptr };
-        OrderPointers::iterator location_;
+        typename Level::Handle location_{};
         SymbolBook* book_{ nullptr };
+
+        bool isActive() const { return book_ != nullptr; }
     };
 
-    std::array<SymbolBook, kSymbolCount> books_;
-    std::vector<OrderLocator> orderLocators_;
-    std::unordered_map<OrderId, OrderLocator> overflowOrderLocators_;
-    mutable std::mutex ordersMutex_;
+    using OrderIndex = typename Policies::template OrderIndex<OrderLocator>;
 
-    static bool isKnownSymbol(SymbolId symbolId);
+    // Head of a session's intrusive list of resting orders (linked through the orders).
+    struct SessionOrders {
+        Order* head_{ nullptr };
+        std::size_t count_{ 0 };
+    };
+    using BookTable = std::conditional_t<SymbolCapacity::kFixed,
+                                         std::array<SymbolBook*, SymbolCapacity::kCapacity>,
+                                         std::vector<SymbolBook*>>;
+
+    // Dense table addressed by SymbolId. Books are materialised on first use from
+    // chunked slab storage, so an idle universe costs one pointer per symbol.
+    SymbolId symbolUniverseSize_;
+    BookTable books_{};
+    std::vector<std::unique_ptr<SymbolBook[]>> bookChunks_;
+    std::vector<SymbolBook*> freeBooks_;
+    // Published top of book, one cache line per symbol. Kept apart from the lazy
+    // books so readers touch neither the books nor ordersMutex_. Slots come in
+    // chunks allocated with the first book of their range and kept for the
+    // Orderbook's lifetime, since readers hold no lock that would say when one
+    // could go; an untouched range costs one null pointer.
+    using TopOfBookSlot = SeqLock<TopOfBook>;
+    static constexpr std::size_t kTopOfBookChunkSize = 64;
+    std::unique_ptr<std::atomic<TopOfBookSlot*>[]> topOfBook_;
+    std::vector<std::unique_ptr<TopOfBookSlot[]>> topOfBookChunks_;
+
+    OrderIndex orderIndex_;
+    std::unordered_map<OrderId, StopLocator> stopIndex_;
+    std::unordered_map<SessionId, SessionOrders> sessions_;
+    // Good-till-date orders by expiry, linked through the orders themselves.
+    TimerWheel<Order, &Order::expiryTimer_> expiryWheel_;
+    // Every print, column-wise per symbol; null until enableTradeTape().
+    std::unique_ptr<TradeTape> tradeTape_;
+    // Per-account pre-trade limits; null until enableRiskChecks().
+    std::unique_ptr<RiskChecks> riskChecks_;
+    mutable Lock ordersMutex_;
+
+    bool isKnownSymbol(SymbolId symbolId) const;
     SymbolBook& symbolBook(SymbolId symbolId);
     const SymbolBook& symbolBook(SymbolId symbolId) const;
+    SymbolBook* createSymbolBookUnlocked(SymbolId symbolId);
+    std::size_t topOfBookChunkCount() const;
+    TopOfBookSlot& topOfBookSlotUnlocked(SymbolId symbolId);
+    // Null until the symbol's range has had a book.
+    const TopOfBookSlot* findTopOfBookSlot(SymbolId symbolId) const;
+
+    void linkToSessionUnlocked(Order& order);
+    void unlinkFromSessionUnlocked(Order& order);
+    // Session link, expiry timer and risk exposure: taken when an order is
+    // accepted, dropped on every path that takes it out of the book.
+    void attachOrderUnlocked(Order& order);
+    void detachOrderUnlocked(Order& order);
+    bool cancelOrderUnlocked(OrderId orderId);
+    // addOrder() past its argument checks.
+    Trades addOrderUnlocked(const OrderPointer& order, RiskReject* rejected);
+    bool cancelStopUnlocked(OrderId orderId);
+    bool isLiveOrderIdUnlocked(OrderId orderId) const;
+    // `price` is the limit price, or the stop price of a Stop order; `notional`
+    // as in RiskChecks::check.
+    RiskReject checkRiskUnlocked(const SymbolBook& book, const Order& order, Price price,
+                                 std::uint64_t notional = 0) const;
+    void recordFillUnlocked(const Order& aggressor, const Order& resting, Quantity quantity);
 
-    bool hasOrderLocatorUnlocked(OrderId orderId) const;
-    OrderLocator* getOrderLocatorUnlocked(OrderId orderId);
-    const OrderLocator* getOrderLocatorUnlocked(OrderId orderId) const;
-    void upsertOrderLocatorUnlocked(OrderId orderId, OrderLocator locator);
-    void eraseOrderLocatorUnlocked(OrderId orderId);
+    // Levels that can consume() in bulk replace the one-order-at-a-time loop.
+    static constexpr bool kBulkLevels = requires { requires Level::kBulkConsume; };
 
-    OrderPointer makePooledOrder(OrderId orderId, Price price, Quantity quantity, Side side, SymbolId symbolId);
-    Trades matchOrders(SymbolBook& book);
+    Trades restAndMatchUnlocked(SymbolBook& book, const OrderPointer& order);
+    template <typename LevelT>
+    Quantity takeFromLevelUnlocked(SymbolBook& book, Order& aggressor, Price aggressorPrice, LevelT& level,
+                                   Price levelPrice, Trades& trades, std::int64_t& tapeTimestamp);
+    // `limit` 0 takes any price.
+    void sweepUnlocked(SymbolBook& book, Order& order, Price limit, Trades& trades);
+    Quantity crossingQuantityUnlocked(const SymbolBook& book, Side side, Price limit, Quantity wanted) const;
+    // Deepest price a market order of `wanted` would trade at and the notional
+    // of that sweep, from the level aggregates; price 0 when there is nothing to take.
+    struct SweepExtent {
+        Price worstPrice_{};
+        std::uint64_t notional_{};
+    };
+    SweepExtent sweepExtentUnlocked(const SymbolBook& book, Side side, Quantity wanted) const;
+    void collectTriggeredStopsUnlocked(SymbolBook& book, Price high, Price low, std::vector<PendingStop>& triggered);
+    void fireStopsUnlocked(SymbolBook& book, Side aggressorSide, Trades& trades);
+
+    OrderPointer makePooledOrder(OrderId orderId, Price price, Quantity quantity, Side side, SymbolId symbolId,
+                                 SessionId sessionId = kNoSession);
+    Trades matchOrders(SymbolBook& book, Side aggressorSide);
+    void publishTopOfBookUnlocked(const SymbolBook& book);
 
 public:
-    Orderbook();
+    BasicOrderbook();
+    explicit BasicOrderbook(SymbolTable symbolTable, SymbolId symbolUniverseSize = kKnownSymbolCount);
 
     // For this specific Binance code, we should refactor it into a separate binance order book class
     // that inherits from OrderBook and implements processMessage
     void processBinanceMessage(const std::string& message);
-    
-    // Process simplified FIX messages (tag=value|tag=value|...)
-    std::string processFixMessage(const std::string_view message);
 
-    Trades addOrder(const OrderPointer& order);
-   
+    // Process simplified FIX messages (tag=value|tag=value|...). New orders are
+    // owned by `session`; 35=q mass-cancels that session's orders. 35=U clock
+    // ticks drive expiry and are only accepted from kNoSession (the engine itself).
+    std::string processFixMessage(const std::string_view message, SessionId session = kNoSession);
+
+    // With risk checks enabled, an order that fails one is dropped and the
+    // reason stored in `rejected` when given (RiskReject::None otherwise).
+    // ImmediateOrCancel and FillOrKill orders never rest: they take the opposite
+    // levels up to their price (any price when it is 0, a market order) and the
+    // remainder is dropped without touching the order index or the level maps.
+    // A FillOrKill order executes only if those levels hold its whole quantity.
+    // A market order is risk-checked against the sweep it would do: the price
+    // band at the deepest level it reaches, the notional summed over the levels.
+    Trades addOrder(const OrderPointer& order, RiskReject* rejected = nullptr);
+
+    // Parks a Stop (order price ignored) or StopLimit order until a trade in its
+    // symbol prints at or through stopPrice (>= for buys, <= for sells). It is then
+    // injected as a market or limit order; stops it triggers in turn fire in the
+    // same call. Returns false for a duplicate id, an unknown symbol or a failed
+    // risk check; stops are checked (at the stop price for Stop orders) when parked.
+    bool addStopOrder(const OrderPointer& order, OrderType type, Price stopPrice, RiskReject* rejected = nullptr);
+    std::size_t pendingStopCount(SymbolId symbolId) const;
+
     void cancelOrder(OrderId orderId);
-    Trades modifyOrder(OrderModify order);
-    
+    // Cancel and re-add under the same id, session, account and time in force.
+    // The replacement is risk-checked first; if it fails, the original stays resting.
+    Trades modifyOrder(OrderModify order, RiskReject* rejected = nullptr);
+
+    // Cancels every resting order owned by `session`, optionally only in one symbol
+    // and/or on one side, in a single locked pass over the session's own orders.
+    // Returns how many were cancelled.
+    std::size_t cancelSessionOrders(SessionId session,
+                                    SymbolId symbolId = kInvalidSymbolId,
+                                    std::optional<Side> side = std::nullopt);
+    std::size_t sessionOrderCount(SessionId session) const;
+    std::vector<SessionId> sessionsWithOrders() const;
+
+    // Cancels every good-till-date order (resting or pending stop) whose expiry
+    // is <= nowMs, in one locked batch. The clock only moves forward; callers
+    // (the server's ticker) pass wall-clock epoch milliseconds. Appends a report
+    // per order to `expired` when given; returns how many expired.
+    std::size_t expireOrders(std::uint64_t nowMs, ExpiredOrders* expired = nullptr);
+
+    // End-of-day sweep: cancels every Day order in one pass over the active
+    // books, level by level, without per-order lookups. Same reporting as above.
+    std::size_t cancelDayOrders(ExpiredOrders* cancelled = nullptr);
+    std::size_t pendingExpiryCount() const;
+
     void printOrderBook() const;
 
+    // Lock-free best bid/ask and last trade, safe from any thread while the book
+    // is being matched. The version is even and grows by 2 per completed change,
+    // so pollers can skip symbols whose version has not moved. A symbol whose range never
+    // had a book reads as empty with version 0.
+    TopOfBook topOfBook(SymbolId symbolId) const;
+    std::uint64_t topOfBookVersion(SymbolId symbolId) const;
+
+    // Tag 55 resolution: tickers from the symbol table first, then plain numeric ids.
+    SymbolId resolveSymbol(std::string_view symbol) const;
+    const SymbolTable& symbolTable() const { return symbolTable_; }
+
+    SymbolId symbolUniverseSize() const { return symbolUniverseSize_; }
+    std::size_t activeSymbolBookCount() const;
+
+    // Returns books with no resting orders to the slab free list, and slab chunks
+    // left with no book in use to the allocator; returns how many books were released.
+    std::size_t reclaimIdleBooks();
+
+    // Bytes by component, live vs reserved order slots with the pool's high-water
+    // mark, and per-symbol level/order counts. Walks every level under the book
+    // lock, so it is meant for stats polling, not the order path.
+    OrderbookMemoryStats memoryStats() const;
+
+    // Wait time on the book lock and the order pool lock, for profiled lock policies.
+    struct LockContention {
+        LockContentionStats book;
+        LockContentionStats orderPool;
+    };
+    LockContention lockContention() const
+        requires requires(const Lock& lock) { lock.contention(); }
+    {
+        return { ordersMutex_.contention(), orderPool_.mutex().contention() };
+    }
+
+    // Starts recording every trade (print price, quantity, aggressor side, wall
+    // clock) to a columnar tape. Call once, before trading and before handing
+    // tradeTape() to reader threads; its queries never take the book lock.
+    void enableTradeTape(TradeTapeConfig config = {});
+    const TradeTape* tradeTape() const { return tradeTape_.get(); }
+
+    // Turns on pre-trade checks for every new order, before it rests or parks:
+    // per-account order quantity and notional, a price band around the symbol's
+    // last trade (else the BBO mid, else the one side quoted), open order count
+    // and net position per symbol. Call once, before the first order: exposure
+    // is only tracked for orders accepted afterwards.
+    void enableRiskChecks(RiskConfig config = {});
+    bool riskChecksEnabled() const { return riskChecks_ != nullptr; }
+    // These throw std::logic_error while risk checks are off and
+    // std::out_of_range for an account outside the configured range.
+    void setAccountLimits(AccountId account, const RiskLimits& limits);
+    RiskExposure riskExposure(AccountId account, SymbolId symbolId) const;
+    std::uint32_t accountOpenOrders(AccountId account) const;
+
     // For testing purposes
-    const auto& getBids(SymbolId symbolId) const { return symbolBook(symbolId).bids_; }
-    const auto& getAsks(SymbolId symbolId) const { return symbolBook(symbolId).asks_; }
+    const Bids& getBids(SymbolId symbolId) const { return symbolBook(symbolId).bids_; }
+    const Asks& getAsks(SymbolId symbolId) const { return symbolBook(symbolId).asks_; }
 };
 
+#include "OrderbookImpl.h"
+
+using Orderbook = BasicOrderbook<DefaultOrderbookPolicies>;
+using SingleThreadedOrderbook = BasicOrderbook<SingleThreadedOrderbookPolicies>;
+using SpinLockOrderbook = BasicOrderbook<SpinLockOrderbookPolicies>;
+using HashIndexOrderbook = BasicOrderbook<HashIndexOrderbookPolicies>;
+using WideOrderbook = BasicOrderbook<WideOrderbookPolicies>;
+using SoALevelOrderbook = BasicOrderbook<SoALevelOrderbookPolicies>;
+using ProfiledOrderbook = BasicOrderbook<ProfiledMutexOrderbookPolicies>;
+using ProfiledSpinLockOrderbook = BasicOrderbook<ProfiledSpinLockOrderbookPolicies>;
+
+// Compiled once in Orderbook.cpp.
+extern template class BasicOrderbook<DefaultOrderbookPolicies>;
+extern template class BasicOrderbook<SingleThreadedOrderbookPolicies>;
+extern template class BasicOrderbook<SpinLockOrderbookPolicies>;
+extern template class BasicOrderbook<HashIndexOrderbookPolicies>;
+extern template class BasicOrderbook<WideOrderbookPolicies>;
+extern template class BasicOrderbook<SoALevelOrderbookPolicies>;
+extern template class BasicOrderbook<ProfiledMutexOrderbookPolicies>;
+extern template class BasicOrderbook<ProfiledSpinLockOrderbookPolicies>;
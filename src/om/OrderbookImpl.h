@@ -0,0 +1,1430 @@
+#pragma once
+
+// Member definitions for BasicOrderbook; included from Orderbook.h only.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+
+#include "FixParser.h"
+
+namespace OrderbookDetail {
+
+constexpr std::size_t kOrderPoolChunkSize = 4096;
+
+// Expiry deadlines (tag 126) and the server's clock ticks are epoch milliseconds.
+inline std::uint64_t wallClockMs()
+{
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+}
+
+// Allocates the shared_ptr control block of pooled orders through std::allocator
+// and records its size (an implementation detail of shared_ptr) for memoryStats().
+template <typename Tag>
+struct ControlBlockSize {
+    static inline std::atomic<std::size_t> bytes{ 0 };
+};
+
+template <typename T, typename Tag>
+struct ControlBlockAllocator {
+    using value_type = T;
+
+    ControlBlockAllocator() = default;
+    template <typename U>
+    ControlBlockAllocator(const ControlBlockAllocator<U, Tag>&) noexcept { }
+
+    T* allocate(std::size_t count)
+    {
+        ControlBlockSize<Tag>::bytes.store(count * sizeof(T), std::memory_order_relaxed);
+        return std::allocator<T>{}.allocate(count);
+    }
+    void deallocate(T* pointer, std::size_t count) noexcept { std::allocator<T>{}.deallocate(pointer, count); }
+
+    template <typename U>
+    bool operator==(const ControlBlockAllocator<U, Tag>&) const noexcept { return true; }
+};
+
+} // namespace OrderbookDetail
+
+template <typename Policies>
+BasicOrderbook<Policies>::BasicOrderbook()
+    : BasicOrderbook(SymbolTable{})
+{
+}
+
+template <typename Policies>
+BasicOrderbook<Policies>::BasicOrderbook(SymbolTable symbolTable, SymbolId symbolUniverseSize)
+    : orderPool_(OrderbookDetail::kOrderPoolChunkSize)
+    , symbolTable_(std::move(symbolTable))
+    , symbolUniverseSize_(std::max(symbolUniverseSize, static_cast<SymbolId>(symbolTable_.size())))
+    , orderIndex_(kPreallocatedOrderCapacity)
+    , expiryWheel_(OrderbookDetail::wallClockMs())
+{
+    if constexpr (SymbolCapacity::kFixed) {
+        if (symbolTable_.size() > SymbolCapacity::kCapacity) {
+            throw std::invalid_argument("Symbol table larger than the fixed symbol capacity");
+        }
+        symbolUniverseSize_ = SymbolCapacity::kCapacity;
+    } else {
+        if (symbolUniverseSize_ == 0 || symbolUniverseSize_ == kInvalidSymbolId) {
+            throw std::invalid_argument("Invalid symbol universe size");
+        }
+        books_.assign(symbolUniverseSize_, nullptr);
+    }
+    topOfBook_ = std::make_unique<std::atomic<TopOfBookSlot*>[]>(topOfBookChunkCount());
+
+    orderPool_.preallocate(kPreallocatedOrderCapacity);
+}
+
+template <typename Policies>
+bool BasicOrderbook<Policies>::isKnownSymbol(SymbolId symbolId) const
+{
+    if constexpr (SymbolCapacity::kFixed) {
+        return symbolId < SymbolCapacity::kCapacity;
+    } else {
+        return symbolId < symbolUniverseSize_;
+    }
+}
+
+template <typename Policies>
+typename BasicOrderbook<Policies>::SymbolBook& BasicOrderbook<Policies>::symbolBook(SymbolId symbolId)
+{
+    if (!isKnownSymbol(symbolId)) {
+        throw std::out_of_range("Unknown symbol");
+    }
+    SymbolBook* book = books_[static_cast<std::size_t>(symbolId)];
+    if (book == nullptr) {
+        book = createSymbolBookUnlocked(symbolId);
+    }
+    return *book;
+}
+
+template <typename Policies>
+const typename BasicOrderbook<Policies>::SymbolBook& BasicOrderbook<Policies>::symbolBook(SymbolId symbolId) const
+{
+    static const SymbolBook kEmptyBook{};
+
+    if (!isKnownSymbol(symbolId)) {
+        throw std::out_of_range("Unknown symbol");
+    }
+    const SymbolBook* book = books_[static_cast<std::size_t>(symbolId)];
+    return book != nullptr ? *book : kEmptyBook;
+}
+
+template <typename Policies>
+typename BasicOrderbook<Policies>::SymbolBook* BasicOrderbook<Policies>::createSymbolBookUnlocked(SymbolId symbolId)
+{
+    if (freeBooks_.empty()) {
+        auto chunk = std::make_unique<SymbolBook[]>(kSymbolBookChunkSize);
+        for (std::size_t i = kSymbolBookChunkSize; i > 0; --i) {
+            freeBooks_.push_back(&chunk[i - 1]);
+        }
+        bookChunks_.push_back(std::move(chunk));
+    }
+
+    SymbolBook* book = freeBooks_.back();
+    freeBooks_.pop_back();
+    book->symbolId_ = symbolId;
+    // A reclaimed symbol keeps its last trade.
+    const TopOfBook published = topOfBookSlotUnlocked(symbolId).peekFromWriter();
+    book->lastTradePrice_ = published.lastTradePrice_;
+    book->lastTradeQuantity_ = published.lastTradeQuantity_;
+    books_[static_cast<std::size_t>(symbolId)] = book;
+    if (tradeTape_) {
+        tradeTape_->prepareSymbol(symbolId); // its first spill file, mapped before the first print
+    }
+    return book;
+}
+
+template <typename Policies>
+std::size_t BasicOrderbook<Policies>::topOfBookChunkCount() const
+{
+    return (static_cast<std::size_t>(symbolUniverseSize_) + kTopOfBookChunkSize - 1) / kTopOfBookChunkSize;
+}
+
+template <typename Policies>
+typename BasicOrderbook<Policies>::TopOfBookSlot& BasicOrderbook<Policies>::topOfBookSlotUnlocked(SymbolId symbolId)
+{
+    auto& chunk = topOfBook_[symbolId / kTopOfBookChunkSize];
+    TopOfBookSlot* slots = chunk.load(std::memory_order_relaxed);
+    if (slots == nullptr) {
+        topOfBookChunks_.push_back(std::make_unique<TopOfBookSlot[]>(kTopOfBookChunkSize));
+        slots = topOfBookChunks_.back().get();
+        chunk.store(slots, std::memory_order_release);
+    }
+    return slots[symbolId % kTopOfBookChunkSize];
+}
+
+template <typename Policies>
+const typename BasicOrderbook<Policies>::TopOfBookSlot*
+BasicOrderbook<Policies>::findTopOfBookSlot(SymbolId symbolId) const
+{
+    const TopOfBookSlot* slots = topOfBook_[symbolId / kTopOfBookChunkSize].load(std::memory_order_acquire);
+    return slots != nullptr ? &slots[symbolId % kTopOfBookChunkSize] : nullptr;
+}
+
+template <typename Policies>
+void BasicOrderbook<Policies>::publishTopOfBookUnlocked(const SymbolBook& book)
+{
+    TopOfBook top;
+    if (!book.bids_.empty()) {
+        const auto& [price, level] = *book.bids_.begin();
+        top.bidPrice_ = price;
+        top.bidQuantity_ = level.totalQuantity();
+    }
+    if (!book.asks_.empty()) {
+        const auto& [price, level] = *book.asks_.begin();
+        top.askPrice_ = price;
+        top.askQuantity_ = level.totalQuantity();
+    }
+    top.lastTradePrice_ = book.lastTradePrice_;
+    top.lastTradeQuantity_ = book.lastTradeQuantity_;
+
+    // Skip unchanged snapshots so readers' cached lines stay valid.
+    auto& slot = topOfBookSlotUnlocked(book.symbolId_);
+    if (slot.peekFromWriter() != top) {
+        slot.store(top);
+    }
+}
+
+template <typename Policies>
+typename BasicOrderbook<Policies>::TopOfBook BasicOrderbook<Policies>::topOfBook(SymbolId symbolId) const
+{
+    if (!isKnownSymbol(symbolId)) {
+        throw std::out_of_range("Unknown symbol");
+    }
+    const TopOfBookSlot* slot = findTopOfBookSlot(symbolId);
+    return slot != nullptr ? slot->load() : TopOfBook{};
+}
+
+template <typename Policies>
+std::uint64_t BasicOrderbook<Policies>::topOfBookVersion(SymbolId symbolId) const
+{
+    if (!isKnownSymbol(symbolId)) {
+        throw std::out_of_range("Unknown symbol");
+    }
+    const TopOfBookSlot* slot = findTopOfBookSlot(symbolId);
+    return slot != nullptr ? slot->version() : 0;
+}
+
+template <typename Policies>
+std::size_t BasicOrderbook<Policies>::activeSymbolBookCount() const
+{
+    std::scoped_lock lock(ordersMutex_);
+    return bookChunks_.size() * kSymbolBookChunkSize - freeBooks_.size();
+}
+
+template <typename Policies>
+std::size_t BasicOrderbook<Policies>::reclaimIdleBooks()
+{
+    std::scoped_lock lock(ordersMutex_);
+
+    std::size_t released = 0;
+    for (auto& book : books_) {
+        if (book == nullptr || !book->bids_.empty() || !book->asks_.empty() || book->stops_) {
+            continue;
+        }
+        // Empty maps hold no nodes; recycling the slot lets another symbol reuse it.
+        *book = SymbolBook{};
+        freeBooks_.push_back(book);
+        book = nullptr;
+        ++released;
+    }
+    if (released == 0) {
+        return 0;
+    }
+
+    // Hand back chunks that no longer hold a book in use (a free book has no symbol).
+    std::vector<const SymbolBook*> emptyChunks;
+    for (const auto& chunk : bookChunks_) {
+        if (std::all_of(chunk.get(), chunk.get() + kSymbolBookChunkSize,
+                        [](const SymbolBook& book) { return book.symbolId_ == kInvalidSymbolId; })) {
+            emptyChunks.push_back(chunk.get());
+        }
+    }
+    if (!emptyChunks.empty()) {
+        std::sort(emptyChunks.begin(), emptyChunks.end(), std::less<>{});
+        std::erase_if(freeBooks_, [&](const SymbolBook* book) {
+            auto chunk = std::upper_bound(emptyChunks.begin(), emptyChunks.end(), book, std::less<>{});
+            return chunk != emptyChunks.begin() && std::less<>{}(book, *std::prev(chunk) + kSymbolBookChunkSize);
+        });
+        std::erase_if(bookChunks_, [&](const std::unique_ptr<SymbolBook[]>& chunk) {
+            return std::binary_search(emptyChunks.begin(), emptyChunks.end(), chunk.get(), std::less<>{});
+        });
+    }
+    return released;
+}
+
+template <typename Policies>
+OrderbookMemoryStats BasicOrderbook<Policies>::memoryStats() const
+{
+    OrderbookMemoryStats stats;
+    std::scoped_lock lock(ordersMutex_);
+
+    const auto pool = orderPool_.stats();
+    stats.orderSlotBytes = pool.slotBytes;
+    stats.orderSlotsReserved = pool.capacity;
+    stats.orderSlotsLive = pool.live;
+    stats.orderSlotsHighWater = pool.highWaterMark;
+    stats.orderPoolBytes = pool.reservedBytes() + pool.chunkCount * sizeof(void*);
+    stats.controlBlockBytes =
+        pool.live * OrderbookDetail::ControlBlockSize<BasicOrderbook>::bytes.load(std::memory_order_relaxed);
+
+    stats.orderIndexBytes = orderIndex_.memoryBytes();
+    stats.orderIndexOverflowEntries = orderIndex_.overflowSize();
+
+    const auto addLevels = [&](const auto& levels, std::size_t& levelCount, std::size_t& orderCount) {
+        using Levels = std::decay_t<decltype(levels)>;
+        levelCount = levels.size();
+        stats.priceLevelBytes += levels.size() * mapNodeBytes<Levels>();
+        for (const auto& [price, level] : levels) {
+            orderCount += level.size();
+            stats.levelQueueBytes += level.memoryBytes();
+        }
+    };
+    const auto addStops = [&](const auto& levels) {
+        using Levels = std::decay_t<decltype(levels)>;
+        stats.stopBytes += levels.size() * mapNodeBytes<Levels>();
+        for (const auto& [price, queue] : levels) {
+            stats.pendingStops += queue.size();
+            stats.stopBytes += queue.size() * listNodeBytes<PendingStop>();
+        }
+    };
+
+    for (std::size_t i = 0; i < books_.size(); ++i) {
+        const SymbolBook* book = books_[i];
+        if (book == nullptr) {
+            continue;
+        }
+        OrderbookMemoryStats::SymbolUsage usage{static_cast<SymbolId>(i), 0, 0, 0};
+        addLevels(book->bids_, usage.bidLevels, usage.orders);
+        addLevels(book->asks_, usage.askLevels, usage.orders);
+        if (book->stops_) {
+            stats.stopBytes += sizeof(StopBook);
+            addStops(book->stops_->buyStops_);
+            addStops(book->stops_->sellStops_);
+        }
+        stats.restingOrders += usage.orders;
+        stats.priceLevels += usage.bidLevels + usage.askLevels;
+        stats.symbols.push_back(usage);
+    }
+    stats.activeBooks = stats.symbols.size();
+    stats.stopBytes += unorderedMapBytes(stopIndex_);
+    stats.sessionBytes = unorderedMapBytes(sessions_);
+    stats.expiryWheelBytes = sizeof(expiryWheel_);
+
+    stats.symbolBookBytes = bookChunks_.size() * kSymbolBookChunkSize * sizeof(SymbolBook) +
+                            bookChunks_.capacity() * sizeof(bookChunks_[0]) +
+                            freeBooks_.capacity() * sizeof(SymbolBook*);
+    if constexpr (SymbolCapacity::kFixed) {
+        stats.symbolBookBytes += sizeof(books_);
+    } else {
+        stats.symbolBookBytes += books_.capacity() * sizeof(SymbolBook*);
+    }
+    stats.topOfBookBytes = topOfBookChunkCount() * sizeof(topOfBook_[0]) +
+                           topOfBookChunks_.size() * kTopOfBookChunkSize * sizeof(TopOfBookSlot) +
+                           topOfBookChunks_.capacity() * sizeof(topOfBookChunks_[0]);
+    stats.tradeTapeBytes = tradeTape_ ? tradeTape_->memoryBytes() : 0;
+    stats.riskBytes = riskChecks_ ? riskChecks_->memoryBytes() : 0;
+    return stats;
+}
+
+template <typename Policies>
+void BasicOrderbook<Policies>::enableTradeTape(TradeTapeConfig config)
+{
+    std::scoped_lock lock(ordersMutex_);
+    if (tradeTape_) {
+        throw std::logic_error("Trade tape already enabled");
+    }
+    tradeTape_ = std::make_unique<TradeTape>(symbolUniverseSize_, std::move(config));
+    for (const SymbolBook* book : books_) {
+        if (book != nullptr) {
+            tradeTape_->prepareSymbol(book->symbolId_);
+        }
+    }
+}
+
+template <typename Policies>
+void BasicOrderbook<Policies>::enableRiskChecks(RiskConfig config)
+{
+    std::scoped_lock lock(ordersMutex_);
+    if (riskChecks_) {
+        throw std::logic_error("Risk checks already enabled");
+    }
+    riskChecks_ = std::make_unique<RiskChecks>(symbolUniverseSize_, config);
+}
+
+template <typename Policies>
+void BasicOrderbook<Policies>::setAccountLimits(AccountId account, const RiskLimits& limits)
+{
+    std::scoped_lock lock(ordersMutex_);
+    if (!riskChecks_) {
+        throw std::logic_error("Risk checks not enabled");
+    }
+    riskChecks_->setLimits(account, limits);
+}
+
+template <typename Policies>
+RiskExposure BasicOrderbook<Policies>::riskExposure(AccountId account, SymbolId symbolId) const
+{
+    std::scoped_lock lock(ordersMutex_);
+    if (!riskChecks_) {
+        throw std::logic_error("Risk checks not enabled");
+    }
+    return riskChecks_->exposure(account, symbolId);
+}
+
+template <typename Policies>
+std::uint32_t BasicOrderbook<Policies>::accountOpenOrders(AccountId account) const
+{
+    std::scoped_lock lock(ordersMutex_);
+    if (!riskChecks_) {
+        throw std::logic_error("Risk checks not enabled");
+    }
+    return riskChecks_->openOrders(account);
+}
+
+template <typename Policies>
+RiskReject BasicOrderbook<Policies>::checkRiskUnlocked(const SymbolBook& book, const Order& order, Price price,
+                                                       std::uint64_t notional) const
+{
+    Price reference = book.lastTradePrice_;
+    if (reference == 0) {
+        const bool hasBid = !book.bids_.empty();
+        const bool hasAsk = !book.asks_.empty();
+        if (hasBid && hasAsk) {
+            const Price bid = book.bids_.begin()->first;
+            const Price ask = book.asks_.begin()->first;
+            reference = bid + (ask - bid) / 2;
+        } else if (hasBid) {
+            reference = book.bids_.begin()->first;
+        } else if (hasAsk) {
+            reference = book.asks_.begin()->first;
+        }
+    }
+    return riskChecks_->check(order.getAccountId(), order.getSymbolId(), order.getSide(), price,
+                              order.getQuantity(), reference, notional);
+}
+
+template <typename Policies>
+void BasicOrderbook<Policies>::recordFillUnlocked(const Order& aggressor, const Order& resting, Quantity quantity)
+{
+    if (riskChecks_) {
+        riskChecks_->onFilled(aggressor.getAccountId(), aggressor.getSymbolId(), aggressor.getSide(), quantity);
+        riskChecks_->onFilled(resting.getAccountId(), resting.getSymbolId(), resting.getSide(), quantity);
+    }
+}
+
+template <typename Policies>
+SymbolId BasicOrderbook<Policies>::resolveSymbol(std::string_view symbol) const
+{
+    const SymbolId symbolId = symbolTable_.resolve(symbol);
+    if (symbolId != kInvalidSymbolId) {
+        return symbolId;
+    }
+    return toSymbolId(symbol, symbolUniverseSize_);
+}
+
+template <typename Policies>
+void BasicOrderbook<Policies>::linkToSessionUnlocked(Order& order)
+{
+    if (order.sessionId_ == kNoSession) {
+        return;
+    }
+    auto& session = sessions_[order.sessionId_];
+    order.sessionPrev_ = nullptr;
+    order.sessionNext_ = session.head_;
+    if (session.head_ != nullptr) {
+        session.head_->sessionPrev_ = &order;
+    }
+    session.head_ = &order;
+    ++session.count_;
+}
+
+template <typename Policies>
+void BasicOrderbook<Policies>::unlinkFromSessionUnlocked(Order& order)
+{
+    if (order.sessionId_ == kNoSession) {
+        return;
+    }
+    auto it = sessions_.find(order.sessionId_);
+    if (it == sessions_.end()) {
+        return;
+    }
+    auto& session = it->second;
+    if (order.sessionPrev_ != nullptr) {
+        order.sessionPrev_->sessionNext_ = order.sessionNext_;
+    } else {
+        session.head_ = order.sessionNext_;
+    }
+    if (order.sessionNext_ != nullptr) {
+        order.sessionNext_->sessionPrev_ = order.sessionPrev_;
+    }
+    order.sessionPrev_ = nullptr;
+    order.sessionNext_ = nullptr;
+    if (--session.count_ == 0) {
+        sessions_.erase(it);
+    }
+}
+
+template <typename Policies>
+void BasicOrderbook<Policies>::attachOrderUnlocked(Order& order)
+{
+    linkToSessionUnlocked(order);
+    if (order.getTimeInForce() == TimeInForce::GoodTillDate) {
+        expiryWheel_.schedule(order, order.getExpireTime());
+    }
+    if (riskChecks_) {
+        riskChecks_->onAccepted(order.getAccountId(), order.getSymbolId(), order.getSide(), order.getUnfilledQuantity());
+    }
+}
+
+template <typename Policies>
+void BasicOrderbook<Policies>::detachOrderUnlocked(Order& order)
+{
+    unlinkFromSessionUnlocked(order);
+    expiryWheel_.cancel(order);
+    if (riskChecks_) {
+        riskChecks_->onReleased(order.getAccountId(), order.getSymbolId(), order.getSide(), order.getUnfilledQuantity());
+    }
+}
+
+template <typename Policies>
+typename BasicOrderbook<Policies>::OrderPointer
+BasicOrderbook<Policies>::makePooledOrder(OrderId orderId, Price price, Quantity quantity, Side side, SymbolId symbolId,
+                                          SessionId sessionId)
+{
+    Order* raw = orderPool_.allocate(orderId, price, quantity, side, symbolId, sessionId);
+    return OrderPointer(raw, [this](Order* ptr) {
+        orderPool_.deallocate(ptr);
+    }, OrderbookDetail::ControlBlockAllocator<Order, BasicOrderbook>{});
+}
+
+template <typename Policies>
+std::string BasicOrderbook<Policies>::processFixMessage(const std::string_view message, SessionId session)
+{
+    using std::string;
+
+    Fix::ParsedFixFields fields;
+    if (!Fix::parseFixFields(message, fields)) {
+        return string(Response::kErr);
+    }
+
+    if (!Fix::hasRequiredFields(fields, fields.msgType)) {
+        return string(Response::kErr);
+    }
+
+    if (fields.msgType == Fix::kMsgCancel) {
+        OrderId orderId = 0;
+        if (!Fix::parseInteger(fields.orderId, orderId)) {
+            return string(Response::kErr);
+        }
+
+        cancelOrder(orderId);
+        return string(Response::kOk);
+    }
+
+    if (fields.msgType == Fix::kMsgMassCancel) {
+        if (session == kNoSession) {
+            return string(Response::kErr);
+        }
+
+        SymbolId symbolId = kInvalidSymbolId;
+        if (fields.massCancelType == Fix::kMassCancelBySymbol) {
+            symbolId = resolveSymbol(fields.symbol);
+            if (symbolId == kInvalidSymbolId) {
+                return string(Response::kErr);
+            }
+        }
+
+        std::optional<Side> side;
+        if (!fields.side.empty()) {
+            Side parsed;
+            if (!Fix::parseSide(fields.side, parsed)) {
+                return string(Response::kErr);
+            }
+            side = parsed;
+        }
+
+        const std::size_t cancelled = cancelSessionOrders(session, symbolId, side);
+        return string(Response::kMassCancelled) + std::to_string(cancelled);
+    }
+
+    if (fields.msgType == Fix::kMsgClock) {
+        std::uint64_t nowMs = 0;
+        if (session != kNoSession || !Fix::parseInteger(fields.transactTime, nowMs)) {
+            return string(Response::kErr);
+        }
+
+        std::size_t expired = expireOrders(nowMs);
+        if (fields.timeInForce == "0") {
+            expired += cancelDayOrders();
+        }
+        return string(Response::kExpired) + std::to_string(expired);
+    }
+
+    if (fields.msgType == Fix::kMsgModify) {
+        OrderId orderId = 0;
+        Price price = 0;
+        Quantity qty = 0;
+        if (!Fix::parseInteger(fields.orderId, orderId) ||
+            !Fix::parseInteger(fields.price, price) ||
+            !Fix::parseInteger(fields.quantity, qty)) {
+            return string(Response::kErr);
+        }
+
+        Side side;
+        if (!Fix::parseSide(fields.side, side)) {
+            return string(Response::kErr);
+        }
+
+        const SymbolId symbolId = resolveSymbol(fields.symbol);
+        if (symbolId == kInvalidSymbolId) {
+            return string(Response::kErr);
+        }
+        if (qty == 0 || price == 0) {
+            return string(Response::kErr);
+        }
+
+        RiskReject rejected = RiskReject::None;
+        modifyOrder(OrderModify{orderId, price, qty, side, symbolId}, &rejected);
+        if (rejected != RiskReject::None) {
+            return string(Response::kRiskRejected) + string(riskRejectName(rejected));
+        }
+        return string(Response::kOk);
+    }
+
+    // New order
+    OrderType orderType;
+    if (!Fix::parseOrderType(fields.ordType, orderType)) {
+        return string(Response::kErr);
+    }
+    const bool isStop = orderType == OrderType::Stop || orderType == OrderType::StopLimit;
+    const bool hasPrice = orderType == OrderType::Limit || orderType == OrderType::StopLimit;
+
+    TimeInForce timeInForce;
+    if (!Fix::parseTimeInForce(fields.timeInForce, timeInForce)) {
+        return string(Response::kErr);
+    }
+    if (orderType == OrderType::Market && timeInForce != TimeInForce::FillOrKill) {
+        timeInForce = TimeInForce::ImmediateOrCancel; // a market order never rests
+    }
+    const bool isGoodTillDate = timeInForce == TimeInForce::GoodTillDate;
+    if (isStop && isImmediate(timeInForce)) {
+        return string(Response::kErr);
+    }
+
+    OrderId orderId = 0;
+    Price price = 0;
+    Price stopPrice = 0;
+    Quantity qty = 0;
+    std::uint64_t expireTime = 0;
+    AccountId account = kDefaultAccount;
+    if (!Fix::parseInteger(fields.orderId, orderId) ||
+        (hasPrice && !Fix::parseInteger(fields.price, price)) ||
+        (isStop && !Fix::parseInteger(fields.stopPrice, stopPrice)) ||
+        (isGoodTillDate && !Fix::parseInteger(fields.expireTime, expireTime)) ||
+        (!fields.account.empty() && !Fix::parseInteger(fields.account, account)) ||
+        !Fix::parseInteger(fields.quantity, qty)) {
+        return string(Response::kErr);
+    }
+
+    Side side;
+    if (!Fix::parseSide(fields.side, side)) {
+        return string(Response::kErr);
+    }
+
+    const SymbolId symbolId = resolveSymbol(fields.symbol);
+    if (symbolId == kInvalidSymbolId) {
+        return string(Response::kErr);
+    }
+    if (qty == 0 || (hasPrice && price == 0) || (isStop && stopPrice == 0)) {
+        return string(Response::kErr);
+    }
+
+    {
+        std::scoped_lock lock(ordersMutex_);
+        if (isLiveOrderIdUnlocked(orderId)) {
+            return string(Response::kErr);
+        }
+    }
+
+    auto order = makePooledOrder(orderId, price, qty, side, symbolId, session);
+    // An expiry already in the past is accepted and expires on the next clock tick.
+    order->setTimeInForce(timeInForce, expireTime);
+    order->setAccountId(account);
+
+    RiskReject rejected = RiskReject::None;
+    bool accepted = true;
+    if (isStop) {
+        accepted = addStopOrder(order, orderType, stopPrice, &rejected);
+    } else {
+        addOrder(order, &rejected);
+    }
+    if (rejected != RiskReject::None) {
+        return string(Response::kRiskRejected) + string(riskRejectName(rejected));
+    }
+    if (isImmediate(timeInForce)) {
+        // Gone from the engine already; the reply is all the client hears of it.
+        return string(Response::kFilled) + std::to_string(order->getQuantity() - order->getUnfilledQuantity());
+    }
+    return string(accepted ? Response::kCreated : Response::kErr);
+}
+
+template <typename Policies>
+typename BasicOrderbook<Policies>::Trades BasicOrderbook<Policies>::addOrder(const OrderPointer& order,
+                                                                             RiskReject* rejected)
+{
+    if (!order) {
+        return { };
+    }
+
+    if (!isKnownSymbol(order->getSymbolId())) {
+        return { };
+    }
+
+    std::scoped_lock lock(ordersMutex_);
+    return addOrderUnlocked(order, rejected);
+}
+
+template <typename Policies>
+typename BasicOrderbook<Policies>::Trades BasicOrderbook<Policies>::addOrderUnlocked(const OrderPointer& order,
+                                                                                     RiskReject* rejected)
+{
+    if (isLiveOrderIdUnlocked(order->getOrderId())) {
+        return { };
+    }
+
+    auto& book = symbolBook(order->getSymbolId());
+    const bool immediate = isImmediate(order->getTimeInForce());
+    Price checkPrice = order->getPrice();
+    std::uint64_t checkNotional = 0;
+    if (immediate && checkPrice == 0) {
+        // Market order: the band applies to the deepest level it would reach and
+        // the notional to what it would take; nothing to take, nothing to do.
+        const SweepExtent extent = sweepExtentUnlocked(book, order->getSide(), order->getQuantity());
+        if (extent.worstPrice_ == 0) {
+            return { };
+        }
+        checkPrice = extent.worstPrice_;
+        checkNotional = extent.notional_;
+    }
+    if (riskChecks_) {
+        const RiskReject reject = checkRiskUnlocked(book, *order, checkPrice, checkNotional);
+        if (reject != RiskReject::None) {
+            if (rejected != nullptr) {
+                *rejected = reject;
+            }
+            return { };
+        }
+    }
+
+    if (immediate) {
+        Trades trades;
+        if (order->getTimeInForce() == TimeInForce::FillOrKill &&
+            crossingQuantityUnlocked(book, order->getSide(), order->getPrice(), order->getQuantity()) <
+                order->getQuantity()) {
+            return trades;
+        }
+        // Only the risk exposure sees the order, for the length of the sweep.
+        if (riskChecks_) {
+            riskChecks_->onAccepted(order->getAccountId(), order->getSymbolId(), order->getSide(), order->getQuantity());
+        }
+        sweepUnlocked(book, *order, order->getPrice(), trades);
+        if (riskChecks_) {
+            riskChecks_->onReleased(order->getAccountId(), order->getSymbolId(), order->getSide(),
+                                    order->getUnfilledQuantity());
+        }
+        if (!trades.empty()) {
+            if (book.stops_) {
+                fireStopsUnlocked(book, order->getSide(), trades);
+            }
+            publishTopOfBookUnlocked(book);
+        }
+        return trades;
+    }
+
+    attachOrderUnlocked(*order);
+
+    Trades trades = restAndMatchUnlocked(book, order);
+    if (book.stops_ && !trades.empty()) {
+        fireStopsUnlocked(book, order->getSide(), trades);
+    }
+    publishTopOfBookUnlocked(book);
+    return trades;
+}
+
+template <typename Policies>
+typename BasicOrderbook<Policies>::Trades BasicOrderbook<Policies>::restAndMatchUnlocked(SymbolBook& book,
+                                                                                          const OrderPointer& order)
+{
+    typename Level::Handle handle;
+
+    if (order->getSide() == Side::BUY) {
+        handle = book.bids_[order->getPrice()].push_back(order);
+    } else {
+        handle = book.asks_[order->getPrice()].push_back(order);
+    }
+
+    orderIndex_.upsert(order->getOrderId(), OrderLocator{order, handle, &book});
+
+    return matchOrders(book, order->getSide());
+}
+
+// Execution that never rests, for a triggered stop or an IOC, FOK or market
+// order: takes liquidity level by level at the resting prices, up to `limit`
+// (any price when 0). Whatever is left unfilled is dropped. A limit order's side
+// of each trade carries its own price, as when it matches on arrival.
+template <typename Policies>
+void BasicOrderbook<Policies>::sweepUnlocked(SymbolBook& book, Order& order, Price limit, Trades& trades)
+{
+    std::int64_t tapeTimestamp = 0; // one clock read per sweep, on its first print
+    const auto sweep = [&](auto& levels, auto crosses) {
+        if constexpr (kBulkLevels) {
+            while (!order.isFilled() && !levels.empty() && crosses(levels.begin()->first)) {
+                auto levelIt = levels.begin();
+                takeFromLevelUnlocked(book, order, limit == 0 ? levelIt->first : limit, levelIt->second,
+                                      levelIt->first, trades, tapeTimestamp);
+                if (levelIt->second.empty()) {
+                    levels.erase(levelIt);
+                }
+            }
+            return;
+        }
+        while (!order.isFilled() && !levels.empty() && crosses(levels.begin()->first)) {
+            auto levelIt = levels.begin();
+            const Price levelPrice = levelIt->first;
+            auto& queue = levelIt->second;
+
+            while (!order.isFilled() && !queue.empty()) {
+                const auto resting = queue.front();
+                const Quantity tradeQty = std::min(order.getUnfilledQuantity(), resting->getUnfilledQuantity());
+                order.fill(tradeQty);
+                resting->fill(tradeQty);
+                queue.reduce(tradeQty);
+                recordFillUnlocked(order, *resting, tradeQty);
+                book.lastTradePrice_ = levelPrice;
+                book.lastTradeQuantity_ = tradeQty;
+                if (tradeTape_) {
+                    if (tapeTimestamp == 0) {
+                        tapeTimestamp = TradeTape::now();
+                    }
+                    tradeTape_->append(book.symbolId_, levelPrice, tradeQty, order.getSide(), tapeTimestamp);
+                }
+
+                const TradeInfo incoming{limit == 0 ? levelPrice : limit, tradeQty, order.getOrderId(),
+                                         order.getSymbolId()};
+                const TradeInfo passive{levelPrice, tradeQty, resting->getOrderId(), resting->getSymbolId()};
+                trades.push_back(order.getSide() == Side::BUY ? Trade{incoming, passive} : Trade{passive, incoming});
+
+                if (resting->isFilled()) {
+                    queue.pop_front();
+                    orderIndex_.erase(resting->getOrderId());
+                    detachOrderUnlocked(*resting);
+                }
+            }
+
+            if (queue.empty()) {
+                levels.erase(levelIt);
+            }
+        }
+    };
+
+    if (order.getSide() == Side::BUY) {
+        sweep(book.asks_, [limit](Price ask) { return limit == 0 || ask <= limit; });
+    } else {
+        sweep(book.bids_, [limit](Price bid) { return limit == 0 || bid >= limit; });
+    }
+}
+
+// Opposite quantity an order on `side` could take up to `limit` (any price when
+// 0), summed from the level aggregates until it reaches `wanted`.
+template <typename Policies>
+typename BasicOrderbook<Policies>::Quantity BasicOrderbook<Policies>::crossingQuantityUnlocked(
+    const SymbolBook& book, Side side, Price limit, Quantity wanted) const
+{
+    Quantity available = 0;
+    const auto sum = [&](const auto& levels, auto crosses) {
+        for (auto it = levels.begin(); it != levels.end() && available < wanted && crosses(it->first); ++it) {
+            available += it->second.totalQuantity();
+        }
+    };
+    if (side == Side::BUY) {
+        sum(book.asks_, [limit](Price ask) { return limit == 0 || ask <= limit; });
+    } else {
+        sum(book.bids_, [limit](Price bid) { return limit == 0 || bid >= limit; });
+    }
+    return available;
+}
+
+template <typename Policies>
+typename BasicOrderbook<Policies>::SweepExtent BasicOrderbook<Policies>::sweepExtentUnlocked(
+    const SymbolBook& book, Side side, Quantity wanted) const
+{
+    SweepExtent extent;
+    Quantity remaining = wanted;
+    const auto walk = [&](const auto& levels) {
+        for (auto it = levels.begin(); it != levels.end() && remaining > 0; ++it) {
+            const Quantity taken = std::min(remaining, static_cast<Quantity>(it->second.totalQuantity()));
+            extent.worstPrice_ = it->first;
+            extent.notional_ += static_cast<std::uint64_t>(it->first) * static_cast<std::uint64_t>(taken);
+            remaining -= taken;
+        }
+    };
+    if (side == Side::BUY) {
+        walk(book.asks_);
+    } else {
+        walk(book.bids_);
+    }
+    return extent;
+}
+
+// One aggressor against one resting level through Level::consume(): the level
+// works out how many orders the aggressor takes whole, then each fill is booked
+// as in the per-order loop. The aggressor's side of the trade carries
+// aggressorPrice, the resting side levelPrice (which is also the print).
+template <typename Policies>
+template <typename LevelT>
+typename BasicOrderbook<Policies>::Quantity BasicOrderbook<Policies>::takeFromLevelUnlocked(
+    SymbolBook& book, Order& aggressor, Price aggressorPrice, LevelT& level, Price levelPrice, Trades& trades,
+    std::int64_t& tapeTimestamp)
+{
+    return level.consume(aggressor.getUnfilledQuantity(), [&](const OrderPointer& resting, Quantity tradeQty) {
+        aggressor.fill(tradeQty);
+        resting->fill(tradeQty);
+        recordFillUnlocked(aggressor, *resting, tradeQty);
+        book.lastTradePrice_ = levelPrice;
+        book.lastTradeQuantity_ = tradeQty;
+        if (tradeTape_) {
+            if (tapeTimestamp == 0) {
+                tapeTimestamp = TradeTape::now();
+            }
+            tradeTape_->append(book.symbolId_, levelPrice, tradeQty, aggressor.getSide(), tapeTimestamp);
+        }
+
+        const TradeInfo incoming{aggressorPrice, tradeQty, aggressor.getOrderId(), aggressor.getSymbolId()};
+        const TradeInfo passive{levelPrice, tradeQty, resting->getOrderId(), resting->getSymbolId()};
+        trades.push_back(aggressor.getSide() == Side::BUY ? Trade{incoming, passive} : Trade{passive, incoming});
+
+        if (resting->isFilled()) {
+            orderIndex_.erase(resting->getOrderId());
+            detachOrderUnlocked(*resting);
+        }
+    });
+}
+
+template <typename Policies>
+void BasicOrderbook<Policies>::collectTriggeredStopsUnlocked(SymbolBook& book, Price high, Price low,
+                                                            std::vector<PendingStop>& triggered)
+{
+    // Both maps are ordered nearest-to-market first, so this touches only the
+    // triggered levels plus one begin() per side.
+    const auto take = [&](auto& levels, auto fires) {
+        while (!levels.empty() && fires(levels.begin()->first)) {
+            for (auto& pending : levels.begin()->second) {
+                stopIndex_.erase(pending.order_->getOrderId());
+                triggered.push_back(std::move(pending));
+            }
+            levels.erase(levels.begin());
+        }
+    };
+
+    take(book.stops_->buyStops_, [high](Price stopPrice) { return stopPrice <= high; });
+    take(book.stops_->sellStops_, [low](Price stopPrice) { return stopPrice >= low; });
+
+    if (book.stops_->empty()) {
+        book.stops_.reset();
+    }
+}
+
+// Fires stops hit by trades[0..] (printed by an aggressor on aggressorSide), then
+// any stops those injections trigger, until the book is quiet. Injection order is
+// deterministic: per trigger pass, buy stops by ascending stop price then sell
+// stops by descending stop price, each FIFO within a price.
+template <typename Policies>
+void BasicOrderbook<Policies>::fireStopsUnlocked(SymbolBook& book, Side aggressorSide, Trades& trades)
+{
+    std::vector<PendingStop> triggered;
+    std::size_t nextTriggered = 0;
+    std::size_t unscannedTrades = 0;
+    Side side = aggressorSide;
+
+    while (true) {
+        if (book.stops_ && unscannedTrades < trades.size()) {
+            Price high = 0;
+            Price low = std::numeric_limits<Price>::max();
+            for (std::size_t i = unscannedTrades; i < trades.size(); ++i) {
+                // The print is the passive side's price.
+                const Price printed = side == Side::BUY ? trades[i].getAskTradeInfo().getPrice()
+                                                        : trades[i].getBidTradeInfo().getPrice();
+                high = std::max(high, printed);
+                low = std::min(low, printed);
+            }
+            collectTriggeredStopsUnlocked(book, high, low, triggered);
+        }
+
+        if (nextTriggered == triggered.size()) {
+            break;
+        }
+
+        const PendingStop stop = std::move(triggered[nextTriggered++]);
+        unscannedTrades = trades.size();
+        side = stop.order_->getSide();
+
+        if (stop.type_ == OrderType::StopLimit) {
+            Trades more = restAndMatchUnlocked(book, stop.order_);
+            trades.insert(trades.end(), more.begin(), more.end());
+        } else {
+            sweepUnlocked(book, *stop.order_, 0, trades);
+            detachOrderUnlocked(*stop.order_);
+        }
+    }
+}
+
+template <typename Policies>
+bool BasicOrderbook<Policies>::addStopOrder(const OrderPointer& order, OrderType type, Price stopPrice,
+                                            RiskReject* rejected)
+{
+    if (!order || (type != OrderType::Stop && type != OrderType::StopLimit) || isImmediate(order->getTimeInForce()) ||
+        !isKnownSymbol(order->getSymbolId())) {
+        return false;
+    }
+
+    std::scoped_lock lock(ordersMutex_);
+
+    if (isLiveOrderIdUnlocked(order->getOrderId())) {
+        return false;
+    }
+
+    auto& book = symbolBook(order->getSymbolId());
+    if (riskChecks_) {
+        const RiskReject reject =
+            checkRiskUnlocked(book, *order, type == OrderType::Stop ? stopPrice : order->getPrice());
+        if (reject != RiskReject::None) {
+            if (rejected != nullptr) {
+                *rejected = reject;
+            }
+            return false;
+        }
+    }
+    if (!book.stops_) {
+        book.stops_ = std::make_unique<StopBook>();
+    }
+
+    StopQueue& queue = order->getSide() == Side::BUY ? book.stops_->buyStops_[stopPrice]
+                                                      : book.stops_->sellStops_[stopPrice];
+    queue.push_back(PendingStop{order, type});
+    stopIndex_.emplace(order->getOrderId(), StopLocator{std::prev(queue.end()), &book, stopPrice, order->getSide()});
+    attachOrderUnlocked(*order);
+    return true;
+}
+
+template <typename Policies>
+std::size_t BasicOrderbook<Policies>::pendingStopCount(SymbolId symbolId) const
+{
+    std::scoped_lock lock(ordersMutex_);
+
+    const auto& book = symbolBook(symbolId);
+    if (!book.stops_) {
+        return 0;
+    }
+    std::size_t count = 0;
+    for (const auto& [price, queue] : book.stops_->buyStops_) {
+        count += queue.size();
+    }
+    for (const auto& [price, queue] : book.stops_->sellStops_) {
+        count += queue.size();
+    }
+    return count;
+}
+
+template <typename Policies>
+bool BasicOrderbook<Policies>::isLiveOrderIdUnlocked(OrderId orderId) const
+{
+    return orderIndex_.contains(orderId) || (!stopIndex_.empty() && stopIndex_.count(orderId) != 0);
+}
+
+template <typename Policies>
+void BasicOrderbook<Policies>::cancelOrder(OrderId orderId)
+{
+    std::scoped_lock lock(ordersMutex_);
+    cancelOrderUnlocked(orderId);
+}
+
+template <typename Policies>
+bool BasicOrderbook<Policies>::cancelOrderUnlocked(OrderId orderId)
+{
+    OrderLocator* locator = orderIndex_.find(orderId);
+    if (locator == nullptr || locator->book_ == nullptr) {
+        return cancelStopUnlocked(orderId);
+    }
+
+    auto& book = *locator->book_;
+    const auto order = locator->order_;
+    const auto handle = locator->location_;
+    orderIndex_.erase(orderId);
+    detachOrderUnlocked(*order);
+
+    if (order->getSide() == Side::BUY) {
+        auto price = order->getPrice();
+        auto& orders = book.bids_.at(price);
+        orders.erase(handle);
+        if (orders.empty()) {
+            book.bids_.erase(price);
+        }
+    } else {
+        auto price = order->getPrice();
+        auto& orders = book.asks_.at(price);
+        orders.erase(handle);
+        if (orders.empty()) {
+            book.asks_.erase(price);
+        }
+    }
+    publishTopOfBookUnlocked(book);
+    return true;
+}
+
+template <typename Policies>
+bool BasicOrderbook<Policies>::cancelStopUnlocked(OrderId orderId)
+{
+    if (stopIndex_.empty()) {
+        return false;
+    }
+    auto it = stopIndex_.find(orderId);
+    if (it == stopIndex_.end()) {
+        return false;
+    }
+
+    const StopLocator locator = it->second;
+    stopIndex_.erase(it);
+
+    SymbolBook& book = *locator.book_;
+    const auto order = locator.location_->order_;
+    detachOrderUnlocked(*order);
+
+    const auto remove = [&](auto& levels) {
+        auto level = levels.find(locator.stopPrice_);
+        level->second.erase(locator.location_);
+        if (level->second.empty()) {
+            levels.erase(level);
+        }
+    };
+    if (locator.side_ == Side::BUY) {
+        remove(book.stops_->buyStops_);
+    } else {
+        remove(book.stops_->sellStops_);
+    }
+    if (book.stops_->empty()) {
+        book.stops_.reset();
+    }
+    return true;
+}
+
+template <typename Policies>
+std::size_t BasicOrderbook<Policies>::cancelSessionOrders(SessionId session, SymbolId symbolId, std::optional<Side> side)
+{
+    std::scoped_lock lock(ordersMutex_);
+
+    auto it = sessions_.find(session);
+    if (it == sessions_.end()) {
+        return 0;
+    }
+
+    std::size_t cancelled = 0;
+    Order* order = it->second.head_;
+    while (order != nullptr) {
+        // Read the link first: cancelling unlinks the order and may release it
+        // (and, with the last order, the session entry).
+        Order* next = order->sessionNext_;
+        const bool symbolMatches = symbolId == kInvalidSymbolId || order->getSymbolId() == symbolId;
+        const bool sideMatches = !side || order->getSide() == *side;
+        if (symbolMatches && sideMatches && cancelOrderUnlocked(order->getOrderId())) {
+            ++cancelled;
+        }
+        order = next;
+    }
+    return cancelled;
+}
+
+template <typename Policies>
+std::size_t BasicOrderbook<Policies>::sessionOrderCount(SessionId session) const
+{
+    std::scoped_lock lock(ordersMutex_);
+    auto it = sessions_.find(session);
+    return it == sessions_.end() ? 0 : it->second.count_;
+}
+
+template <typename Policies>
+std::vector<SessionId> BasicOrderbook<Policies>::sessionsWithOrders() const
+{
+    std::scoped_lock lock(ordersMutex_);
+    std::vector<SessionId> sessions;
+    sessions.reserve(sessions_.size());
+    for (const auto& [session, orders] : sessions_) {
+        sessions.push_back(session);
+    }
+    return sessions;
+}
+
+template <typename Policies>
+std::size_t BasicOrderbook<Policies>::expireOrders(std::uint64_t nowMs, ExpiredOrders* expired)
+{
+    std::scoped_lock lock(ordersMutex_);
+    return expiryWheel_.advance(nowMs, [&](Order& order) {
+        // Report first: the cancel may release the order.
+        if (expired != nullptr) {
+            expired->push_back(ExpiredOrder{order.getOrderId(), order.getSessionId()});
+        }
+        cancelOrderUnlocked(order.getOrderId());
+    });
+}
+
+template <typename Policies>
+std::size_t BasicOrderbook<Policies>::cancelDayOrders(ExpiredOrders* cancelled)
+{
+    std::scoped_lock lock(ordersMutex_);
+
+    std::size_t count = 0;
+    const auto isDayOrder = [&](const OrderPointer& order) {
+        if (order->getTimeInForce() != TimeInForce::Day) {
+            return false;
+        }
+        if (cancelled != nullptr) {
+            cancelled->push_back(ExpiredOrder{order->getOrderId(), order->getSessionId()});
+        }
+        detachOrderUnlocked(*order);
+        ++count;
+        return true;
+    };
+    const auto sweepLevels = [&](auto& levels) {
+        for (auto it = levels.begin(); it != levels.end();) {
+            it->second.eraseIf([&](const OrderPointer& order) {
+                if (!isDayOrder(order)) {
+                    return false;
+                }
+                orderIndex_.erase(order->getOrderId());
+                return true;
+            });
+            it = it->second.empty() ? levels.erase(it) : std::next(it);
+        }
+    };
+    const auto sweepStops = [&](auto& levels) {
+        for (auto it = levels.begin(); it != levels.end();) {
+            it->second.remove_if([&](const PendingStop& stop) {
+                if (!isDayOrder(stop.order_)) {
+                    return false;
+                }
+                stopIndex_.erase(stop.order_->getOrderId());
+                return true;
+            });
+            it = it->second.empty() ? levels.erase(it) : std::next(it);
+        }
+    };
+
+    for (SymbolBook* book : books_) {
+        if (book == nullptr) {
+            continue;
+        }
+        sweepLevels(book->bids_);
+        sweepLevels(book->asks_);
+        if (book->stops_) {
+            sweepStops(book->stops_->buyStops_);
+            sweepStops(book->stops_->sellStops_);
+            if (book->stops_->empty()) {
+                book->stops_.reset();
+            }
+        }
+        publishTopOfBookUnlocked(*book);
+    }
+    return count;
+}
+
+template <typename Policies>
+std::size_t BasicOrderbook<Policies>::pendingExpiryCount() const
+{
+    std::scoped_lock lock(ordersMutex_);
+    return expiryWheel_.size();
+}
+
+template <typename Policies>
+typename BasicOrderbook<Policies>::Trades BasicOrderbook<Policies>::modifyOrder(OrderModify order,
+                                                                                RiskReject* rejected)
+{
+    // Check, cancel and re-add in one critical section: nothing can trade in
+    // between and turn a checked replacement into a refused one.
+    std::scoped_lock lock(ordersMutex_);
+    const OrderLocator* locator = orderIndex_.find(order.getOrderId());
+    if (locator == nullptr || locator->order_ == nullptr) {
+        return { };
+    }
+    const Order& existing = *locator->order_;
+
+    // Keep modification symbol-scoped to avoid moving an order across books implicitly.
+    if (existing.getSymbolId() != order.getSymbolId()) {
+        return { };
+    }
+
+    OrderPointer replacement = makePooledOrder(
+        order.getOrderId(),
+        order.getPrice(),
+        order.getQuantity(),
+        order.getSide(),
+        order.getSymbolId(),
+        existing.getSessionId());
+    replacement->setTimeInForce(existing.getTimeInForce(), existing.getExpireTime());
+    replacement->setAccountId(existing.getAccountId());
+
+    // Check the replacement as if the original were gone, before touching
+    // the book, so a refused modify leaves the original resting.
+    if (riskChecks_) {
+        riskChecks_->onReleased(existing.getAccountId(), existing.getSymbolId(), existing.getSide(),
+                                existing.getUnfilledQuantity());
+        const RiskReject reject = checkRiskUnlocked(symbolBook(order.getSymbolId()), *replacement,
+                                                     replacement->getPrice());
+        riskChecks_->onAccepted(existing.getAccountId(), existing.getSymbolId(), existing.getSide(),
+                                existing.getUnfilledQuantity());
+        if (reject != RiskReject::None) {
+            if (rejected != nullptr) {
+                *rejected = reject;
+            }
+            return { };
+        }
+    }
+
+    cancelOrderUnlocked(order.getOrderId());
+    return addOrderUnlocked(replacement, rejected);
+}
+
+template <typename Policies>
+typename BasicOrderbook<Policies>::Trades BasicOrderbook<Policies>::matchOrders(SymbolBook& book, Side aggressorSide)
+{
+    Trades trades;
+    trades.reserve(book.bids_.size() + book.asks_.size());
+    std::int64_t tapeTimestamp = 0; // one clock read per match, on its first print
+
+    if constexpr (kBulkLevels) {
+        // The aggressor is the front of its own best level (the book was not
+        // crossed before it arrived); it takes each crossing level in bulk.
+        const auto cross = [&](auto& own, auto& passive, auto crosses) {
+            while (!own.empty() && !passive.empty() && crosses(own.begin()->first, passive.begin()->first)) {
+                auto ownIt = own.begin();
+                auto passiveIt = passive.begin();
+                auto& ownQueue = ownIt->second;
+                const OrderPointer aggressor = ownQueue.front();
+                ownQueue.reduce(takeFromLevelUnlocked(book, *aggressor, ownIt->first, passiveIt->second,
+                                                      passiveIt->first, trades, tapeTimestamp));
+                if (passiveIt->second.empty()) {
+                    passive.erase(passiveIt);
+                }
+                if (aggressor->isFilled()) {
+                    ownQueue.pop_front();
+                    orderIndex_.erase(aggressor->getOrderId());
+                    detachOrderUnlocked(*aggressor);
+                    if (ownQueue.empty()) {
+                        own.erase(ownIt);
+                    }
+                }
+            }
+        };
+        if (aggressorSide == Side::BUY) {
+            cross(book.bids_, book.asks_, [](Price bid, Price ask) { return bid >= ask; });
+        } else {
+            cross(book.asks_, book.bids_, [](Price ask, Price bid) { return bid >= ask; });
+        }
+        return trades;
+    }
+
+    while (!book.bids_.empty() && !book.asks_.empty()) {
+        auto bestBidIt = book.bids_.begin();
+        auto bestAskIt = book.asks_.begin();
+
+        Price bestBidPrice = bestBidIt->first;
+        Price bestAskPrice = bestAskIt->first;
+
+        if (bestBidPrice < bestAskPrice) {
+            break;
+        }
+
+        auto& bidQueue = bestBidIt->second;
+        auto& askQueue = bestAskIt->second;
+
+        auto bidOrder = bidQueue.front();
+        auto askOrder = askQueue.front();
+
+        Quantity tradeQty = std::min(bidOrder->getUnfilledQuantity(), askOrder->getUnfilledQuantity());
+
+        bidOrder->fill(tradeQty);
+        askOrder->fill(tradeQty);
+        bidQueue.reduce(tradeQty);
+        askQueue.reduce(tradeQty);
+        recordFillUnlocked(*bidOrder, *askOrder, tradeQty);
+
+        trades.push_back(Trade{
+            TradeInfo{bestBidPrice, tradeQty, bidOrder->getOrderId(), bidOrder->getSymbolId()},
+            TradeInfo{bestAskPrice, tradeQty, askOrder->getOrderId(), askOrder->getSymbolId()}
+        });
+        // The resting side sets the print.
+        book.lastTradePrice_ = aggressorSide == Side::BUY ? bestAskPrice : bestBidPrice;
+        book.lastTradeQuantity_ = tradeQty;
+        if (tradeTape_) {
+            if (tapeTimestamp == 0) {
+                tapeTimestamp = TradeTape::now();
+            }
+            tradeTape_->append(book.symbolId_, book.lastTradePrice_, tradeQty, aggressorSide, tapeTimestamp);
+        }
+
+        if (bidOrder->isFilled()) {
+            bidQueue.pop_front();
+            orderIndex_.erase(bidOrder->getOrderId());
+            detachOrderUnlocked(*bidOrder);
+        }
+
+        if (askOrder->isFilled()) {
+            askQueue.pop_front();
+            orderIndex_.erase(askOrder->getOrderId());
+            detachOrderUnlocked(*askOrder);
+        }
+
+        if (bidQueue.empty()) {
+            book.bids_.erase(bestBidIt);
+        }
+        if (askQueue.empty()) {
+            book.asks_.erase(bestAskIt);
+        }
+    }
+
+    return trades;
+}
+
+template <typename Policies>
+void BasicOrderbook<Policies>::printOrderBook() const
+{
+    std::scoped_lock lock(ordersMutex_);
+    std::cout << "Order Book:\n";
+
+    for (std::size_t i = 0; i < books_.size(); ++i) {
+        if (books_[i] == nullptr) {
+            continue;
+        }
+        const SymbolId symbolId = static_cast<SymbolId>(i);
+        const auto& book = *books_[i];
+        std::cout << "Symbol: " << symbolId << "\n";
+        std::cout << "Bids:\n";
+        for (const auto& [price, orders] : book.bids_) {
+            std::cout << "Price: $" << price << ", Total Quantity: " << orders.totalQuantity() << "\n";
+        }
+
+        std::cout << "Asks:\n";
+        for (const auto& [price, orders] : book.asks_) {
+            std::cout << "Price: $" << price << ", Total Quantity: " << orders.totalQuantity() << "\n";
+        }
+    }
+}
@@ -0,0 +1,672 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "Usings.h"
+
+// Compile-time building blocks for BasicOrderbook. A policy bundle is a struct with:
+//   Price, Quantity              integer widths
+//   Lock                         BasicLockable guarding the book and the order pool;
+//                                ProfiledLock<L> adds contention counters
+//   Level<OrderPointerT>         FIFO queue of orders at one price, with the
+//                                aggregate unfilled quantity kept up to date and
+//                                a one-pass eraseIf for bulk removal; levels
+//                                with consume() (SoALevel) take the bulk sweep
+//   PriceLevels<Level, Compare>  ordered map of price -> Level
+//   OrderIndex<Locator>          OrderId -> Locator lookup
+//   SymbolCapacity               runtime-sized or compile-time fixed universe
+//
+// Levels and indexes also report memoryBytes() for Orderbook::memoryStats().
+
+// ---- Memory accounting ----
+// Node sizes for the standard containers: payload plus the links the common
+// implementations keep per node (malloc headers not included).
+
+template <typename T>
+constexpr std::size_t listNodeBytes() { return sizeof(T) + 2 * sizeof(void*); }
+
+template <typename Map>
+constexpr std::size_t mapNodeBytes()
+{
+    // Three links plus the colour, padded to a word.
+    return sizeof(typename Map::value_type) + 4 * sizeof(void*);
+}
+
+template <typename Map>
+std::size_t unorderedMapBytes(const Map& map)
+{
+    // Singly linked nodes with a cached hash, plus the bucket array.
+    return map.bucket_count() * sizeof(void*) +
+           map.size() * (sizeof(typename Map::value_type) + sizeof(void*) + sizeof(std::size_t));
+}
+
+// ---- Locking ----
+
+// For single-writer deployments (e.g. a sequencer thread owns the book).
+struct NullLock {
+    void lock() noexcept { }
+    void unlock() noexcept { }
+    bool try_lock() noexcept { return true; }
+};
+
+class SpinLock {
+public:
+    void lock() noexcept
+    {
+        while (flag_.test_and_set(std::memory_order_acquire)) {
+            while (flag_.test(std::memory_order_relaxed)) {
+#if defined(__x86_64__) || defined(__i386__)
+                __builtin_ia32_pause();
+#elif defined(__aarch64__)
+                asm volatile("yield");
+#endif
+            }
+        }
+    }
+
+    bool try_lock() noexcept { return !flag_.test_and_set(std::memory_order_acquire); }
+    void unlock() noexcept { flag_.clear(std::memory_order_release); }
+
+private:
+    std::atomic_flag flag_ = ATOMIC_FLAG_INIT;
+};
+
+struct LockContentionStats {
+    std::uint64_t acquisitions = 0;
+    std::uint64_t contended = 0; // acquisitions that found the lock held
+    std::uint64_t waitNs = 0;    // time spent waiting in those
+
+    LockContentionStats operator-(const LockContentionStats& before) const
+    {
+        return { acquisitions - before.acquisitions, contended - before.contended, waitNs - before.waitNs };
+    }
+};
+
+// Wraps a lock to measure contention: an uncontended lock() costs one extra
+// try_lock, a contended one two clock reads around the blocking lock(). The
+// counters are written only while the lock is held and read relaxed.
+template <typename LockT>
+class ProfiledLock {
+public:
+    void lock()
+    {
+        if (lock_.try_lock()) {
+            bump(acquisitions_, 1);
+            return;
+        }
+        const auto start = std::chrono::steady_clock::now();
+        lock_.lock();
+        const auto waited = std::chrono::steady_clock::now() - start;
+        bump(acquisitions_, 1);
+        bump(contended_, 1);
+        bump(waitNs_, static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(waited).count()));
+    }
+
+    bool try_lock()
+    {
+        if (!lock_.try_lock()) {
+            return false;
+        }
+        bump(acquisitions_, 1);
+        return true;
+    }
+
+    void unlock() { lock_.unlock(); }
+
+    LockContentionStats contention() const
+    {
+        return { acquisitions_.load(std::memory_order_relaxed), contended_.load(std::memory_order_relaxed),
+                 waitNs_.load(std::memory_order_relaxed) };
+    }
+
+private:
+    static void bump(std::atomic<std::uint64_t>& counter, std::uint64_t by)
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + by, std::memory_order_relaxed);
+    }
+
+    LockT lock_;
+    std::atomic<std::uint64_t> acquisitions_{ 0 };
+    std::atomic<std::uint64_t> contended_{ 0 };
+    std::atomic<std::uint64_t> waitNs_{ 0 };
+};
+
+// ---- Price levels ----
+
+// The matcher calls reduce() for every fill against a resting order, so
+// totalQuantity() is the level's unfilled quantity without walking the queue.
+template <typename OrderPointerT>
+class ListLevel {
+public:
+    using Orders = std::list<OrderPointerT>;
+    using Handle = typename Orders::iterator;
+    using Quantity = decltype(std::declval<const OrderPointerT&>()->getUnfilledQuantity());
+
+    Handle push_back(const OrderPointerT& order)
+    {
+        orders_.push_back(order);
+        totalQuantity_ += order->getUnfilledQuantity();
+        return std::prev(orders_.end());
+    }
+
+    void erase(Handle handle)
+    {
+        totalQuantity_ -= (*handle)->getUnfilledQuantity();
+        orders_.erase(handle);
+    }
+
+    const OrderPointerT& front() const { return orders_.front(); }
+
+    // Removes the (filled) front order; its quantity was already taken by reduce().
+    void pop_front()
+    {
+        totalQuantity_ -= orders_.front()->getUnfilledQuantity();
+        orders_.pop_front();
+    }
+
+    void reduce(Quantity filled) { totalQuantity_ -= filled; }
+
+    // Removes every order for which pred returns true, keeping the rest in
+    // time priority. pred sees each order once and may act on it before it goes.
+    template <typename Pred>
+    std::size_t eraseIf(Pred pred)
+    {
+        std::size_t erased = 0;
+        for (auto it = orders_.begin(); it != orders_.end();) {
+            if (pred(*it)) {
+                totalQuantity_ -= (*it)->getUnfilledQuantity();
+                it = orders_.erase(it);
+                ++erased;
+            } else {
+                ++it;
+            }
+        }
+        return erased;
+    }
+    Quantity totalQuantity() const { return totalQuantity_; }
+
+    bool empty() const { return orders_.empty(); }
+    std::size_t size() const { return orders_.size(); }
+    auto begin() const { return orders_.begin(); }
+    auto end() const { return orders_.end(); }
+
+    std::size_t memoryBytes() const { return orders_.size() * listNodeBytes<OrderPointerT>(); }
+
+private:
+    Orders orders_;
+    Quantity totalQuantity_{};
+};
+
+// Structure-of-arrays level: order pointers, unfilled quantities and handles
+// sit in three parallel vectors, so the aggregate and a sweep's fill plan come
+// from one contiguous quantity column instead of chasing list nodes.
+//
+// Handles are per-level sequence numbers, ascending along the queue; erase()
+// finds one by binary search. Removing an order leaves a tombstone (null
+// pointer, zero quantity) that compaction drops once tombstones outnumber the
+// live orders; compaction keeps every sequence number, so handles stay valid.
+//
+// consume() lets an aggressor take quantity from the front in bulk; the
+// engine uses it in place of the front()/reduce()/pop_front() loop.
+template <typename OrderPointerT>
+class SoALevel {
+public:
+    using Handle = std::uint64_t;
+    using Quantity = decltype(std::declval<const OrderPointerT&>()->getUnfilledQuantity());
+    static constexpr bool kBulkConsume = true;
+
+    class Iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = OrderPointerT;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const OrderPointerT*;
+        using reference = const OrderPointerT&;
+
+        Iterator() = default;
+        Iterator(const OrderPointerT* current, const OrderPointerT* end) : current_(current), end_(end) { skip(); }
+
+        reference operator*() const { return *current_; }
+        pointer operator->() const { return current_; }
+        Iterator& operator++()
+        {
+            ++current_;
+            skip();
+            return *this;
+        }
+        Iterator operator++(int)
+        {
+            Iterator previous = *this;
+            ++*this;
+            return previous;
+        }
+        bool operator==(const Iterator& other) const { return current_ == other.current_; }
+
+    private:
+        void skip()
+        {
+            while (current_ != end_ && !*current_) {
+                ++current_;
+            }
+        }
+
+        const OrderPointerT* current_ = nullptr;
+        const OrderPointerT* end_ = nullptr;
+    };
+
+    SoALevel() = default;
+    SoALevel(const SoALevel&) = delete;
+    SoALevel& operator=(const SoALevel&) = delete;
+    SoALevel(SoALevel&& other) noexcept { swap(other); }
+    SoALevel& operator=(SoALevel&& other) noexcept
+    {
+        SoALevel(std::move(other)).swap(*this);
+        return *this;
+    }
+    ~SoALevel() { release(); }
+
+    Handle push_back(const OrderPointerT& order)
+    {
+        if (size_ == capacity_) {
+            grow();
+        }
+        new (orders_ + size_) OrderPointerT(order);
+        quantities_[size_] = order->getUnfilledQuantity();
+        sequences_[size_] = nextSequence_;
+        ++size_;
+        totalQuantity_ += order->getUnfilledQuantity();
+        ++live_;
+        return nextSequence_++;
+    }
+
+    void erase(Handle handle)
+    {
+        const std::size_t index = indexOf(handle);
+        totalQuantity_ -= quantities_[index];
+        bury(index);
+        if (index == head_) {
+            skipTombstones();
+        }
+        compactIfSparse();
+    }
+
+    const OrderPointerT& front() const { return orders_[head_]; }
+
+    // Removes the (filled) front order; its quantity was already taken by reduce().
+    void pop_front()
+    {
+        totalQuantity_ -= quantities_[head_];
+        bury(head_);
+        skipTombstones();
+        compactIfSparse();
+    }
+
+    // Fill of the front order only, as in the engine's matching loop.
+    void reduce(Quantity filled)
+    {
+        quantities_[head_] -= filled;
+        totalQuantity_ -= filled;
+    }
+
+    // Takes up to `wanted` from the front in time priority and returns how much
+    // was taken. onFill(order, quantity) runs once per resting order touched,
+    // before a fully filled one is removed. How many orders are taken whole
+    // comes from a running sum over the quantity column, a block at a time.
+    template <typename OnFill>
+    Quantity consume(Quantity wanted, OnFill&& onFill)
+    {
+        const Quantity* quantities = quantities_;
+        std::size_t end = head_;
+        Quantity remaining = wanted;
+        if constexpr (sizeof(Quantity) <= 4) {
+            // Block sums in 64 bits cannot overflow; tombstones add zero.
+            while (end + kConsumeBlock <= size_) {
+                std::uint64_t block = 0;
+                for (std::size_t i = 0; i < kConsumeBlock; ++i) {
+                    block += quantities[end + i];
+                }
+                if (block > remaining) {
+                    break;
+                }
+                remaining -= static_cast<Quantity>(block);
+                end += kConsumeBlock;
+            }
+        }
+        while (end < size_ && quantities[end] <= remaining) {
+            remaining -= quantities[end];
+            ++end;
+        }
+
+        for (std::size_t index = head_; index < end; ++index) {
+            if (orders_[index]) {
+                onFill(orders_[index], quantities_[index]);
+                bury(index);
+            }
+        }
+        if (remaining > 0 && end < size_) {
+            onFill(orders_[end], remaining);
+            quantities_[end] -= remaining;
+            remaining = 0;
+        }
+        const Quantity taken = wanted - remaining;
+        totalQuantity_ -= taken;
+        head_ = end;
+        skipTombstones();
+        compactIfSparse();
+        return taken;
+    }
+
+    // Removes every order for which pred returns true, keeping the rest in
+    // time priority. pred sees each order once and may act on it before it goes.
+    template <typename Pred>
+    std::size_t eraseIf(Pred pred)
+    {
+        std::size_t erased = 0;
+        for (std::size_t index = head_; index < size_; ++index) {
+            if (orders_[index] && pred(orders_[index])) {
+                totalQuantity_ -= quantities_[index];
+                bury(index);
+                ++erased;
+            }
+        }
+        if (erased > 0) {
+            compact();
+        }
+        return erased;
+    }
+
+    Quantity totalQuantity() const { return totalQuantity_; }
+
+    bool empty() const { return live_ == 0; }
+    std::size_t size() const { return live_; }
+    Iterator begin() const { return Iterator(orders_ + head_, orders_ + size_); }
+    Iterator end() const { return Iterator(orders_ + size_, orders_ + size_); }
+
+    std::size_t memoryBytes() const { return capacity_ * kEntryBytes; }
+
+private:
+    static constexpr std::size_t kConsumeBlock = 16;
+    static constexpr std::size_t kMinCompaction = 32;
+    static constexpr std::size_t kInitialCapacity = 4;
+    static constexpr std::size_t kEntryBytes = sizeof(OrderPointerT) + sizeof(Handle) + sizeof(Quantity);
+
+    // One allocation per level: the pointer column, then handles, then quantities.
+    void grow()
+    {
+        const std::size_t capacity = capacity_ == 0 ? kInitialCapacity : capacity_ * 2;
+        auto* block = static_cast<std::byte*>(::operator new(capacity * kEntryBytes));
+        auto* orders = reinterpret_cast<OrderPointerT*>(block);
+        auto* sequences = reinterpret_cast<Handle*>(block + capacity * sizeof(OrderPointerT));
+        auto* quantities = reinterpret_cast<Quantity*>(block + capacity * (sizeof(OrderPointerT) + sizeof(Handle)));
+
+        // Only the live tail moves; the consumed prefix is dropped here.
+        std::size_t kept = 0;
+        for (std::size_t index = head_; index < size_; ++index) {
+            new (orders + kept) OrderPointerT(std::move(orders_[index]));
+            sequences[kept] = sequences_[index];
+            quantities[kept] = quantities_[index];
+            ++kept;
+        }
+        release();
+        orders_ = orders;
+        sequences_ = sequences;
+        quantities_ = quantities;
+        capacity_ = capacity;
+        size_ = kept;
+        head_ = 0;
+    }
+
+    void release()
+    {
+        if (orders_ == nullptr) {
+            return;
+        }
+        std::destroy(orders_, orders_ + size_);
+        ::operator delete(static_cast<void*>(orders_));
+        orders_ = nullptr;
+        sequences_ = nullptr;
+        quantities_ = nullptr;
+        capacity_ = 0;
+        size_ = 0;
+    }
+
+    void swap(SoALevel& other) noexcept
+    {
+        std::swap(orders_, other.orders_);
+        std::swap(sequences_, other.sequences_);
+        std::swap(quantities_, other.quantities_);
+        std::swap(capacity_, other.capacity_);
+        std::swap(size_, other.size_);
+        std::swap(head_, other.head_);
+        std::swap(live_, other.live_);
+        std::swap(nextSequence_, other.nextSequence_);
+        std::swap(totalQuantity_, other.totalQuantity_);
+    }
+
+    std::size_t indexOf(Handle handle) const
+    {
+        return static_cast<std::size_t>(std::lower_bound(sequences_ + head_, sequences_ + size_, handle) - sequences_);
+    }
+
+    void bury(std::size_t index)
+    {
+        orders_[index] = OrderPointerT{};
+        quantities_[index] = 0;
+        --live_;
+    }
+
+    void skipTombstones()
+    {
+        while (head_ < size_ && !orders_[head_]) {
+            ++head_;
+        }
+    }
+
+    void compactIfSparse()
+    {
+        const std::size_t dead = size_ - live_;
+        if (live_ == 0 ? size_ > 0 : (dead >= kMinCompaction && dead > live_)) {
+            compact();
+        }
+    }
+
+    // Slides live entries down over the tombstones, keeping their handles.
+    void compact()
+    {
+        std::size_t kept = 0;
+        for (std::size_t index = head_; index < size_; ++index) {
+            if (orders_[index]) {
+                if (kept != index) {
+                    orders_[kept] = std::move(orders_[index]);
+                    sequences_[kept] = sequences_[index];
+                    quantities_[kept] = quantities_[index];
+                }
+                ++kept;
+            }
+        }
+        std::destroy(orders_ + kept, orders_ + size_);
+        size_ = kept;
+        head_ = 0;
+    }
+
+    OrderPointerT* orders_ = nullptr;
+    Handle* sequences_ = nullptr;
+    Quantity* quantities_ = nullptr;
+    std::size_t capacity_ = 0;
+    std::size_t size_ = 0; // entries in use, tombstones included
+    std::size_t head_ = 0; // first live entry, or size_ when empty
+    std::size_t live_ = 0;
+    Handle nextSequence_ = 0;
+    Quantity totalQuantity_{};
+};
+
+template <typename PriceT, typename LevelT, typename CompareT>
+using MapPriceLevels = std::map<PriceT, LevelT, CompareT>;
+
+// ---- Order index ----
+// Locator must be default-constructible and expose isActive().
+
+// Dense vector for ids below directCapacity, hash map for the rest.
+template <typename Locator>
+class DirectOrderIndex {
+public:
+    explicit DirectOrderIndex(std::size_t directCapacity)
+        : direct_(directCapacity + 1)
+    {
+        overflow_.reserve(4096);
+    }
+
+    bool contains(OrderId orderId) const { return find(orderId) != nullptr; }
+
+    Locator* find(OrderId orderId)
+    {
+        return const_cast<Locator*>(std::as_const(*this).find(orderId));
+    }
+
+    const Locator* find(OrderId orderId) const
+    {
+        if (orderId < direct_.size()) {
+            const auto& locator = direct_[orderId];
+            return locator.isActive() ? &locator : nullptr;
+        }
+        auto it = overflow_.find(orderId);
+        return it == overflow_.end() ? nullptr : &it->second;
+    }
+
+    void upsert(OrderId orderId, Locator locator)
+    {
+        if (orderId < direct_.size()) {
+            direct_[orderId] = std::move(locator);
+            return;
+        }
+        overflow_.insert_or_assign(orderId, std::move(locator));
+    }
+
+    void erase(OrderId orderId)
+    {
+        if (orderId < direct_.size()) {
+            direct_[orderId] = Locator{};
+            return;
+        }
+        overflow_.erase(orderId);
+    }
+
+    std::size_t overflowSize() const { return overflow_.size(); }
+    std::size_t memoryBytes() const { return direct_.capacity() * sizeof(Locator) + unorderedMapBytes(overflow_); }
+
+private:
+    std::vector<Locator> direct_;
+    std::unordered_map<OrderId, Locator> overflow_;
+};
+
+// Plain hash map: no up-front memory, for sparse or non-sequential order ids.
+template <typename Locator>
+class HashOrderIndex {
+public:
+    explicit HashOrderIndex(std::size_t expectedOrders)
+    {
+        orders_.reserve(expectedOrders);
+    }
+
+    bool contains(OrderId orderId) const { return orders_.find(orderId) != orders_.end(); }
+
+    Locator* find(OrderId orderId)
+    {
+        auto it = orders_.find(orderId);
+        return it == orders_.end() ? nullptr : &it->second;
+    }
+
+    const Locator* find(OrderId orderId) const
+    {
+        auto it = orders_.find(orderId);
+        return it == orders_.end() ? nullptr : &it->second;
+    }
+
+    void upsert(OrderId orderId, Locator locator) { orders_.insert_or_assign(orderId, std::move(locator)); }
+    void erase(OrderId orderId) { orders_.erase(orderId); }
+
+    std::size_t overflowSize() const { return orders_.size(); }
+    std::size_t memoryBytes() const { return unorderedMapBytes(orders_); }
+
+private:
+    std::unordered_map<OrderId, Locator> orders_;
+};
+
+// ---- Symbol capacity ----
+
+// Universe sized at construction (see Orderbook(SymbolTable, SymbolId)).
+struct DynamicSymbolCapacity {
+    static constexpr bool kFixed = false;
+    static constexpr SymbolId kCapacity = 0;
+};
+
+// Universe fixed at compile time; the bounds check folds to a constant compare.
+template <SymbolId N>
+struct FixedSymbolCapacity {
+    static_assert(N > 0 && N < kInvalidSymbolId, "Invalid fixed symbol capacity");
+    static constexpr bool kFixed = true;
+    static constexpr SymbolId kCapacity = N;
+};
+
+// ---- Policy bundles ----
+
+struct DefaultOrderbookPolicies {
+    using Price = std::uint32_t;
+    using Quantity = std::uint32_t;
+    using Lock = std::mutex;
+    template <typename OrderPointerT>
+    using Level = ListLevel<OrderPointerT>;
+    template <typename PriceT, typename LevelT, typename CompareT>
+    using PriceLevels = MapPriceLevels<PriceT, LevelT, CompareT>;
+    template <typename Locator>
+    using OrderIndex = DirectOrderIndex<Locator>;
+    using SymbolCapacity = DynamicSymbolCapacity;
+};
+
+// One thread owns the book: no locking anywhere on the path.
+struct SingleThreadedOrderbookPolicies : DefaultOrderbookPolicies {
+    using Lock = NullLock;
+};
+
+struct SpinLockOrderbookPolicies : DefaultOrderbookPolicies {
+    using Lock = SpinLock;
+};
+
+struct HashIndexOrderbookPolicies : DefaultOrderbookPolicies {
+    template <typename Locator>
+    using OrderIndex = HashOrderIndex<Locator>;
+};
+
+// Contiguous per-level arrays and bulk sweeps in place of std::list queues.
+struct SoALevelOrderbookPolicies : DefaultOrderbookPolicies {
+    template <typename OrderPointerT>
+    using Level = SoALevel<OrderPointerT>;
+};
+
+// Same engines with lock contention counters, see BasicOrderbook::lockContention().
+struct ProfiledMutexOrderbookPolicies : DefaultOrderbookPolicies {
+    using Lock = ProfiledLock<std::mutex>;
+};
+
+struct ProfiledSpinLockOrderbookPolicies : DefaultOrderbookPolicies {
+    using Lock = ProfiledLock<SpinLock>;
+};
+
+// 64-bit prices and quantities for instruments that overflow cents in 32 bits.
+struct WideOrderbookPolicies : DefaultOrderbookPolicies {
+    using Price = std::uint64_t;
+    using Quantity = std::uint64_t;
+};
@@ -0,0 +1,234 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+#include "Side.h"
+#include "Usings.h"
+
+// Pre-trade limits of one account. Zero disables a limit.
+struct RiskLimits {
+    std::uint64_t maxOrderQuantity = 0;
+    std::uint64_t maxOrderNotional = 0; // price * quantity, in price units
+    std::uint32_t priceBandBps = 0;     // max distance from the reference price, in basis points
+    std::uint32_t maxOpenOrders = 0;    // resting orders plus pending stops, across symbols
+    // Per symbol, on the position the account would hold if every open order
+    // on the order's side filled: position + open buys + qty for a buy,
+    // open sells + qty - position for a sell.
+    std::uint64_t maxNetPosition = 0;
+};
+
+struct RiskConfig {
+    AccountId accountCount = 256; // tag 1 accounts 0..accountCount-1; others are rejected
+    RiskLimits defaultLimits;
+};
+
+// Why an order was refused; the order never reached the book.
+enum class RiskReject : std::uint8_t
+{
+    None,
+    UnknownAccount,
+    OrderQuantity,
+    OrderNotional,
+    PriceBand,
+    OpenOrders,
+    NetPosition,
+};
+
+constexpr std::string_view riskRejectName(RiskReject reject)
+{
+    switch (reject) {
+    case RiskReject::None: return "NONE";
+    case RiskReject::UnknownAccount: return "UNKNOWN_ACCOUNT";
+    case RiskReject::OrderQuantity: return "ORDER_QTY";
+    case RiskReject::OrderNotional: return "ORDER_NOTIONAL";
+    case RiskReject::PriceBand: return "PRICE_BAND";
+    case RiskReject::OpenOrders: return "OPEN_ORDERS";
+    case RiskReject::NetPosition: return "NET_POSITION";
+    }
+    return "UNKNOWN";
+}
+
+// What one account holds and has working in one symbol.
+struct RiskExposure {
+    std::int64_t position = 0; // filled buys minus filled sells
+    std::uint64_t openBuyQuantity = 0;
+    std::uint64_t openSellQuantity = 0;
+};
+
+// Per-account limit state in flat arrays indexed by AccountId, so a check is a
+// handful of loads and compares with no lookups or allocation. Exposures are one
+// array of accounts per symbol, allocated with the symbol's first order, so a
+// wide universe costs a pointer per idle symbol rather than accounts x symbols.
+// Not synchronised: the Orderbook calls it under its book lock, from accept,
+// fill and removal of every order.
+template <typename Price, typename Quantity>
+class BasicRiskChecks
+{
+public:
+    BasicRiskChecks(SymbolId symbolCount, RiskConfig config)
+        : symbolCount_(symbolCount)
+        , accounts_(config.accountCount, AccountState{config.defaultLimits, 0})
+        , exposures_(symbolCount)
+    {
+        if (config.accountCount == 0) {
+            throw std::invalid_argument("Risk checks need at least one account");
+        }
+    }
+
+    // referencePrice 0 (no trade and an empty book) skips the price band. A
+    // nonzero `notional` replaces price * quantity, for orders that trade across
+    // several prices (a market order's sweep).
+    RiskReject check(AccountId account, SymbolId symbolId, Side side, Price price, Quantity quantity,
+                     Price referencePrice, std::uint64_t notional = 0) const
+    {
+        if (account >= accounts_.size()) {
+            return RiskReject::UnknownAccount;
+        }
+        const AccountState& state = accounts_[account];
+        const RiskLimits& limits = state.limits_;
+        const std::uint64_t qty = quantity;
+
+        if (limits.maxOrderQuantity != 0 && qty > limits.maxOrderQuantity) {
+            return RiskReject::OrderQuantity;
+        }
+        if (limits.maxOrderNotional != 0 &&
+            (notional != 0 ? notional > limits.maxOrderNotional : exceedsNotional(price, qty, limits.maxOrderNotional))) {
+            return RiskReject::OrderNotional;
+        }
+        if (limits.priceBandBps != 0 && referencePrice != 0) {
+            const std::uint64_t distance = price > referencePrice ? price - referencePrice : referencePrice - price;
+            if (distance * 10'000 > static_cast<std::uint64_t>(referencePrice) * limits.priceBandBps) {
+                return RiskReject::PriceBand;
+            }
+        }
+        if (limits.maxOpenOrders != 0 && state.openOrders_ >= limits.maxOpenOrders) {
+            return RiskReject::OpenOrders;
+        }
+        if (limits.maxNetPosition != 0) {
+            const RiskExposure& exposure = exposureAt(account, symbolId);
+            const std::int64_t worst = side == Side::BUY
+                ? exposure.position + static_cast<std::int64_t>(exposure.openBuyQuantity + qty)
+                : static_cast<std::int64_t>(exposure.openSellQuantity + qty) - exposure.position;
+            if (worst > static_cast<std::int64_t>(limits.maxNetPosition)) {
+                return RiskReject::NetPosition;
+            }
+        }
+        return RiskReject::None;
+    }
+
+    // Lifecycle of an accepted order: accepted once with its full quantity,
+    // filled in pieces, released once with whatever was left unfilled.
+    void onAccepted(AccountId account, SymbolId symbolId, Side side, Quantity quantity)
+    {
+        if (account >= accounts_.size()) {
+            return;
+        }
+        ++accounts_[account].openOrders_;
+        openQuantity(exposureAt(account, symbolId), side) += quantity;
+    }
+
+    void onFilled(AccountId account, SymbolId symbolId, Side side, Quantity quantity)
+    {
+        if (account >= accounts_.size()) {
+            return;
+        }
+        RiskExposure& exposure = exposureAt(account, symbolId);
+        openQuantity(exposure, side) -= quantity;
+        exposure.position += side == Side::BUY ? static_cast<std::int64_t>(quantity)
+                                               : -static_cast<std::int64_t>(quantity);
+    }
+
+    void onReleased(AccountId account, SymbolId symbolId, Side side, Quantity unfilled)
+    {
+        if (account >= accounts_.size()) {
+            return;
+        }
+        --accounts_[account].openOrders_;
+        openQuantity(exposureAt(account, symbolId), side) -= unfilled;
+    }
+
+    void setLimits(AccountId account, const RiskLimits& limits) { accountAt(account).limits_ = limits; }
+    const RiskLimits& limits(AccountId account) const { return accountAt(account).limits_; }
+    std::uint32_t openOrders(AccountId account) const { return accountAt(account).openOrders_; }
+
+    const RiskExposure& exposure(AccountId account, SymbolId symbolId) const
+    {
+        accountAt(account);
+        if (symbolId >= symbolCount_) {
+            throw std::out_of_range("Unknown symbol");
+        }
+        return exposureAt(account, symbolId);
+    }
+
+    AccountId accountCount() const { return static_cast<AccountId>(accounts_.size()); }
+
+    std::size_t memoryBytes() const
+    {
+        std::size_t bytes = accounts_.capacity() * sizeof(AccountState) + exposures_.capacity() * sizeof(exposures_[0]);
+        for (const auto& symbol : exposures_) {
+            bytes += symbol ? accounts_.size() * sizeof(RiskExposure) : 0;
+        }
+        return bytes;
+    }
+
+private:
+    struct AccountState {
+        RiskLimits limits_;
+        std::uint32_t openOrders_;
+    };
+
+    // 32-bit price times 32-bit quantity fits in 64 bits; wider types divide
+    // instead so the product cannot overflow.
+    static bool exceedsNotional(Price price, std::uint64_t qty, std::uint64_t limit)
+    {
+        if constexpr (sizeof(Price) + sizeof(Quantity) <= sizeof(std::uint64_t)) {
+            return static_cast<std::uint64_t>(price) * qty > limit;
+        } else {
+            return price != 0 && qty > limit / static_cast<std::uint64_t>(price);
+        }
+    }
+
+    static std::uint64_t& openQuantity(RiskExposure& exposure, Side side)
+    {
+        return side == Side::BUY ? exposure.openBuyQuantity : exposure.openSellQuantity;
+    }
+
+    RiskExposure& exposureAt(AccountId account, SymbolId symbolId)
+    {
+        auto& symbol = exposures_[symbolId];
+        if (!symbol) {
+            symbol = std::make_unique<RiskExposure[]>(accounts_.size());
+        }
+        return symbol[account];
+    }
+    const RiskExposure& exposureAt(AccountId account, SymbolId symbolId) const
+    {
+        static const RiskExposure kNoExposure{};
+        const auto& symbol = exposures_[symbolId];
+        return symbol ? symbol[account] : kNoExposure;
+    }
+
+    AccountState& accountAt(AccountId account)
+    {
+        if (account >= accounts_.size()) {
+            throw std::out_of_range("Unknown account");
+        }
+        return accounts_[account];
+    }
+    const AccountState& accountAt(AccountId account) const
+    {
+        if (account >= accounts_.size()) {
+            throw std::out_of_range("Unknown account");
+        }
+        return accounts_[account];
+    }
+
+    SymbolId symbolCount_;
+    std::vector<AccountState> accounts_;
+    std::vector<std::unique_ptr<RiskExposure[]>> exposures_; // [symbolId][account], null until used
+};
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+inline constexpr std::size_t kCacheLineSize = 64;
+
+// Single-writer sequence lock over a small trivially copyable value.
+//
+// The writer bumps the sequence to odd, stores the payload, then bumps it to
+// even; it never waits for readers. Readers copy the payload and retry if the
+// sequence was odd or moved underneath them, so they never block the writer or
+// each other. The payload is stored as relaxed atomic words, which keeps torn
+// reads detectable without a data race. One slot per cache line, so readers of
+// one symbol do not false-share with writers of its neighbours.
+template <typename T>
+class alignas(kCacheLineSize) SeqLock {
+    static_assert(std::is_trivially_copyable_v<T>, "SeqLock payload must be trivially copyable");
+
+    static constexpr std::size_t kWords = (sizeof(T) + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t);
+
+public:
+    SeqLock() { store(T{}); }
+
+    // Writer side. Callers serialise writes (the Orderbook does it under its lock).
+    void store(const T& value) noexcept
+    {
+        std::array<std::uint64_t, kWords> words{};
+        std::memcpy(words.data(), &value, sizeof(T));
+
+        const std::uint64_t sequence = sequence_.load(std::memory_order_relaxed);
+        sequence_.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (std::size_t i = 0; i < kWords; ++i) {
+            words_[i].store(words[i], std::memory_order_relaxed);
+        }
+        sequence_.store(sequence + 2, std::memory_order_release);
+    }
+
+    // The writer's own view; no retry needed since only it modifies the slot.
+    T peekFromWriter() const noexcept
+    {
+        std::array<std::uint64_t, kWords> words{};
+        for (std::size_t i = 0; i < kWords; ++i) {
+            words[i] = words_[i].load(std::memory_order_relaxed);
+        }
+        T value{};
+        std::memcpy(static_cast<void*>(&value), words.data(), sizeof(T));
+        return value;
+    }
+
+    // Reader side: lock-free, safe from any number of threads.
+    T load() const noexcept
+    {
+        std::array<std::uint64_t, kWords> words{};
+        while (true) {
+            const std::uint64_t before = sequence_.load(std::memory_order_acquire);
+            if (before & 1) {
+                continue;
+            }
+            for (std::size_t i = 0; i < kWords; ++i) {
+                words[i] = words_[i].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (sequence_.load(std::memory_order_relaxed) == before) {
+                break;
+            }
+        }
+        T value{};
+        std::memcpy(static_cast<void*>(&value), words.data(), sizeof(T));
+        return value;
+    }
+
+    // Even and increasing; changes by 2 per store. A store in progress reads as
+    // the version before it, so a poller sees the change once the store is done.
+    std::uint64_t version() const noexcept
+    {
+        return sequence_.load(std::memory_order_acquire) & ~std::uint64_t{1};
+    }
+
+private:
+    std::atomic<std::uint64_t> sequence_{0};
+    std::array<std::atomic<std::uint64_t>, kWords> words_{};
+};
@@ -0,0 +1,151 @@
+#include "SymbolTable.h"
+
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+
+namespace {
+
+constexpr std::size_t kMinSlotCount = 8;
+constexpr std::size_t kBucketSize = 4;                 // average tickers per bucket
+constexpr std::uint32_t kMaxSeedsPerBucket = 1u << 16; // then the whole table is re-salted
+
+std::uint64_t splitMix64(std::uint64_t& state)
+{
+    std::uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+std::string_view trim(std::string_view text)
+{
+    while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) {
+        text.remove_prefix(1);
+    }
+    while (!text.empty() && (text.back() == ' ' || text.back() == '\t' || text.back() == '\r')) {
+        text.remove_suffix(1);
+    }
+    return text;
+}
+
+} // namespace
+
+SymbolTable::SymbolTable(const std::vector<std::string>& tickers)
+    : tickers_(tickers)
+{
+    if (tickers_.empty()) {
+        return;
+    }
+    if (tickers_.size() >= static_cast<std::size_t>(kInvalidSymbolId)) {
+        throw std::invalid_argument("Too many symbols for SymbolId range");
+    }
+
+    std::vector<PackedTicker> keys;
+    keys.reserve(tickers_.size());
+    for (const auto& ticker : tickers_) {
+        if (ticker.empty() || ticker.size() > kMaxTickerLength) {
+            throw std::invalid_argument("Invalid ticker: '" + ticker + "'");
+        }
+        keys.push_back(pack(ticker));
+    }
+
+    // Checked up front: two equal keys share every hash and could never be placed.
+    std::vector<std::uint32_t> sorted(keys.size());
+    for (std::uint32_t i = 0; i < sorted.size(); ++i) {
+        sorted[i] = i;
+    }
+    const auto less = [&](std::uint32_t a, std::uint32_t b) {
+        return keys[a].lo != keys[b].lo ? keys[a].lo < keys[b].lo : keys[a].hi < keys[b].hi;
+    };
+    std::sort(sorted.begin(), sorted.end(), less);
+    for (std::size_t i = 1; i < sorted.size(); ++i) {
+        if (!less(sorted[i - 1], sorted[i])) {
+            throw std::invalid_argument("Duplicate ticker: '" + tickers_[sorted[i]] + "'");
+        }
+    }
+
+    std::size_t slotCount = std::max(kMinSlotCount, tickers_.size() + tickers_.size() / 10);
+    std::uint64_t seedState = 0x5EED5EED5EED5EEDULL;
+    while (true) {
+        salt_ = splitMix64(seedState);
+        seeds_.assign((tickers_.size() + kBucketSize - 1) / kBucketSize, 0);
+        slots_.assign(slotCount, Slot{});
+        if (tryPlace(keys)) {
+            return;
+        }
+        // Only a pathological salt gets here (two tickers with the same 64-bit
+        // hash, or a bucket no seed can place); a little more room helps too.
+        slotCount += slotCount / 16 + 1;
+    }
+}
+
+bool SymbolTable::tryPlace(const std::vector<PackedTicker>& keys)
+{
+    std::vector<std::vector<std::uint32_t>> buckets(seeds_.size());
+    std::vector<std::uint64_t> hashes(keys.size());
+    for (std::size_t i = 0; i < keys.size(); ++i) {
+        hashes[i] = hashKey(keys[i], salt_);
+        buckets[bucketIndex(hashes[i])].push_back(static_cast<std::uint32_t>(i));
+    }
+    // Largest buckets first, while most slots are still free.
+    std::vector<std::uint32_t> order(buckets.size());
+    for (std::uint32_t b = 0; b < order.size(); ++b) {
+        order[b] = b;
+    }
+    std::stable_sort(order.begin(), order.end(), [&](std::uint32_t a, std::uint32_t b) {
+        return buckets[a].size() > buckets[b].size();
+    });
+
+    std::vector<std::size_t> placed;
+    for (const std::uint32_t bucket : order) {
+        const auto& members = buckets[bucket];
+        if (members.empty()) {
+            break;
+        }
+        bool done = false;
+        for (std::uint32_t seed = 0; seed < kMaxSeedsPerBucket && !done; ++seed) {
+            seeds_[bucket] = seed;
+            placed.clear();
+            done = true;
+            for (const std::uint32_t i : members) {
+                const std::size_t index = slotIndex(hashes[i]);
+                if (slots_[index].symbolId != kInvalidSymbolId) {
+                    done = false;
+                    break;
+                }
+                slots_[index].symbolId = static_cast<SymbolId>(i);
+                slots_[index].key = keys[i];
+                placed.push_back(index);
+            }
+            if (!done) {
+                for (const std::size_t index : placed) {
+                    slots_[index] = Slot{};
+                }
+            }
+        }
+        if (!done) {
+            return false;
+        }
+    }
+    return true;
+}
+
+SymbolTable SymbolTable::loadFromFile(const std::string& path)
+{
+    std::ifstream in(path);
+    if (!in) {
+        throw std::runtime_error("Cannot open symbol file: " + path);
+    }
+
+    std::vector<std::string> tickers;
+    std::string line;
+    while (std::getline(in, line)) {
+        const std::string_view ticker = trim(line);
+        if (ticker.empty() || ticker.front() == '#') {
+            continue;
+        }
+        tickers.emplace_back(ticker);
+    }
+    return SymbolTable(tickers);
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Usings.h"
+
+// Resolves FIX tag 55 tickers (e.g. "NVDA") to dense SymbolIds.
+//
+// The table is built once at startup. Tickers are packed into a 16-byte key and
+// placed with a two-level perfect hash (hash and displace): the key's hash picks
+// a bucket, and the bucket's seed picks the slot. Space is about 1.1 slots per
+// ticker plus one 4-byte seed per four tickers, and building takes milliseconds
+// for tens of thousands of tickers. Every lookup is two hash
+// mixes, two loads and one 16-byte compare; hits and misses cost the same and
+// nothing allocates.
+class SymbolTable
+{
+public:
+    static constexpr std::size_t kMaxTickerLength = 16;
+
+    SymbolTable() = default;
+
+    // SymbolIds are assigned densely in the given order (tickers[i] -> i).
+    explicit SymbolTable(const std::vector<std::string>& tickers);
+
+    // One ticker per line; blank lines and lines starting with '#' are skipped.
+    static SymbolTable loadFromFile(const std::string& path);
+
+    SymbolId resolve(std::string_view ticker) const
+    {
+        if (ticker.empty() || ticker.size() > kMaxTickerLength || slots_.empty()) {
+            return kInvalidSymbolId;
+        }
+
+        const PackedTicker key = pack(ticker);
+        const Slot& slot = slots_[slotIndex(hashKey(key, salt_))];
+        if (slot.key.lo != key.lo || slot.key.hi != key.hi) {
+            return kInvalidSymbolId;
+        }
+        return slot.symbolId;
+    }
+
+    std::size_t size() const { return tickers_.size(); }
+    bool empty() const { return tickers_.empty(); }
+    const std::string& ticker(SymbolId symbolId) const { return tickers_.at(symbolId); }
+    // Lookup structures only (slots and seeds), not the ticker strings.
+    std::size_t memoryBytes() const { return slots_.size() * sizeof(Slot) + seeds_.size() * sizeof(std::uint32_t); }
+
+private:
+    struct PackedTicker {
+        std::uint64_t lo = 0;
+        std::uint64_t hi = 0;
+    };
+
+    struct Slot {
+        PackedTicker key;
+        SymbolId symbolId = kInvalidSymbolId;
+    };
+
+    static PackedTicker pack(std::string_view ticker)
+    {
+        char bytes[kMaxTickerLength] = {};
+        std::memcpy(bytes, ticker.data(), ticker.size());
+
+        PackedTicker key;
+        std::memcpy(&key.lo, bytes, sizeof(key.lo));
+        std::memcpy(&key.hi, bytes + sizeof(key.lo), sizeof(key.hi));
+        return key;
+    }
+
+    static std::uint64_t mix(std::uint64_t x)
+    {
+        x ^= x >> 32;
+        x *= 0xD6E8FEB86659FD93ULL;
+        x ^= x >> 32;
+        x *= 0xD6E8FEB86659FD93ULL;
+        return x ^ (x >> 32);
+    }
+
+    static std::uint64_t hashKey(const PackedTicker& key, std::uint64_t salt)
+    {
+        return mix(key.lo ^ salt ^ mix(key.hi + salt));
+    }
+
+    // Maps a 64-bit hash onto [0, n) without a division.
+    static std::size_t reduce(std::uint64_t hash, std::size_t n)
+    {
+        return static_cast<std::size_t>((static_cast<unsigned __int128>(hash) * n) >> 64);
+    }
+
+    std::size_t bucketIndex(std::uint64_t hash) const { return reduce(hash, seeds_.size()); }
+
+    std::size_t slotIndex(std::uint64_t hash) const
+    {
+        return reduce(mix(hash + seeds_[bucketIndex(hash)] * 0x9E3779B97F4A7C15ULL), slots_.size());
+    }
+
+    bool tryPlace(const std::vector<PackedTicker>& keys);
+
+    std::vector<Slot> slots_;
+    std::vector<std::uint32_t> seeds_; // displacement per bucket
+    std::vector<std::string> tickers_;
+    std::uint64_t salt_ = 0;
+};
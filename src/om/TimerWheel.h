@@ -0,0 +1,274 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+// Intrusive links for one TimerWheel entry. Lives inside the timed object, so
+// scheduling and cancelling never allocate.
+template <typename T>
+struct TimerHook {
+    T* prev = nullptr;
+    T* next = nullptr;
+    std::uint64_t deadline = 0;
+    std::uint32_t bucket = std::numeric_limits<std::uint32_t>::max(); // unscheduled
+};
+
+// Hierarchical timing wheel over millisecond ticks: four levels of 256 slots
+// cover 2^32 ms (~49 days) ahead, anything later parks in an overflow list.
+// schedule() and cancel() are O(1) list splices. advance() jumps straight to
+// the next occupied slot via per-level occupancy bitmaps, so idle stretches
+// cost nothing; entries cascade one level down as their window comes up and
+// fire from level 0 on their exact deadline.
+//
+// `Hook` names the TimerHook member of T, e.g. TimerWheel<Order, &Order::expiryTimer_>.
+// Not thread-safe; the owner serialises access.
+template <typename T, TimerHook<T> T::*Hook>
+class TimerWheel {
+public:
+    static constexpr unsigned kLevels = 4;
+    static constexpr unsigned kSlotBits = 8;
+    static constexpr std::uint32_t kSlots = 1u << kSlotBits;
+
+    // Seed `now` from the clock that will drive advance(): deadlines are placed
+    // relative to it, so a wheel left at 0 and fed epoch milliseconds would park
+    // everything in overflow and cascade through every top-level window on the
+    // first advance.
+    explicit TimerWheel(std::uint64_t now = 0) : now_(now) { }
+
+    TimerWheel(const TimerWheel&) = delete;
+    TimerWheel& operator=(const TimerWheel&) = delete;
+
+    // (Re)schedules item to fire at deadline. A deadline at or before now()
+    // fires on the next advance().
+    void schedule(T& item, std::uint64_t deadline)
+    {
+        cancel(item);
+        (item.*Hook).deadline = deadline;
+        place(item);
+        ++size_;
+    }
+
+    // No-op for items that are not scheduled.
+    void cancel(T& item)
+    {
+        if (!isScheduled(item)) {
+            return;
+        }
+        unlink(item);
+        --size_;
+    }
+
+    static bool isScheduled(const T& item) { return (item.*Hook).bucket != kUnscheduled; }
+
+    // Moves the wheel to `now` and calls onExpire(T&) for every item whose
+    // deadline is <= now. Items are unscheduled before their callback runs, so
+    // the callback may cancel or destroy them. Returns how many fired. An empty
+    // wheel has nothing placed relative to now(), so it jumps (either way) to `now`.
+    template <typename OnExpire>
+    std::size_t advance(std::uint64_t now, OnExpire&& onExpire)
+    {
+        if (empty()) {
+            now_ = now;
+            return 0;
+        }
+        std::size_t fired = fireDue(now, onExpire);
+        while (now_ < now) {
+            const std::uint64_t next = nextEventTick();
+            if (next > now) {
+                break;
+            }
+            now_ = next;
+            cascadeAt(now_);
+            fired += fireSlot(now_ & (kSlots - 1), onExpire);
+            fired += fireDue(now, onExpire);
+        }
+        if (now_ < now) {
+            now_ = now;
+        }
+        return fired;
+    }
+
+    std::uint64_t now() const { return now_; }
+    std::size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+private:
+    static constexpr std::uint32_t kUnscheduled = std::numeric_limits<std::uint32_t>::max();
+    static constexpr std::uint32_t kDueBucket = kLevels * kSlots;
+    static constexpr std::uint32_t kOverflowBucket = kDueBucket + 1;
+    static constexpr std::uint32_t kBucketCount = kOverflowBucket + 1;
+    static constexpr std::uint64_t kNoEvent = std::numeric_limits<std::uint64_t>::max();
+
+    using Bitmap = std::array<std::uint64_t, kSlots / 64>;
+
+    static constexpr std::uint64_t levelSpan(unsigned level) { return std::uint64_t{1} << (kSlotBits * level); }
+
+    void place(T& item)
+    {
+        const std::uint64_t deadline = (item.*Hook).deadline;
+        if (deadline <= now_) {
+            push(item, kDueBucket);
+            return;
+        }
+        const std::uint64_t delta = deadline - now_;
+        for (unsigned level = 0; level < kLevels; ++level) {
+            if (delta < levelSpan(level + 1)) {
+                const auto slot = static_cast<std::uint32_t>((deadline >> (kSlotBits * level)) & (kSlots - 1));
+                push(item, level * kSlots + slot);
+                return;
+            }
+        }
+        push(item, kOverflowBucket);
+    }
+
+    void push(T& item, std::uint32_t bucket)
+    {
+        auto& hook = item.*Hook;
+        hook.bucket = bucket;
+        hook.prev = nullptr;
+        hook.next = heads_[bucket];
+        if (hook.next != nullptr) {
+            (hook.next->*Hook).prev = &item;
+        }
+        heads_[bucket] = &item;
+        if (bucket < kDueBucket) {
+            occupancy_[bucket / kSlots][(bucket % kSlots) / 64] |= std::uint64_t{1} << (bucket % 64);
+        }
+    }
+
+    void unlink(T& item)
+    {
+        auto& hook = item.*Hook;
+        if (hook.prev != nullptr) {
+            (hook.prev->*Hook).next = hook.next;
+        } else {
+            heads_[hook.bucket] = hook.next;
+        }
+        if (hook.next != nullptr) {
+            (hook.next->*Hook).prev = hook.prev;
+        }
+        if (hook.bucket < kDueBucket && heads_[hook.bucket] == nullptr) {
+            occupancy_[hook.bucket / kSlots][(hook.bucket % kSlots) / 64] &= ~(std::uint64_t{1} << (hook.bucket % 64));
+        }
+        hook.prev = nullptr;
+        hook.next = nullptr;
+        hook.bucket = kUnscheduled;
+    }
+
+    // Detaches a whole bucket and hands each item to fn, which must re-place or
+    // release it.
+    template <typename Fn>
+    void drain(std::uint32_t bucket, Fn&& fn)
+    {
+        T* item = heads_[bucket];
+        heads_[bucket] = nullptr;
+        if (bucket < kDueBucket) {
+            occupancy_[bucket / kSlots][(bucket % kSlots) / 64] &= ~(std::uint64_t{1} << (bucket % 64));
+        }
+        while (item != nullptr) {
+            auto& hook = item->*Hook;
+            T* next = hook.next;
+            hook.prev = nullptr;
+            hook.next = nullptr;
+            hook.bucket = kUnscheduled;
+            fn(*item);
+            item = next;
+        }
+    }
+
+    // At a level-l window boundary the level-l slot coming up spreads into the
+    // levels below. Highest level first, so nothing lands in a slot that is
+    // about to be drained at this same tick.
+    void cascadeAt(std::uint64_t tick)
+    {
+        const auto replace = [this](T& item) { place(item); };
+        if (tick % levelSpan(kLevels) == 0) {
+            drain(kOverflowBucket, replace);
+        }
+        for (unsigned level = kLevels - 1; level > 0; --level) {
+            if (tick % levelSpan(level) == 0) {
+                drain(level * kSlots + static_cast<std::uint32_t>((tick >> (kSlotBits * level)) & (kSlots - 1)), replace);
+            }
+        }
+    }
+
+    template <typename OnExpire>
+    std::size_t fireSlot(std::uint64_t slot, OnExpire& onExpire)
+    {
+        std::size_t fired = 0;
+        drain(static_cast<std::uint32_t>(slot), [&](T& item) {
+            --size_;
+            ++fired;
+            onExpire(item);
+        });
+        return fired;
+    }
+
+    template <typename OnExpire>
+    std::size_t fireDue(std::uint64_t now, OnExpire& onExpire)
+    {
+        std::size_t fired = 0;
+        T* item = heads_[kDueBucket];
+        while (item != nullptr) {
+            T* next = (item->*Hook).next;
+            if ((item->*Hook).deadline <= now) {
+                unlink(*item);
+                --size_;
+                ++fired;
+                onExpire(*item);
+            }
+            item = next;
+        }
+        return fired;
+    }
+
+    // First occupied slot strictly after `index`, wrapping; -1 when empty.
+    static int nextOccupied(const Bitmap& bitmap, std::uint32_t index)
+    {
+        for (const std::uint32_t from : {index + 1, 0u}) {
+            for (std::uint32_t word = from / 64; word < bitmap.size(); ++word) {
+                std::uint64_t bits = bitmap[word];
+                if (word == from / 64) {
+                    bits &= ~std::uint64_t{0} << (from % 64);
+                }
+                if (bits != 0) {
+                    return static_cast<int>(word * 64 + static_cast<std::uint32_t>(std::countr_zero(bits)));
+                }
+            }
+        }
+        return -1;
+    }
+
+    // Earliest tick after now_ at which a slot fires or cascades.
+    std::uint64_t nextEventTick() const
+    {
+        std::uint64_t next = kNoEvent;
+        for (unsigned level = 0; level < kLevels; ++level) {
+            const auto index = static_cast<std::uint32_t>((now_ >> (kSlotBits * level)) & (kSlots - 1));
+            const int slot = nextOccupied(occupancy_[level], index);
+            if (slot < 0) {
+                continue;
+            }
+            // Slots at or behind the current index belong to the next rotation.
+            const std::uint64_t rotation = levelSpan(level + 1);
+            std::uint64_t tick = now_ / rotation * rotation + static_cast<std::uint64_t>(slot) * levelSpan(level);
+            if (static_cast<std::uint32_t>(slot) <= index) {
+                tick += rotation;
+            }
+            next = std::min(next, tick);
+        }
+        if (heads_[kOverflowBucket] != nullptr) {
+            next = std::min(next, (now_ / levelSpan(kLevels) + 1) * levelSpan(kLevels));
+        }
+        return next;
+    }
+
+    std::array<T*, kBucketCount> heads_{};
+    std::array<Bitmap, kLevels> occupancy_{};
+    std::uint64_t now_;
+    std::size_t size_ = 0;
+};
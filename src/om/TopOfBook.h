@@ -0,0 +1,20 @@
+#pragma once
+
+// Best bid/ask (aggregate quantity at the best price) and the last trade of one
+// symbol. A zero quantity means that side is empty / nothing has traded yet.
+template <typename PriceT, typename QuantityT>
+struct BasicTopOfBook
+{
+    PriceT bidPrice_{};
+    QuantityT bidQuantity_{};
+    PriceT askPrice_{};
+    QuantityT askQuantity_{};
+    PriceT lastTradePrice_{};
+    QuantityT lastTradeQuantity_{};
+
+    bool hasBid() const { return bidQuantity_ != 0; }
+    bool hasAsk() const { return askQuantity_ != 0; }
+    bool hasLastTrade() const { return lastTradeQuantity_ != 0; }
+
+    bool operator==(const BasicTopOfBook&) const = default;
+};
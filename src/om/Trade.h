@@ -4,10 +4,13 @@
 
 #include "TradeInfo.h"
 
-class Trade
+template <typename PriceT, typename QuantityT>
+class BasicTrade
 {
 public:
-    Trade(const TradeInfo& bidTrade, const TradeInfo& askTrade)
+    using TradeInfo = BasicTradeInfo<PriceT, QuantityT>;
+
+    BasicTrade(const TradeInfo& bidTrade, const TradeInfo& askTrade)
     : bidTrade_{ bidTrade }
     , askTrade_{ askTrade }
     { }
@@ -20,4 +23,5 @@ private:
     TradeInfo askTrade_;
 };
 
+using Trade = BasicTrade<Price, Quantity>;
 using Trades = std::vector<Trade>;
\ No newline at end of file
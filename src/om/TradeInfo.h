@@ -2,15 +2,18 @@
 
 #include "Usings.h"
 
-struct TradeInfo
+template <typename PriceT, typename QuantityT>
+struct BasicTradeInfo
 {
-    Price price_;
-    Quantity quantity_;
+    PriceT price_;
+    QuantityT quantity_;
     OrderId orderId_;
     Symbol symbol_;
 
-    Price getPrice() const { return price_; }
-    Quantity getQuantity() const { return quantity_; }
+    PriceT getPrice() const { return price_; }
+    QuantityT getQuantity() const { return quantity_; }
     OrderId getOrderId() const { return orderId_; }
     Symbol getSymbol() const { return symbol_; }
-};
\ No newline at end of file
+};
+
+using TradeInfo = BasicTradeInfo<Price, Quantity>;
\ No newline at end of file
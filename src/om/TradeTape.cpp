@@ -0,0 +1,96 @@
+#include "TradeTape.h"
+
+#include <chrono>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace TradeTapeDetail {
+
+MappedFile mapSpillFile(const std::string& path, std::size_t bytes)
+{
+    MappedFile file;
+#if defined(__unix__) || defined(__APPLE__)
+    const int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return file;
+    }
+    if (::ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+        ::close(fd);
+        return file;
+    }
+    void* data = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (data == MAP_FAILED) {
+        ::close(fd);
+        return file;
+    }
+    file.data = data;
+    file.bytes = bytes;
+    file.fd = fd;
+#else
+    (void)path;
+    (void)bytes;
+#endif
+    return file;
+}
+
+void unmapSpillFile(MappedFile& file)
+{
+#if defined(__unix__) || defined(__APPLE__)
+    if (file.data != nullptr) {
+        ::munmap(file.data, file.bytes);
+    }
+    if (file.fd >= 0) {
+        ::close(file.fd);
+    }
+#endif
+    file = MappedFile{};
+}
+
+void removeSpillFile(const std::string& path)
+{
+#if defined(__unix__) || defined(__APPLE__)
+    ::unlink(path.c_str());
+#else
+    (void)path;
+#endif
+}
+
+bool writeSpillFile(const std::string& path, const void* data, std::size_t bytes)
+{
+#if defined(__unix__) || defined(__APPLE__)
+    const int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    const auto* next = static_cast<const char*>(data);
+    std::size_t left = bytes;
+    while (left > 0) {
+        const ssize_t written = ::write(fd, next, left);
+        if (written <= 0) {
+            ::close(fd);
+            return false;
+        }
+        next += written;
+        left -= static_cast<std::size_t>(written);
+    }
+    return ::close(fd) == 0;
+#else
+    (void)path;
+    (void)data;
+    (void)bytes;
+    return false;
+#endif
+}
+
+std::int64_t wallClockNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::system_clock::now().time_since_epoch())
+        .count();
+}
+
+} // namespace TradeTapeDetail
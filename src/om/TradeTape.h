@@ -0,0 +1,665 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "Side.h"
+#include "Usings.h"
+
+struct TradeTapeConfig {
+    std::size_t segmentCapacity = 4096; // trades per segment
+    std::size_t segmentsPerSymbol = 16; // segments kept mapped per symbol
+    // Empty: segments live on the heap and the oldest is recycled. Otherwise each
+    // segment is a file <dir>/<symbol>-<sequence>.tape mapped into memory; when
+    // it leaves the window it is unmapped and the file stays behind. A helper
+    // thread maps each symbol's next file ahead of time and does the unmapping;
+    // a segment whose file is not mapped yet starts on the heap and the helper
+    // writes it to its file once it leaves the window.
+    std::string spillDirectory;
+};
+
+// First bytes of every segment, also the header of a spilled segment file. The
+// columns follow, each aligned to kTapeColumnAlignment: timestamps (int64 ns
+// since the epoch), prices, quantities, then one aggressor byte per trade
+// (0 = buy, 1 = sell). `count` is final once the segment has been sealed.
+struct TapeSegmentHeader {
+    char magic[8];
+    std::uint32_t symbolId;
+    std::uint32_t capacity;
+    std::uint64_t sequence;
+    std::uint64_t count;
+    std::uint16_t priceBytes;
+    std::uint16_t quantityBytes;
+};
+
+inline constexpr char kTapeSegmentMagic[8] = {'O', 'M', 'T', 'A', 'P', 'E', '1', '\0'};
+inline constexpr std::size_t kTapeColumnAlignment = 64;
+
+namespace TradeTapeDetail {
+
+struct MappedFile {
+    void* data = nullptr;
+    std::size_t bytes = 0;
+    int fd = -1;
+};
+
+// Creates (truncating) and maps a file of `bytes`; data stays null on failure.
+MappedFile mapSpillFile(const std::string& path, std::size_t bytes);
+void unmapSpillFile(MappedFile& file);
+void removeSpillFile(const std::string& path);
+// Creates (truncating) the file and writes `bytes` of data; false on failure.
+bool writeSpillFile(const std::string& path, const void* data, std::size_t bytes);
+
+std::int64_t wallClockNs();
+
+constexpr std::size_t alignColumn(std::size_t offset)
+{
+    return (offset + kTapeColumnAlignment - 1) / kTapeColumnAlignment * kTapeColumnAlignment;
+}
+
+// Column kernels: plain counted loops over contiguous arrays so the compiler
+// can vectorise them.
+template <typename Quantity>
+std::uint64_t sumQuantity(const Quantity* quantities, std::size_t count)
+{
+    std::uint64_t total = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        total += quantities[i];
+    }
+    return total;
+}
+
+template <typename Notional, typename Price, typename Quantity>
+Notional sumNotional(const Price* prices, const Quantity* quantities, std::size_t count)
+{
+    Notional total{};
+    for (std::size_t i = 0; i < count; ++i) {
+        total += static_cast<Notional>(prices[i]) * static_cast<Notional>(quantities[i]);
+    }
+    return total;
+}
+
+template <typename Price>
+Price maxPrice(const Price* prices, std::size_t count, Price high)
+{
+    for (std::size_t i = 0; i < count; ++i) {
+        high = prices[i] > high ? prices[i] : high;
+    }
+    return high;
+}
+
+template <typename Price>
+Price minPrice(const Price* prices, std::size_t count, Price low)
+{
+    for (std::size_t i = 0; i < count; ++i) {
+        low = prices[i] < low ? prices[i] : low;
+    }
+    return low;
+}
+
+} // namespace TradeTapeDetail
+
+// OHLC, volume and notional of the trades in [startNs, endNs).
+template <typename PriceT, typename QuantityT>
+struct BasicTradeBar {
+    // Exact while price x quantity fits 64 bits, floating point for wide types.
+    using Notional = std::conditional_t<sizeof(PriceT) <= 4 && sizeof(QuantityT) <= 4, std::uint64_t, double>;
+
+    std::int64_t startNs = 0;
+    std::int64_t endNs = 0;
+    PriceT open{};
+    PriceT high{};
+    PriceT low{};
+    PriceT close{};
+    std::uint64_t volume = 0;
+    Notional notional{};
+    std::uint64_t trades = 0;
+
+    bool empty() const { return trades == 0; }
+    double vwap() const { return volume == 0 ? 0.0 : static_cast<double>(notional) / static_cast<double>(volume); }
+};
+
+// Per-symbol, append-only record of every print, stored column-wise in fixed
+// size segments. One writer (the matcher, under the book lock) appends; any
+// number of readers query without taking that lock:
+//
+//  - a trade becomes visible when the segment's count is released past it, and
+//    published slots are never rewritten in place;
+//  - a reader pins each segment while it scans it, and a segment that falls
+//    out of the window is retired and only recycled (or unmapped) once it is
+//    unpinned, so a reader never sees its columns change underneath it. A
+//    reader holds back at most the one segment it is scanning, however often
+//    it polls.
+//
+// Timestamps are kept non-decreasing per symbol, so a time window maps to one
+// contiguous index range per segment by binary search.
+template <typename PriceT, typename QuantityT>
+class BasicTradeTape {
+public:
+    using Price = PriceT;
+    using Quantity = QuantityT;
+    using TradeBar = BasicTradeBar<Price, Quantity>;
+    using Notional = typename TradeBar::Notional;
+
+    BasicTradeTape(SymbolId symbolUniverseSize, TradeTapeConfig config)
+        : config_(std::move(config))
+        , universe_(symbolUniverseSize)
+        , symbols_(std::make_unique<std::atomic<SymbolTape*>[]>(symbolUniverseSize))
+    {
+        if (config_.segmentCapacity == 0 || config_.segmentCapacity > std::numeric_limits<std::uint32_t>::max() ||
+            config_.segmentsPerSymbol == 0) {
+            throw std::invalid_argument("Invalid trade tape configuration");
+        }
+        timestampsOffset_ = TradeTapeDetail::alignColumn(sizeof(TapeSegmentHeader));
+        pricesOffset_ = TradeTapeDetail::alignColumn(timestampsOffset_ + config_.segmentCapacity * sizeof(std::int64_t));
+        quantitiesOffset_ = TradeTapeDetail::alignColumn(pricesOffset_ + config_.segmentCapacity * sizeof(Price));
+        aggressorsOffset_ = TradeTapeDetail::alignColumn(quantitiesOffset_ + config_.segmentCapacity * sizeof(Quantity));
+        segmentBytes_ = TradeTapeDetail::alignColumn(aggressorsOffset_ + config_.segmentCapacity);
+        if (!config_.spillDirectory.empty()) {
+            spillThread_ = std::thread(&BasicTradeTape::spillLoop, this);
+        }
+    }
+
+    ~BasicTradeTape()
+    {
+        if (spillThread_.joinable()) {
+            {
+                std::scoped_lock lock(spillMutex_);
+                stopSpill_ = true;
+            }
+            spillCv_.notify_all();
+            spillThread_.join();
+        }
+        // Files mapped ahead for segments that never started hold no trades. One
+        // overtaken by a heap segment is left to that segment's write below.
+        for (auto& tape : symbolTapes_) {
+            if (tape->prepared.data != nullptr) {
+                TradeTapeDetail::unmapSpillFile(tape->prepared);
+                if (tape->preparedSequence >= tape->segmentCount.load(std::memory_order_relaxed)) {
+                    TradeTapeDetail::removeSpillFile(spillPath(tape->symbolId, tape->preparedSequence));
+                }
+            }
+        }
+        for (auto& segment : segments_) {
+            if (segment->file.data != nullptr) {
+                sealSegment(*segment);
+                TradeTapeDetail::unmapSpillFile(segment->file);
+            } else if (segment->spillLater) {
+                sealSegment(*segment);
+                if (!TradeTapeDetail::writeSpillFile(spillPath(segment->header->symbolId, segment->sequence),
+                                                     segment->heap.get(), segmentBytes_)) {
+                    spillFailures_.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+        }
+    }
+
+    BasicTradeTape(const BasicTradeTape&) = delete;
+    BasicTradeTape& operator=(const BasicTradeTape&) = delete;
+
+    static std::int64_t now() { return TradeTapeDetail::wallClockNs(); }
+
+    // Writer only. Sets up the symbol's tape ahead of its first trade, which in
+    // spill mode has the helper map the first segment file.
+    void prepareSymbol(SymbolId symbolId)
+    {
+        if (symbolId < universe_ && symbols_[symbolId].load(std::memory_order_relaxed) == nullptr) {
+            createSymbolTape(symbolId);
+        }
+    }
+
+    // Writer only. Timestamps earlier than the symbol's last one are raised to it.
+    void append(SymbolId symbolId, Price price, Quantity quantity, Side aggressorSide, std::int64_t timestampNs)
+    {
+        if (symbolId >= universe_) {
+            return;
+        }
+        SymbolTape* tape = symbols_[symbolId].load(std::memory_order_relaxed);
+        if (tape == nullptr) {
+            tape = createSymbolTape(symbolId);
+        }
+        Segment* segment = tape->current;
+        std::uint32_t index = segment != nullptr ? segment->count.load(std::memory_order_relaxed) : 0;
+        if (segment == nullptr || index == config_.segmentCapacity) {
+            segment = rotate(*tape, symbolId);
+            index = 0;
+        }
+
+        timestampNs = std::max(timestampNs, tape->lastTimestamp);
+        tape->lastTimestamp = timestampNs;
+        segment->timestamps[index] = timestampNs;
+        segment->prices[index] = price;
+        segment->quantities[index] = quantity;
+        segment->aggressors[index] = aggressorSide == Side::BUY ? 0 : 1;
+        segment->count.store(index + 1, std::memory_order_release);
+        tape->trades.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Trades in [fromNs, toNs) that are still in the symbol's window.
+    TradeBar summarize(SymbolId symbolId, std::int64_t fromNs, std::int64_t toNs) const
+    {
+        TradeBar bar;
+        bar.startNs = fromNs;
+        bar.endNs = toNs;
+        if (symbolId >= universe_ || fromNs >= toNs) {
+            return bar;
+        }
+        const SymbolTape* tape = symbols_[symbolId].load(std::memory_order_acquire);
+        if (tape == nullptr) {
+            return bar;
+        }
+
+        const std::uint64_t published = tape->segmentCount.load(std::memory_order_acquire);
+        const std::uint64_t window = config_.segmentsPerSymbol;
+        for (std::uint64_t sequence = published > window ? published - window : 0; sequence < published; ++sequence) {
+            const auto& slot = tape->ring[sequence % window];
+            Segment* segment = slot.load(std::memory_order_acquire);
+            if (segment == nullptr) {
+                continue;
+            }
+            SegmentPin pin(*segment);
+            // A slot the writer has moved on from since `published` was read is skipped.
+            if (slot.load(std::memory_order_seq_cst) != segment || segment->sequence != sequence) {
+                continue;
+            }
+            const std::uint32_t count = segment->count.load(std::memory_order_acquire);
+            if (count == 0 || segment->timestamps[count - 1] < fromNs || segment->timestamps[0] >= toNs) {
+                continue;
+            }
+            const std::int64_t* timestamps = segment->timestamps;
+            const auto first = static_cast<std::size_t>(std::lower_bound(timestamps, timestamps + count, fromNs) - timestamps);
+            const auto last = static_cast<std::size_t>(std::lower_bound(timestamps, timestamps + count, toNs) - timestamps);
+            if (first < last) {
+                accumulate(*segment, first, last, bar);
+            }
+        }
+        return bar;
+    }
+
+    // Consecutive bars of intervalNs covering [fromNs, toNs); the last may be shorter.
+    std::vector<TradeBar> bars(SymbolId symbolId, std::int64_t fromNs, std::int64_t toNs, std::int64_t intervalNs) const
+    {
+        std::vector<TradeBar> result;
+        if (intervalNs <= 0) {
+            return result;
+        }
+        for (std::int64_t start = fromNs; start < toNs; start += intervalNs) {
+            result.push_back(summarize(symbolId, start, std::min(toNs, start + intervalNs)));
+        }
+        return result;
+    }
+
+    double vwap(SymbolId symbolId, std::int64_t fromNs, std::int64_t toNs) const
+    {
+        return summarize(symbolId, fromNs, toNs).vwap();
+    }
+
+    std::uint64_t volume(SymbolId symbolId, std::int64_t fromNs, std::int64_t toNs) const
+    {
+        return summarize(symbolId, fromNs, toNs).volume;
+    }
+
+    // Every trade ever appended for the symbol, including those out of the window.
+    std::uint64_t tradeCount(SymbolId symbolId) const
+    {
+        if (symbolId >= universe_) {
+            return 0;
+        }
+        const SymbolTape* tape = symbols_[symbolId].load(std::memory_order_acquire);
+        return tape == nullptr ? 0 : tape->trades.load(std::memory_order_relaxed);
+    }
+
+    // Segments that left the window and were handed over to the helper, to be
+    // unmapped or written to their spill files, and segments whose file could
+    // not be written.
+    std::uint64_t spilledSegments() const { return spilledSegments_.load(std::memory_order_relaxed); }
+    std::uint64_t spillFailures() const { return spillFailures_.load(std::memory_order_relaxed); }
+
+    // Heap and mapped segment storage currently held.
+    std::size_t memoryBytes() const { return residentBytes_.load(std::memory_order_relaxed); }
+
+    const TradeTapeConfig& config() const { return config_; }
+
+private:
+    struct Segment {
+        std::uint64_t sequence = 0;
+        std::atomic<std::uint32_t> count{ 0 };
+        mutable std::atomic<std::uint32_t> pins{ 0 }; // readers scanning it
+        TapeSegmentHeader* header = nullptr;
+        std::int64_t* timestamps = nullptr;
+        Price* prices = nullptr;
+        Quantity* quantities = nullptr;
+        std::uint8_t* aggressors = nullptr;
+        std::unique_ptr<std::uint64_t[]> heap; // heap-backed storage, kept across recycling
+        TradeTapeDetail::MappedFile file;      // or the mapped spill file
+        bool spillLater = false;               // spill mode on the heap: written out on retirement
+    };
+
+    struct SymbolTape {
+        SymbolTape(SymbolId id, std::size_t window)
+            : ring(std::make_unique<std::atomic<Segment*>[]>(window))
+            , symbolId(id)
+        {
+        }
+
+        std::unique_ptr<std::atomic<Segment*>[]> ring; // sequence % window
+        std::atomic<std::uint64_t> segmentCount{ 0 };  // sequences published so far
+        std::atomic<std::uint64_t> trades{ 0 };
+        const SymbolId symbolId;
+        Segment* current = nullptr; // writer only
+        std::int64_t lastTimestamp = 0;
+        // Spill mode, under spillMutex_: the file of the next segment, mapped
+        // by the helper thread, and whether the helper is still working on it.
+        TradeTapeDetail::MappedFile prepared;
+        std::uint64_t preparedSequence = 0;
+        bool preparing = false;
+    };
+
+    struct PrepareRequest {
+        SymbolTape* tape;
+        std::uint64_t sequence;
+    };
+
+    struct PendingWrite {
+        SymbolId symbolId;
+        std::uint64_t sequence;
+        std::unique_ptr<std::uint64_t[]> data; // the retired segment's heap storage
+    };
+
+    // A reader pins a segment, then re-reads its ring slot; the writer unpublishes
+    // a segment, then checks its pins before reusing it. With both sides
+    // sequentially consistent, either the writer sees the pin or the reader sees
+    // the slot already changed and skips the segment.
+    class SegmentPin {
+    public:
+        explicit SegmentPin(const Segment& segment) : segment_(segment)
+        {
+            segment_.pins.fetch_add(1, std::memory_order_seq_cst);
+        }
+        ~SegmentPin() { segment_.pins.fetch_sub(1, std::memory_order_release); }
+
+        SegmentPin(const SegmentPin&) = delete;
+        SegmentPin& operator=(const SegmentPin&) = delete;
+
+    private:
+        const Segment& segment_;
+    };
+
+    SymbolTape* createSymbolTape(SymbolId symbolId)
+    {
+        symbolTapes_.push_back(std::make_unique<SymbolTape>(symbolId, config_.segmentsPerSymbol));
+        SymbolTape* tape = symbolTapes_.back().get();
+        symbols_[symbolId].store(tape, std::memory_order_release);
+        if (!config_.spillDirectory.empty()) {
+            requestPreparedFile(*tape, 0);
+        }
+        return tape;
+    }
+
+    Segment* rotate(SymbolTape& tape, SymbolId symbolId)
+    {
+        if (tape.current != nullptr) {
+            sealSegment(*tape.current);
+        }
+        const std::uint64_t sequence = tape.segmentCount.load(std::memory_order_relaxed);
+        Segment* segment = acquireSegment(tape, symbolId, sequence);
+
+        auto& slot = tape.ring[sequence % config_.segmentsPerSymbol];
+        Segment* evicted = slot.load(std::memory_order_relaxed);
+        slot.store(segment, std::memory_order_seq_cst);
+        tape.segmentCount.store(sequence + 1, std::memory_order_release);
+        tape.current = segment;
+
+        if (evicted != nullptr) {
+            retired_.push_back(evicted);
+        }
+        reclaimRetired();
+        return segment;
+    }
+
+    Segment* acquireSegment(SymbolTape& tape, SymbolId symbolId, std::uint64_t sequence)
+    {
+        Segment* segment = nullptr;
+        if (!free_.empty()) {
+            segment = free_.back();
+            free_.pop_back();
+        } else {
+            segments_.push_back(std::make_unique<Segment>());
+            segment = segments_.back().get();
+        }
+
+        void* storage = nullptr;
+        segment->spillLater = false;
+        if (!config_.spillDirectory.empty()) {
+            segment->file = takePreparedFile(tape, sequence);
+            storage = segment->file.data;
+            if (storage != nullptr) {
+                if (segment->heap) {
+                    segment->heap.reset();
+                    residentBytes_.fetch_sub(segmentBytes_, std::memory_order_relaxed);
+                }
+                residentBytes_.fetch_add(segmentBytes_, std::memory_order_relaxed);
+            } else {
+                // Not mapped (yet): the matcher never waits for the file system.
+                segment->spillLater = true;
+            }
+        }
+        if (storage == nullptr) {
+            if (!segment->heap) {
+                segment->heap = std::make_unique<std::uint64_t[]>(segmentBytes_ / sizeof(std::uint64_t));
+                residentBytes_.fetch_add(segmentBytes_, std::memory_order_relaxed);
+            }
+            storage = segment->heap.get();
+        }
+
+        auto* bytes = static_cast<std::byte*>(storage);
+        segment->header = reinterpret_cast<TapeSegmentHeader*>(bytes);
+        segment->timestamps = reinterpret_cast<std::int64_t*>(bytes + timestampsOffset_);
+        segment->prices = reinterpret_cast<Price*>(bytes + pricesOffset_);
+        segment->quantities = reinterpret_cast<Quantity*>(bytes + quantitiesOffset_);
+        segment->aggressors = reinterpret_cast<std::uint8_t*>(bytes + aggressorsOffset_);
+
+        TapeSegmentHeader& header = *segment->header;
+        std::memcpy(header.magic, kTapeSegmentMagic, sizeof(header.magic));
+        header.symbolId = symbolId;
+        header.capacity = static_cast<std::uint32_t>(config_.segmentCapacity);
+        header.sequence = sequence;
+        header.count = 0;
+        header.priceBytes = sizeof(Price);
+        header.quantityBytes = sizeof(Quantity);
+
+        segment->sequence = sequence;
+        segment->count.store(0, std::memory_order_relaxed);
+        return segment;
+    }
+
+    void sealSegment(Segment& segment)
+    {
+        segment.header->count = segment.count.load(std::memory_order_relaxed);
+    }
+
+    // Recycles heap segments and hands file segments to the helper thread for
+    // unmapping (heap segments in spill mode for writing) once no reader has
+    // them pinned. Pinned ones wait for a later rotation.
+    void reclaimRetired()
+    {
+        std::size_t kept = 0;
+        for (Segment* segment : retired_) {
+            if (segment->pins.load(std::memory_order_seq_cst) != 0) {
+                retired_[kept++] = segment;
+                continue;
+            }
+            if (segment->file.data != nullptr) {
+                sealSegment(*segment);
+                {
+                    std::scoped_lock lock(spillMutex_);
+                    unmapQueue_.push_back(segment->file);
+                }
+                spillCv_.notify_all();
+                segment->file = TradeTapeDetail::MappedFile{};
+                residentBytes_.fetch_sub(segmentBytes_, std::memory_order_relaxed);
+                spilledSegments_.fetch_add(1, std::memory_order_relaxed);
+            } else if (segment->spillLater) {
+                // The storage goes with the write; the helper releases its bytes.
+                sealSegment(*segment);
+                {
+                    std::scoped_lock lock(spillMutex_);
+                    writeQueue_.push_back(
+                        PendingWrite{segment->header->symbolId, segment->sequence, std::move(segment->heap)});
+                }
+                spillCv_.notify_all();
+                segment->spillLater = false;
+                spilledSegments_.fetch_add(1, std::memory_order_relaxed);
+            }
+            free_.push_back(segment);
+        }
+        retired_.resize(kept);
+    }
+
+    // The file the helper mapped for `sequence`, and a request for the next one.
+    // Never waits: null while the helper is still on it (or holds the lock), or
+    // when mapping failed, and the segment then goes to the heap. A file mapped
+    // for a sequence that went to the heap meanwhile is unmapped; that
+    // segment's write replaces it later.
+    TradeTapeDetail::MappedFile takePreparedFile(SymbolTape& tape, std::uint64_t sequence)
+    {
+        TradeTapeDetail::MappedFile file;
+        std::unique_lock lock(spillMutex_, std::try_to_lock);
+        if (!lock.owns_lock() || tape.preparing) {
+            return file;
+        }
+        if (tape.prepared.data != nullptr) {
+            if (tape.preparedSequence == sequence) {
+                file = tape.prepared;
+            } else {
+                unmapQueue_.push_back(tape.prepared);
+            }
+            tape.prepared = TradeTapeDetail::MappedFile{};
+        }
+        tape.preparing = true;
+        prepareQueue_.push_back(PrepareRequest{&tape, sequence + 1});
+        lock.unlock();
+        spillCv_.notify_all();
+        return file;
+    }
+
+    void requestPreparedFile(SymbolTape& tape, std::uint64_t sequence)
+    {
+        {
+            std::scoped_lock lock(spillMutex_);
+            tape.preparing = true;
+            prepareQueue_.push_back(PrepareRequest{&tape, sequence});
+        }
+        spillCv_.notify_all();
+    }
+
+    // Helper thread in spill mode: all file creation, mapping, writing and
+    // unmapping happens here, off the matcher's path. Drains its queues before stopping.
+    void spillLoop()
+    {
+        std::vector<PrepareRequest> prepare;
+        std::vector<TradeTapeDetail::MappedFile> unmap;
+        std::vector<PendingWrite> write;
+        std::unique_lock lock(spillMutex_);
+        while (true) {
+            spillCv_.wait(lock, [&] {
+                return stopSpill_ || !prepareQueue_.empty() || !unmapQueue_.empty() || !writeQueue_.empty();
+            });
+            if (prepareQueue_.empty() && unmapQueue_.empty() && writeQueue_.empty()) {
+                return;
+            }
+            prepare.swap(prepareQueue_);
+            unmap.swap(unmapQueue_);
+            write.swap(writeQueue_);
+            lock.unlock();
+
+            for (TradeTapeDetail::MappedFile& file : unmap) {
+                TradeTapeDetail::unmapSpillFile(file);
+            }
+            unmap.clear();
+            for (PrepareRequest& request : prepare) {
+                TradeTapeDetail::MappedFile file =
+                    TradeTapeDetail::mapSpillFile(spillPath(request.tape->symbolId, request.sequence), segmentBytes_);
+                std::scoped_lock done(spillMutex_);
+                request.tape->prepared = file;
+                request.tape->preparedSequence = request.sequence;
+                request.tape->preparing = false;
+            }
+            prepare.clear();
+            // After the prepares: a heap segment's write wins over a file mapped for it too late.
+            for (PendingWrite& pending : write) {
+                if (!TradeTapeDetail::writeSpillFile(spillPath(pending.symbolId, pending.sequence), pending.data.get(),
+                                                     segmentBytes_)) {
+                    spillFailures_.fetch_add(1, std::memory_order_relaxed);
+                }
+                pending.data.reset();
+                residentBytes_.fetch_sub(segmentBytes_, std::memory_order_relaxed);
+            }
+            write.clear();
+            lock.lock();
+        }
+    }
+
+    std::string spillPath(SymbolId symbolId, std::uint64_t sequence) const
+    {
+        return config_.spillDirectory + "/" + std::to_string(symbolId) + "-" + std::to_string(sequence) + ".tape";
+    }
+
+    void accumulate(const Segment& segment, std::size_t first, std::size_t last, TradeBar& bar) const
+    {
+        const std::size_t count = last - first;
+        const Price* prices = segment.prices + first;
+        const Quantity* quantities = segment.quantities + first;
+        if (bar.trades == 0) {
+            bar.open = prices[0];
+            bar.high = prices[0];
+            bar.low = prices[0];
+        }
+        bar.close = prices[count - 1];
+        bar.high = TradeTapeDetail::maxPrice(prices, count, bar.high);
+        bar.low = TradeTapeDetail::minPrice(prices, count, bar.low);
+        bar.volume += TradeTapeDetail::sumQuantity(quantities, count);
+        bar.notional += TradeTapeDetail::sumNotional<Notional>(prices, quantities, count);
+        bar.trades += count;
+    }
+
+    TradeTapeConfig config_;
+    SymbolId universe_;
+    std::size_t timestampsOffset_ = 0;
+    std::size_t pricesOffset_ = 0;
+    std::size_t quantitiesOffset_ = 0;
+    std::size_t aggressorsOffset_ = 0;
+    std::size_t segmentBytes_ = 0;
+
+    std::unique_ptr<std::atomic<SymbolTape*>[]> symbols_;
+    // Writer-side bookkeeping.
+    std::vector<std::unique_ptr<SymbolTape>> symbolTapes_;
+    std::vector<std::unique_ptr<Segment>> segments_;
+    std::vector<Segment*> retired_;
+    std::vector<Segment*> free_;
+
+    // Spill helper thread and its work.
+    std::mutex spillMutex_;
+    std::condition_variable spillCv_;
+    std::vector<PrepareRequest> prepareQueue_;
+    std::vector<TradeTapeDetail::MappedFile> unmapQueue_;
+    std::vector<PendingWrite> writeQueue_;
+    bool stopSpill_ = false;
+    std::thread spillThread_;
+
+    std::atomic<std::uint64_t> spilledSegments_{ 0 };
+    std::atomic<std::uint64_t> spillFailures_{ 0 };
+    std::atomic<std::size_t> residentBytes_{ 0 };
+};
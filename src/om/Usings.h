@@ -2,6 +2,7 @@
 
 #include <charconv>
 #include <cstdint>
+#include <limits>
 #include <string_view>
 #include <vector>
 
@@ -11,15 +12,20 @@ using OrderId = uint64_t; // Unique order identifier
 using OrderIds = std::vector<OrderId>;
 using SymbolId = uint32_t; // Symbol ID from FIX tag 55
 using Symbol = SymbolId;
+using SessionId = uint32_t; // Owning client session (connection), see Orderbook::cancelSessionOrders
+inline constexpr SessionId kNoSession = 0;
+using AccountId = uint32_t; // FIX tag 1 (Account), see RiskChecks.h
+inline constexpr AccountId kDefaultAccount = 0; // orders without tag 1
 
+// Default size of the symbol universe; the Orderbook can be configured larger at runtime.
 inline constexpr SymbolId kKnownSymbolCount = 500;
-inline constexpr SymbolId kInvalidSymbolId = kKnownSymbolCount;
+inline constexpr SymbolId kInvalidSymbolId = std::numeric_limits<SymbolId>::max();
 
-inline bool isValidSymbolId(SymbolId symbolId) {
-    return symbolId < kKnownSymbolCount;
+inline bool isValidSymbolId(SymbolId symbolId, SymbolId universeSize = kKnownSymbolCount) {
+    return symbolId < universeSize;
 }
 
-inline SymbolId toSymbolId(std::string_view symbol) {
+inline SymbolId toSymbolId(std::string_view symbol, SymbolId universeSize = kKnownSymbolCount) {
     SymbolId id = 0;
     const char* begin = symbol.data();
     const char* end = begin + symbol.size();
@@ -27,5 +33,5 @@ inline SymbolId toSymbolId(std::string_view symbol) {
     if (ec != std::errc() || ptr != end) {
         return kInvalidSymbolId;
     }
-    return isValidSymbolId(id) ? id : kInvalidSymbolId;
+    return isValidSymbolId(id, universeSize) ? id : kInvalidSymbolId;
 }
\ No newline at end of file
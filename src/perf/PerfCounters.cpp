@@ -0,0 +1,141 @@
+#include "PerfCounters.h"
+
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace {
+
+struct EventSpec {
+    std::uint32_t type;
+    std::uint64_t config;
+};
+
+constexpr std::uint64_t cacheConfig(std::uint64_t cache, std::uint64_t op, std::uint64_t result)
+{
+    return cache | (op << 8) | (result << 16);
+}
+
+// Indexed by PerfEvent.
+constexpr std::array<EventSpec, kPerfEventCount> kEventSpecs = {{
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+    { PERF_TYPE_HW_CACHE, cacheConfig(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS) },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+    { PERF_TYPE_HW_CACHE, cacheConfig(PERF_COUNT_HW_CACHE_DTLB, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS) },
+}};
+
+int openEvent(const EventSpec& spec)
+{
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = spec.type;
+    attr.config = spec.config;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0 /* this thread */, -1 /* any cpu */, -1, 0));
+}
+
+std::string paranoidHint()
+{
+    std::ifstream file("/proc/sys/kernel/perf_event_paranoid");
+    int level = 0;
+    if (!(file >> level)) {
+        return "";
+    }
+    return " (kernel.perf_event_paranoid=" + std::to_string(level) +
+           (level > 2 ? ", needs <= 2 or CAP_PERFMON)" : ")");
+}
+
+} // namespace
+
+const char* perfEventName(PerfEvent event)
+{
+    switch (event) {
+    case PerfEvent::Cycles: return "cycles";
+    case PerfEvent::Instructions: return "instructions";
+    case PerfEvent::L1dMisses: return "L1d misses";
+    case PerfEvent::LlcMisses: return "LLC misses";
+    case PerfEvent::BranchMisses: return "branch misses";
+    case PerfEvent::DtlbMisses: return "dTLB misses";
+    }
+    return "?";
+}
+
+PerfCounters::PerfCounters()
+{
+    int firstErrno = 0;
+    for (std::size_t i = 0; i < kPerfEventCount; ++i) {
+        fds_[i] = openEvent(kEventSpecs[i]);
+        if (fds_[i] >= 0) {
+            ++openCount_;
+        } else if (firstErrno == 0) {
+            firstErrno = errno;
+        }
+    }
+    if (openCount_ == 0) {
+        unavailableReason_ = std::string("perf_event_open: ") + std::strerror(firstErrno);
+        if (firstErrno == ENOENT || firstErrno == EOPNOTSUPP) {
+            unavailableReason_ += " (no hardware PMU exposed, e.g. inside a VM)";
+        } else {
+            unavailableReason_ += paranoidHint();
+        }
+    }
+}
+
+PerfCounters::~PerfCounters()
+{
+    for (const int fd : fds_) {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+}
+
+void PerfCounters::start()
+{
+    for (const int fd : fds_) {
+        if (fd >= 0) {
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+}
+
+PerfSample PerfCounters::stop()
+{
+    for (const int fd : fds_) {
+        if (fd >= 0) {
+            ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        }
+    }
+
+    PerfSample sample;
+    for (std::size_t i = 0; i < kPerfEventCount; ++i) {
+        if (fds_[i] < 0) {
+            continue;
+        }
+        // read_format: value, time_enabled, time_running
+        std::uint64_t raw[3] = {};
+        if (::read(fds_[i], raw, sizeof(raw)) != static_cast<ssize_t>(sizeof(raw)) || raw[2] == 0) {
+            continue;
+        }
+        const double coverage = static_cast<double>(raw[2]) / static_cast<double>(raw[1]);
+        sample.values[i] = static_cast<std::uint64_t>(static_cast<double>(raw[0]) / coverage);
+        sample.valid[i] = true;
+        if (coverage < sample.minCoverage) {
+            sample.minCoverage = coverage;
+        }
+    }
+    return sample;
+}
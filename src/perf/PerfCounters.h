@@ -0,0 +1,59 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Hardware counters read straight from perf_event_open(2), for the calling
+// thread only (user space). Each event is opened on its own so one unsupported
+// counter (common in VMs) does not take the others down; anything the kernel
+// refuses is reported as unavailable rather than failing the run.
+enum class PerfEvent : std::size_t {
+    Cycles,
+    Instructions,
+    L1dMisses,
+    LlcMisses,
+    BranchMisses,
+    DtlbMisses,
+};
+
+inline constexpr std::size_t kPerfEventCount = 6;
+
+const char* perfEventName(PerfEvent event);
+
+struct PerfSample {
+    std::array<std::uint64_t, kPerfEventCount> values{};
+    std::array<bool, kPerfEventCount> valid{};
+    // Lowest enabled/running ratio seen; below 1.0 the kernel multiplexed and
+    // the values were scaled up.
+    double minCoverage = 1.0;
+
+    bool has(PerfEvent event) const { return valid[static_cast<std::size_t>(event)]; }
+    std::uint64_t get(PerfEvent event) const { return values[static_cast<std::size_t>(event)]; }
+};
+
+class PerfCounters {
+public:
+    PerfCounters();
+    ~PerfCounters();
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    // True if at least one counter opened.
+    bool available() const { return openCount_ > 0; }
+    bool available(PerfEvent event) const { return fds_[static_cast<std::size_t>(event)] >= 0; }
+
+    // Why nothing opened (errno text plus a perf_event_paranoid hint); empty otherwise.
+    const std::string& unavailableReason() const { return unavailableReason_; }
+
+    // Reset and enable every open counter / disable them and read the totals.
+    void start();
+    PerfSample stop();
+
+private:
+    std::array<int, kPerfEventCount> fds_;
+    std::size_t openCount_ = 0;
+    std::string unavailableReason_;
+};
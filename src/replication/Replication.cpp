@@ -0,0 +1,445 @@
+#include "Replication.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+constexpr std::string_view kUnixPrefix = "unix:";
+constexpr std::size_t kFrameHeaderBytes = sizeof(std::uint64_t) + sizeof(SessionId) + sizeof(std::uint32_t);
+constexpr std::size_t kStreamChunkBytes = 64 * 1024;
+constexpr int kIdlePollMs = 200;
+
+struct Endpoint {
+    bool isUnix = false;
+    sockaddr_un unixAddress{};
+    sockaddr_in inetAddress{};
+};
+
+Endpoint parseEndpoint(const std::string& text)
+{
+    Endpoint endpoint;
+    if (text.rfind(kUnixPrefix, 0) == 0) {
+        const std::string path = text.substr(kUnixPrefix.size());
+        if (path.empty() || path.size() >= sizeof(endpoint.unixAddress.sun_path)) {
+            throw std::invalid_argument("Invalid unix endpoint: " + text);
+        }
+        endpoint.isUnix = true;
+        endpoint.unixAddress.sun_family = AF_UNIX;
+        std::memcpy(endpoint.unixAddress.sun_path, path.c_str(), path.size() + 1);
+        return endpoint;
+    }
+
+    const std::size_t colon = text.rfind(':');
+    if (colon == std::string::npos) {
+        throw std::invalid_argument("Endpoint must be unix:/path or host:port: " + text);
+    }
+    const std::string host = text.substr(0, colon);
+    endpoint.inetAddress.sin_family = AF_INET;
+    endpoint.inetAddress.sin_port = htons(static_cast<std::uint16_t>(std::stoi(text.substr(colon + 1))));
+    if (inet_pton(AF_INET, host.empty() ? "0.0.0.0" : host.c_str(), &endpoint.inetAddress.sin_addr) != 1) {
+        throw std::invalid_argument("Invalid IPv4 host in endpoint: " + text);
+    }
+    return endpoint;
+}
+
+const sockaddr* address(const Endpoint& endpoint)
+{
+    return endpoint.isUnix ? reinterpret_cast<const sockaddr*>(&endpoint.unixAddress)
+                           : reinterpret_cast<const sockaddr*>(&endpoint.inetAddress);
+}
+
+socklen_t addressLength(const Endpoint& endpoint)
+{
+    return endpoint.isUnix ? sizeof(endpoint.unixAddress) : sizeof(endpoint.inetAddress);
+}
+
+void setNoDelay(int fd, const Endpoint& endpoint)
+{
+    if (!endpoint.isUnix) {
+        int nodelay = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+    }
+}
+
+bool sendAll(int fd, const char* data, std::size_t size)
+{
+    while (size > 0) {
+        const ssize_t sent = send(fd, data, size, MSG_NOSIGNAL);
+        if (sent < 0 && errno == EINTR) {
+            continue;
+        }
+        if (sent <= 0) {
+            return false;
+        }
+        data += sent;
+        size -= static_cast<std::size_t>(sent);
+    }
+    return true;
+}
+
+} // namespace
+
+ReplicationPrimary::ReplicationPrimary(std::string endpoint,
+                                       ReplicationMode mode,
+                                       std::chrono::microseconds ackTimeout,
+                                       std::size_t retainedCommands)
+    : endpoint_(std::move(endpoint))
+    , mode_(mode)
+    , ackTimeout_(ackTimeout)
+    , retainedCommands_(retainedCommands)
+{
+}
+
+ReplicationPrimary::~ReplicationPrimary()
+{
+    stop();
+}
+
+void ReplicationPrimary::start()
+{
+    const Endpoint endpoint = parseEndpoint(endpoint_);
+
+    listenFd_ = socket(endpoint.isUnix ? AF_UNIX : AF_INET, SOCK_STREAM, 0);
+    if (listenFd_ < 0) {
+        throw std::runtime_error("Replication socket creation failed");
+    }
+    if (endpoint.isUnix) {
+        unlink(endpoint.unixAddress.sun_path);
+    } else {
+        int opt = 1;
+        setsockopt(listenFd_, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+    }
+    if (bind(listenFd_, address(endpoint), addressLength(endpoint)) < 0 || listen(listenFd_, 1) < 0) {
+        close(listenFd_);
+        listenFd_ = -1;
+        throw std::runtime_error("Replication bind/listen failed on " + endpoint_);
+    }
+
+    wakeFd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    running_.store(true, std::memory_order_release);
+    streamThread_ = std::thread(&ReplicationPrimary::streamLoop, this);
+}
+
+void ReplicationPrimary::stop()
+{
+    if (!running_.exchange(false)) {
+        return;
+    }
+
+    if (wakeFd_ >= 0) {
+        const std::uint64_t one = 1;
+        [[maybe_unused]] const ssize_t written = write(wakeFd_, &one, sizeof(one));
+    }
+    if (streamThread_.joinable()) {
+        streamThread_.join();
+    }
+
+    dropStandby();
+    close(listenFd_);
+    close(wakeFd_);
+    listenFd_ = -1;
+    wakeFd_ = -1;
+    ackCv_.notify_all();
+}
+
+std::uint64_t ReplicationPrimary::publish(std::string_view command, SessionId session)
+{
+    std::uint64_t sequence = 0;
+    {
+        std::scoped_lock lock(journalMutex_);
+        sequence = publishedSequence_.load(std::memory_order_relaxed) + 1;
+        const std::uint32_t length = static_cast<std::uint32_t>(command.size());
+        journal_.append(reinterpret_cast<const char*>(&sequence), sizeof(sequence));
+        journal_.append(reinterpret_cast<const char*>(&session), sizeof(session));
+        journal_.append(reinterpret_cast<const char*>(&length), sizeof(length));
+        journal_.append(command);
+        publishedSequence_.store(sequence, std::memory_order_release);
+    }
+
+    // Only pay for a wakeup syscall when the streamer is actually asleep.
+    if (streamerSleeping_.load(std::memory_order_acquire)) {
+        const std::uint64_t one = 1;
+        [[maybe_unused]] const ssize_t written = write(wakeFd_, &one, sizeof(one));
+    }
+    return sequence;
+}
+
+bool ReplicationPrimary::waitForAck(std::uint64_t sequence)
+{
+    if (ackedSequence() >= sequence) {
+        return true;
+    }
+    if (!standbyAttached()) {
+        return false;
+    }
+
+    std::unique_lock lock(ackMutex_);
+    return ackCv_.wait_for(lock, ackTimeout_, [&] {
+        return ackedSequence() >= sequence || !running_.load(std::memory_order_acquire);
+    }) && ackedSequence() >= sequence;
+}
+
+void ReplicationPrimary::streamLoop()
+{
+    std::vector<char> chunk;
+    chunk.reserve(kStreamChunkBytes);
+
+    while (running_.load(std::memory_order_acquire)) {
+        trimJournal();
+        if (!standbyAttached() && !acceptStandby()) {
+            continue;
+        }
+
+        chunk.clear();
+        {
+            std::scoped_lock lock(journalMutex_);
+            const std::size_t pending = journal_.size() - sentOffset_;
+            const std::size_t take = std::min(pending, kStreamChunkBytes);
+            chunk.insert(chunk.end(), journal_.data() + sentOffset_, journal_.data() + sentOffset_ + take);
+        }
+
+        if (!chunk.empty()) {
+            if (!sendAll(standbyFd_.load(), chunk.data(), chunk.size())) {
+                dropStandby();
+                continue;
+            }
+            sentOffset_ += chunk.size();
+            readAcks();
+            continue;
+        }
+
+        // Idle: advertise that we sleep, then re-check so a concurrent publish is not missed.
+        streamerSleeping_.store(true, std::memory_order_release);
+        bool pending = false;
+        {
+            std::scoped_lock lock(journalMutex_);
+            pending = journal_.size() > sentOffset_;
+        }
+        if (!pending) {
+            pollfd fds[2];
+            fds[0] = pollfd{standbyFd_.load(), POLLIN, 0};
+            fds[1] = pollfd{wakeFd_, POLLIN, 0};
+            poll(fds, 2, kIdlePollMs);
+            if (fds[1].revents & POLLIN) {
+                std::uint64_t value = 0;
+                [[maybe_unused]] const ssize_t drained = read(wakeFd_, &value, sizeof(value));
+            }
+        }
+        streamerSleeping_.store(false, std::memory_order_release);
+        readAcks();
+    }
+}
+
+void ReplicationPrimary::trimJournal()
+{
+    // Keep everything the attached standby has not acked, plus the retention window.
+    const std::uint64_t bound = standbyAttached() ? ackedSequence() : publishedSequence();
+    if (bound <= retainedCommands_) {
+        return;
+    }
+    const std::uint64_t trimThrough = bound - retainedCommands_;
+
+    std::scoped_lock lock(journalMutex_);
+    while (trimSequence_ < trimThrough && journal_.size() - trimOffset_ >= kFrameHeaderBytes) {
+        std::uint32_t length = 0;
+        std::memcpy(&trimSequence_, journal_.data() + trimOffset_, sizeof(trimSequence_));
+        std::memcpy(&length, journal_.data() + trimOffset_ + sizeof(std::uint64_t) + sizeof(SessionId), sizeof(length));
+        trimOffset_ += kFrameHeaderBytes + length;
+    }
+
+    // Erase only once the dead prefix is large, so the memmove is paid rarely.
+    if (trimOffset_ < kStreamChunkBytes || trimOffset_ < journal_.size() / 2) {
+        return;
+    }
+    journal_.erase(0, trimOffset_);
+    sentOffset_ -= std::min(sentOffset_, trimOffset_);
+    trimOffset_ = 0;
+    firstJournaledSequence_.store(trimSequence_ + 1, std::memory_order_release);
+}
+
+bool ReplicationPrimary::acceptStandby()
+{
+    pollfd fds[2];
+    fds[0] = pollfd{listenFd_, POLLIN, 0};
+    fds[1] = pollfd{wakeFd_, POLLIN, 0};
+    if (poll(fds, 2, kIdlePollMs) <= 0 || !(fds[0].revents & POLLIN)) {
+        return false;
+    }
+
+    const int fd = accept(listenFd_, nullptr, nullptr);
+    if (fd < 0) {
+        return false;
+    }
+    setNoDelay(fd, parseEndpoint(endpoint_));
+
+    // A newly attached standby starts from an empty book, so replay the whole
+    // journal. If it was trimmed, the standby sees the gap and refuses to serve.
+    sentOffset_ = 0;
+    ackBuffer_.clear();
+    ackedSequence_.store(0, std::memory_order_release);
+    standbyFd_.store(fd, std::memory_order_release);
+    return true;
+}
+
+void ReplicationPrimary::readAcks()
+{
+    const int fd = standbyFd_.load();
+    if (fd < 0) {
+        return;
+    }
+
+    char buffer[4096];
+    while (true) {
+        const ssize_t bytes = recv(fd, buffer, sizeof(buffer), MSG_DONTWAIT);
+        if (bytes < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        }
+        if (bytes < 0 && errno == EINTR) {
+            continue;
+        }
+        if (bytes <= 0) {
+            dropStandby();
+            return;
+        }
+        ackBuffer_.append(buffer, static_cast<std::size_t>(bytes));
+    }
+
+    const std::size_t complete = ackBuffer_.size() / sizeof(std::uint64_t);
+    if (complete == 0) {
+        return;
+    }
+
+    // Acks are cumulative, so only the newest one matters.
+    std::uint64_t acked = 0;
+    std::memcpy(&acked, ackBuffer_.data() + (complete - 1) * sizeof(std::uint64_t), sizeof(acked));
+    ackBuffer_.erase(0, complete * sizeof(std::uint64_t));
+
+    {
+        std::scoped_lock lock(ackMutex_);
+        ackedSequence_.store(std::max(acked, ackedSequence()), std::memory_order_release);
+    }
+    ackCv_.notify_all();
+}
+
+void ReplicationPrimary::dropStandby()
+{
+    const int fd = standbyFd_.exchange(-1);
+    if (fd >= 0) {
+        close(fd);
+    }
+    ackCv_.notify_all();
+}
+
+ReplicationStandby::ReplicationStandby(std::string endpoint, Orderbook& orderbook, std::size_t maxCommandsPerAck)
+    : endpoint_(std::move(endpoint))
+    , orderbook_(orderbook)
+    , maxCommandsPerAck_(std::max<std::size_t>(1, maxCommandsPerAck))
+{
+}
+
+std::uint64_t ReplicationStandby::run(std::chrono::milliseconds connectTimeout)
+{
+    const Endpoint endpoint = parseEndpoint(endpoint_);
+    const auto deadline = std::chrono::steady_clock::now() + connectTimeout;
+
+    int fd = -1;
+    while (true) {
+        fd = socket(endpoint.isUnix ? AF_UNIX : AF_INET, SOCK_STREAM, 0);
+        if (fd < 0) {
+            throw std::runtime_error("Replication socket creation failed");
+        }
+        if (connect(fd, address(endpoint), addressLength(endpoint)) == 0) {
+            break;
+        }
+        close(fd);
+        if (std::chrono::steady_clock::now() >= deadline) {
+            throw std::runtime_error("Could not reach primary at " + endpoint_);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    setNoDelay(fd, endpoint);
+
+    std::string buffer;
+    char readBuffer[64 * 1024];
+    std::size_t sinceAck = 0;
+
+    while (true) {
+        const ssize_t bytes = recv(fd, readBuffer, sizeof(readBuffer), 0);
+        if (bytes < 0 && errno == EINTR) {
+            continue;
+        }
+        if (bytes <= 0) {
+            break; // Primary is gone: the caller takes over.
+        }
+        buffer.append(readBuffer, static_cast<std::size_t>(bytes));
+
+        std::size_t offset = 0;
+        bool ok = true;
+        std::uint64_t unexpected = 0;
+        while (buffer.size() - offset >= kFrameHeaderBytes) {
+            std::uint64_t sequence = 0;
+            SessionId session = kNoSession;
+            std::uint32_t length = 0;
+            std::memcpy(&sequence, buffer.data() + offset, sizeof(sequence));
+            std::memcpy(&session, buffer.data() + offset + sizeof(sequence), sizeof(session));
+            std::memcpy(&length, buffer.data() + offset + sizeof(sequence) + sizeof(session), sizeof(length));
+            if (buffer.size() - offset - kFrameHeaderBytes < length) {
+                break;
+            }
+
+            const std::uint64_t expected = appliedSequence() + 1;
+            if (sequence != expected) {
+                unexpected = sequence;
+                break;
+            }
+
+            orderbook_.processFixMessage(std::string_view(buffer.data() + offset + kFrameHeaderBytes, length), session);
+            appliedSequence_.store(sequence, std::memory_order_release);
+            offset += kFrameHeaderBytes + length;
+
+            if (++sinceAck >= maxCommandsPerAck_) {
+                ok = sendAck(fd, sequence);
+                sinceAck = 0;
+            }
+        }
+        buffer.erase(0, offset);
+        if (unexpected != 0) {
+            // The stream must be gap-free. Acking what was applied would let the
+            // primary believe a standby exists that can take over; it cannot.
+            close(fd);
+            throw ReplicationDivergence("Replication stream from " + endpoint_ + " jumped from sequence " +
+                                        std::to_string(appliedSequence()) + " to " + std::to_string(unexpected));
+        }
+
+        // One ack per read burst keeps the primary's semi-sync wait short without
+        // a round trip per command.
+        if (ok && sinceAck > 0) {
+            ok = sendAck(fd, appliedSequence());
+            sinceAck = 0;
+        }
+        if (!ok) {
+            break;
+        }
+    }
+
+    close(fd);
+    return appliedSequence();
+}
+
+bool ReplicationStandby::sendAck(int fd, std::uint64_t sequence)
+{
+    return sendAll(fd, reinterpret_cast<const char*>(&sequence), sizeof(sequence));
+}
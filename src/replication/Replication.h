@@ -0,0 +1,136 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#include "Orderbook.h"
+
+// Hot-standby replication of the sequenced inbound command stream.
+//
+// The primary assigns every command it applies a sequence number and streams
+// it to one standby over a Unix ("unix:/path") or TCP ("host:port") socket.
+// The standby applies the commands in order through processFixMessage, under
+// the same owning session, which is deterministic, so its books end up identical. Acks are batched: the standby
+// acknowledges the last applied sequence once per read burst rather than once
+// per command.
+//
+// The primary keeps a bounded journal: commands the standby has acked are
+// dropped once they fall more than retainedCommands behind, and without a
+// standby only the newest retainedCommands are kept. A standby always starts
+// from an empty book, so one attaching after the journal was trimmed cannot
+// catch up; it reports ReplicationDivergence instead of serving a partial book.
+//
+// Wire format, host byte order:
+//   primary -> standby : [u64 sequence][u32 session][u32 length][length bytes of FIX]
+//   standby -> primary : [u64 last applied sequence]
+
+enum class ReplicationMode {
+    Async,    // Never wait for the standby.
+    SemiSync, // Wait (bounded by ackTimeout) for the standby to ack before replying.
+};
+
+// Thrown by ReplicationStandby::run when the stream skips or repeats a
+// sequence. The standby's book no longer matches the primary's, so it must not
+// take over.
+class ReplicationDivergence : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+class ReplicationPrimary {
+public:
+    static constexpr std::size_t kDefaultRetainedCommands = std::size_t{1} << 20;
+
+    ReplicationPrimary(std::string endpoint,
+                       ReplicationMode mode,
+                       std::chrono::microseconds ackTimeout = std::chrono::milliseconds(1),
+                       std::size_t retainedCommands = kDefaultRetainedCommands);
+    ~ReplicationPrimary();
+
+    ReplicationPrimary(const ReplicationPrimary&) = delete;
+    ReplicationPrimary& operator=(const ReplicationPrimary&) = delete;
+
+    // Binds the endpoint and starts the streaming thread. Throws std::runtime_error on failure.
+    void start();
+    void stop();
+
+    // Appends a command to the journal and returns its sequence number. Callers
+    // must publish in the same order they applied commands to the Orderbook.
+    std::uint64_t publish(std::string_view command, SessionId session = kNoSession);
+
+    // Semi-sync wait. Returns false on timeout or when no standby is attached.
+    bool waitForAck(std::uint64_t sequence);
+
+    ReplicationMode mode() const { return mode_; }
+    std::uint64_t publishedSequence() const { return publishedSequence_.load(std::memory_order_acquire); }
+    std::uint64_t ackedSequence() const { return ackedSequence_.load(std::memory_order_acquire); }
+    bool standbyAttached() const { return standbyFd_.load(std::memory_order_acquire) >= 0; }
+    // Oldest sequence still in the journal (publishedSequence() + 1 when empty).
+    std::uint64_t firstJournaledSequence() const { return firstJournaledSequence_.load(std::memory_order_acquire); }
+
+private:
+    void streamLoop();
+    void trimJournal();
+    bool acceptStandby();
+    void readAcks();
+    void dropStandby();
+
+    const std::string endpoint_;
+    const ReplicationMode mode_;
+    const std::chrono::microseconds ackTimeout_;
+    const std::size_t retainedCommands_;
+
+    int listenFd_ = -1;
+    int wakeFd_ = -1;
+    std::atomic<int> standbyFd_{-1};
+    std::thread streamThread_;
+    std::atomic<bool> running_{false};
+    std::atomic<bool> streamerSleeping_{false};
+
+    // Starts at sequence 1 until the first trim, so a standby attaching late can
+    // still replay everything.
+    std::mutex journalMutex_;
+    std::string journal_;
+    std::size_t sentOffset_ = 0; // stream thread only
+    // Frames before trimOffset_ (up to trimSequence_) may be dropped; they are
+    // erased in bulk so trimming stays amortised O(1) per byte. Stream thread only.
+    std::size_t trimOffset_ = 0;
+    std::uint64_t trimSequence_ = 0;
+    std::atomic<std::uint64_t> firstJournaledSequence_{1};
+    std::atomic<std::uint64_t> publishedSequence_{0};
+
+    std::mutex ackMutex_;
+    std::condition_variable ackCv_;
+    std::atomic<std::uint64_t> ackedSequence_{0};
+    std::string ackBuffer_;
+};
+
+class ReplicationStandby {
+public:
+    ReplicationStandby(std::string endpoint, Orderbook& orderbook, std::size_t maxCommandsPerAck = 256);
+
+    // Connects (retrying until connectTimeout) and applies commands until the
+    // primary goes away. Returns the last applied sequence; the caller can then
+    // take over the primary's listening port with identical book state. Throws
+    // ReplicationDivergence when the stream is not gap-free, in which case the
+    // caller must not take over.
+    std::uint64_t run(std::chrono::milliseconds connectTimeout);
+
+    std::uint64_t appliedSequence() const { return appliedSequence_.load(std::memory_order_acquire); }
+
+private:
+    bool sendAck(int fd, std::uint64_t sequence);
+
+    const std::string endpoint_;
+    Orderbook& orderbook_;
+    const std::size_t maxCommandsPerAck_;
+    std::atomic<std::uint64_t> appliedSequence_{0};
+};
@@ -0,0 +1,232 @@
+#include "Connection.h"
+
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+
+namespace {
+
+constexpr std::size_t kMaxIovecsPerWrite = 64;
+
+} // namespace
+
+Connection::Connection(int socketFd, ConnectionId id, const BackpressureConfig& config, ServerMetrics& metrics)
+    : socketFd_(socketFd)
+    , id_(id)
+    , config_(config)
+    , metrics_(metrics)
+    , wakeFd_(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC))
+    , tokens_(static_cast<double>(config.inboundBurst))
+    , lastRefill_(std::chrono::steady_clock::now())
+{
+    metrics_.connectionsAccepted.fetch_add(1, std::memory_order_relaxed);
+    metrics_.connectionsOpen.fetch_add(1, std::memory_order_relaxed);
+}
+
+Connection::~Connection()
+{
+    close();
+    ::close(socketFd_);
+    if (wakeFd_ >= 0) {
+        ::close(wakeFd_);
+    }
+    metrics_.connectionsOpen.fetch_sub(1, std::memory_order_relaxed);
+}
+
+bool Connection::enqueue(std::string_view message, bool wakeOwner)
+{
+    if (message.empty()) {
+        return true;
+    }
+
+    bool signal = false;
+    {
+        std::scoped_lock lock(mutex_);
+        if (closed_) {
+            return false;
+        }
+
+        if (queuedBytes_ + message.size() > config_.maxOutboundBytes && !makeRoomLocked(message.size())) {
+            return false;
+        }
+
+        signal = wakeOwner && outbound_.empty();
+        outbound_.emplace_back(message);
+        queuedBytes_ += message.size();
+        metrics_.outboundQueuedBytes.fetch_add(message.size(), std::memory_order_relaxed);
+        metrics_.raiseHighWatermark(queuedBytes_);
+    }
+
+    if (signal && wakeFd_ >= 0) {
+        const std::uint64_t one = 1;
+        [[maybe_unused]] const ssize_t written = ::write(wakeFd_, &one, sizeof(one));
+    }
+    return true;
+}
+
+bool Connection::makeRoomLocked(std::size_t incoming)
+{
+    switch (config_.overflowPolicy) {
+    case OverflowPolicy::Disconnect:
+        metrics_.overflowDisconnects.fetch_add(1, std::memory_order_relaxed);
+        closeLocked();
+        return false;
+
+    case OverflowPolicy::Conflate: {
+        // Never drop a message that is already partly on the wire.
+        const std::size_t keep = frontOffset_ > 0 ? 1 : 0;
+        while (outbound_.size() > keep && queuedBytes_ + incoming > config_.maxOutboundBytes) {
+            auto victim = outbound_.begin() + static_cast<std::ptrdiff_t>(keep);
+            queuedBytes_ -= victim->size();
+            metrics_.outboundQueuedBytes.fetch_sub(victim->size(), std::memory_order_relaxed);
+            metrics_.conflatedMessages.fetch_add(1, std::memory_order_relaxed);
+            outbound_.erase(victim);
+        }
+        if (queuedBytes_ + incoming > config_.maxOutboundBytes) {
+            metrics_.overflowDisconnects.fetch_add(1, std::memory_order_relaxed);
+            closeLocked();
+            return false;
+        }
+        return true;
+    }
+
+    case OverflowPolicy::PauseReading:
+        if (!readPaused_) {
+            readPaused_ = true;
+            metrics_.readPauses.fetch_add(1, std::memory_order_relaxed);
+        }
+        // Reading is paused, so only other sessions' pushes can still grow the queue;
+        // past twice the bound the client is considered dead.
+        if (queuedBytes_ + incoming > 2 * config_.maxOutboundBytes) {
+            metrics_.overflowDisconnects.fetch_add(1, std::memory_order_relaxed);
+            closeLocked();
+            return false;
+        }
+        return true;
+    }
+    return false;
+}
+
+bool Connection::flush()
+{
+    std::scoped_lock lock(mutex_);
+
+    std::array<iovec, kMaxIovecsPerWrite> iov;
+    while (!outbound_.empty() && !closed_) {
+        std::size_t count = 0;
+        for (auto it = outbound_.begin(); it != outbound_.end() && count < iov.size(); ++it, ++count) {
+            const std::size_t offset = count == 0 ? frontOffset_ : 0;
+            iov[count].iov_base = it->data() + offset;
+            iov[count].iov_len = it->size() - offset;
+        }
+
+        msghdr msg{};
+        msg.msg_iov = iov.data();
+        msg.msg_iovlen = count;
+        const ssize_t sent = ::sendmsg(socketFd_, &msg, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            }
+            closeLocked();
+            return false;
+        }
+
+        std::size_t remaining = static_cast<std::size_t>(sent);
+        queuedBytes_ -= remaining;
+        metrics_.outboundQueuedBytes.fetch_sub(remaining, std::memory_order_relaxed);
+        metrics_.outboundBytesSent.fetch_add(remaining, std::memory_order_relaxed);
+        while (remaining > 0) {
+            const std::size_t frontLeft = outbound_.front().size() - frontOffset_;
+            if (remaining < frontLeft) {
+                frontOffset_ += remaining;
+                break;
+            }
+            remaining -= frontLeft;
+            outbound_.pop_front();
+            frontOffset_ = 0;
+        }
+    }
+
+    if (readPaused_ && queuedBytes_ <= config_.maxOutboundBytes / 2) {
+        readPaused_ = false;
+    }
+    return !closed_;
+}
+
+bool Connection::admitInbound(std::chrono::steady_clock::time_point now)
+{
+    if (config_.maxInboundPerSecond == 0) {
+        return true;
+    }
+
+    const std::chrono::duration<double> elapsed = now - lastRefill_;
+    lastRefill_ = now;
+    tokens_ = std::min(static_cast<double>(config_.inboundBurst),
+                       tokens_ + elapsed.count() * static_cast<double>(config_.maxInboundPerSecond));
+    if (tokens_ < 1.0) {
+        metrics_.rateLimitedMessages.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    tokens_ -= 1.0;
+    return true;
+}
+
+void Connection::drainWakeups()
+{
+    std::uint64_t value = 0;
+    while (wakeFd_ >= 0 && ::read(wakeFd_, &value, sizeof(value)) > 0) {
+    }
+}
+
+void Connection::close()
+{
+    std::scoped_lock lock(mutex_);
+    closeLocked();
+}
+
+void Connection::closeLocked()
+{
+    if (closed_) {
+        return;
+    }
+    closed_ = true;
+    metrics_.outboundQueuedBytes.fetch_sub(queuedBytes_, std::memory_order_relaxed);
+    queuedBytes_ = 0;
+    outbound_.clear();
+    frontOffset_ = 0;
+    // Wakes the owning thread out of poll/recv; the descriptor is closed in the destructor.
+    ::shutdown(socketFd_, SHUT_RDWR);
+}
+
+bool Connection::closed() const
+{
+    std::scoped_lock lock(mutex_);
+    return closed_;
+}
+
+bool Connection::readPaused() const
+{
+    std::scoped_lock lock(mutex_);
+    return readPaused_;
+}
+
+bool Connection::hasPendingOutput() const
+{
+    std::scoped_lock lock(mutex_);
+    return !outbound_.empty();
+}
+
+std::size_t Connection::queuedBytes() const
+{
+    std::scoped_lock lock(mutex_);
+    return queuedBytes_;
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+#include "ServerMetrics.h"
+
+using ConnectionId = std::uint32_t;
+
+enum class OverflowPolicy {
+    Disconnect,   // Drop the connection once its outbound queue is full.
+    Conflate,     // Drop the oldest unsent messages so the newest ones fit.
+    PauseReading, // Stop reading the client's requests until its queue drains.
+};
+
+struct BackpressureConfig {
+    std::size_t maxOutboundBytes = 1024 * 1024;
+    OverflowPolicy overflowPolicy = OverflowPolicy::Disconnect;
+    std::uint32_t maxInboundPerSecond = 0; // 0 = unlimited
+    std::uint32_t inboundBurst = 1024;
+};
+
+// One client socket with a bounded outbound queue.
+//
+// Any thread may enqueue; enqueue never blocks and never writes to the socket.
+// The owning client thread drains the queue with non-blocking writes when the
+// socket is writable, so a slow reader only ever costs memory up to the bound
+// and never stalls the producer (or the matching path behind it).
+class Connection {
+public:
+    Connection(int socketFd, ConnectionId id, const BackpressureConfig& config, ServerMetrics& metrics);
+    ~Connection();
+
+    Connection(const Connection&) = delete;
+    Connection& operator=(const Connection&) = delete;
+
+    ConnectionId id() const { return id_; }
+    int socketFd() const { return socketFd_; }
+    int wakeFd() const { return wakeFd_; } // readable when another thread queued data
+
+    // Thread-safe, never blocks. Other threads pass wakeOwner so the owning thread
+    // notices data it did not queue itself. Returns false if the connection is closed
+    // (including when the overflow policy just closed it).
+    bool enqueue(std::string_view message, bool wakeOwner = false);
+
+    // Owner thread only. Writes until the queue is empty or the socket would block.
+    // Returns false once the peer is gone.
+    bool flush();
+
+    // Owner thread only. Token bucket over inbound frames.
+    bool admitInbound(std::chrono::steady_clock::time_point now);
+
+    void drainWakeups();
+    void close();
+
+    bool closed() const;
+    bool readPaused() const;
+    bool hasPendingOutput() const;
+    std::size_t queuedBytes() const;
+
+private:
+    bool makeRoomLocked(std::size_t incoming);
+    void closeLocked();
+
+    const int socketFd_;
+    const ConnectionId id_;
+    const BackpressureConfig config_;
+    ServerMetrics& metrics_;
+    int wakeFd_ = -1;
+
+    mutable std::mutex mutex_;
+    std::deque<std::string> outbound_;
+    std::size_t frontOffset_ = 0; // bytes of outbound_.front() already written
+    std::size_t queuedBytes_ = 0;
+    bool readPaused_ = false;
+    bool closed_ = false;
+
+    double tokens_ = 0.0;
+    std::chrono::steady_clock::time_point lastRefill_{};
+};
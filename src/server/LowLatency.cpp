@@ -0,0 +1,108 @@
+#include "LowLatency.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+
+#include <alloca.h>
+#include <charconv>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+
+namespace {
+
+int parseCpu(std::string_view text)
+{
+    int cpu = -1;
+    const char* begin = text.data();
+    const char* end = begin + text.size();
+    const auto [ptr, ec] = std::from_chars(begin, end, cpu);
+    if (ec != std::errc() || ptr != end || cpu < 0) {
+        throw std::invalid_argument("Invalid CPU in list: '" + std::string(text) + "'");
+    }
+    return cpu;
+}
+
+} // namespace
+
+std::vector<int> parseCpuList(std::string_view text)
+{
+    std::vector<int> cpus;
+    while (!text.empty()) {
+        const std::size_t comma = text.find(',');
+        const std::string_view item = text.substr(0, comma);
+        text = comma == std::string_view::npos ? std::string_view{} : text.substr(comma + 1);
+        if (item.empty()) {
+            continue;
+        }
+
+        const std::size_t dash = item.find('-');
+        if (dash == std::string_view::npos) {
+            cpus.push_back(parseCpu(item));
+            continue;
+        }
+
+        const int first = parseCpu(item.substr(0, dash));
+        const int last = parseCpu(item.substr(dash + 1));
+        if (last < first) {
+            throw std::invalid_argument("Invalid CPU range: '" + std::string(item) + "'");
+        }
+        for (int cpu = first; cpu <= last; ++cpu) {
+            cpus.push_back(cpu);
+        }
+    }
+    return cpus;
+}
+
+bool pinCurrentThread(int cpu)
+{
+    if (cpu < 0 || cpu >= CPU_SETSIZE) {
+        return false;
+    }
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+bool lockProcessMemory()
+{
+    return mlockall(MCL_CURRENT | MCL_FUTURE) == 0;
+}
+
+void prefaultStack(std::size_t stackBytes)
+{
+    // Touch the stack one page at a time so it is resident before the hot loop.
+    auto* stack = static_cast<volatile char*>(alloca(stackBytes));
+    for (std::size_t i = 0; i < stackBytes; i += 4096) {
+        stack[i] = 0;
+    }
+}
+
+bool lockAndPrefaultMemory(std::size_t stackBytes)
+{
+    const bool locked = lockProcessMemory();
+    prefaultStack(stackBytes);
+    return locked;
+}
+
+bool applyBusyPollSocketOptions(int socketFd, int busyPollUs, int incomingCpu)
+{
+    bool ok = true;
+#ifdef SO_BUSY_POLL
+    if (busyPollUs > 0 &&
+        setsockopt(socketFd, SOL_SOCKET, SO_BUSY_POLL, &busyPollUs, sizeof(busyPollUs)) < 0) {
+        ok = false;
+    }
+#endif
+#ifdef SO_INCOMING_CPU
+    if (incomingCpu >= 0 &&
+        setsockopt(socketFd, SOL_SOCKET, SO_INCOMING_CPU, &incomingCpu, sizeof(incomingCpu)) < 0) {
+        ok = false;
+    }
+#endif
+    return ok;
+}
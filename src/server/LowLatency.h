@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+// Low-latency run mode: core pinning, busy polling and locked memory.
+// Every helper degrades gracefully (returns false) when the kernel or the
+// process limits refuse a setting, so the server still runs without privileges.
+struct LowLatencyConfig {
+    std::vector<int> cpus;       // Cores to pin to, assigned round-robin. Empty = no pinning.
+    bool busySpin = false;       // Spin on non-blocking recv instead of sleeping in the kernel.
+    int socketBusyPollUs = 50;   // SO_BUSY_POLL budget when busySpin is on.
+    bool lockMemory = false;     // mlockall once at startup, prefault each hot thread's stack.
+
+    bool enabled() const { return !cpus.empty() || busySpin || lockMemory; }
+    int cpuFor(std::size_t slot) const { return cpus.empty() ? -1 : cpus[slot % cpus.size()]; }
+};
+
+// Parses "2,4-6" style lists. Throws std::invalid_argument on malformed input.
+std::vector<int> parseCpuList(std::string_view text);
+
+bool pinCurrentThread(int cpu);
+
+// mlockall(MCL_CURRENT | MCL_FUTURE). Process-wide, so call it once at startup,
+// not from every thread.
+bool lockProcessMemory();
+
+// Touches stackBytes of the calling thread's stack so the first real message
+// does not take page faults. Per thread.
+void prefaultStack(std::size_t stackBytes = 256 * 1024);
+
+// Both of the above, for a single-threaded program.
+bool lockAndPrefaultMemory(std::size_t stackBytes = 256 * 1024);
+
+// SO_BUSY_POLL and SO_INCOMING_CPU steering for a connected socket.
+bool applyBusyPollSocketOptions(int socketFd, int busyPollUs, int incomingCpu);
+
+inline void cpuRelax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
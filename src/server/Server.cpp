@@ -1,16 +1,59 @@
 #include "Server.h"
 
 #include <sys/socket.h>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <poll.h>
 #include <netinet/in.h>
 #include <netinet/tcp.h>
 #include <unistd.h>
+#include <cerrno>
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <chrono>
 #include <iostream>
 #include <cstring>
 #include <thread>
 #include <string_view>
+#include <utility>
 
-Server::Server(int port, Orderbook* orderbook)
-    : port_(port), orderbook_(orderbook) {}
+#include <nlohmann/json.hpp>
+
+namespace {
+
+constexpr std::string_view kThrottledResponse = "THROTTLED";
+constexpr std::string_view kMetricsCommand = "METRICS";
+constexpr std::string_view kStatsCommand = "STATS";
+constexpr std::string_view kTapeCommand = "TAPE ";
+// Sent through the normal command path so a standby cancels the same orders.
+constexpr std::string_view kCancelOnDisconnectFrame = "8=FIX.4.2|35=q|530=7|";
+constexpr std::uint64_t kMillisPerMinute = 60'000;
+constexpr std::uint64_t kMillisPerDay = 24 * 60 * kMillisPerMinute;
+
+// Clock tick replayed by a standby; 59=0 marks the end-of-day sweep.
+std::string clockFrame(std::uint64_t nowMs, bool endOfDay) {
+    std::string frame = "8=FIX.4.2|35=U|60=" + std::to_string(nowMs) + "|";
+    if (endOfDay) {
+        frame += "59=0|";
+    }
+    return frame;
+}
+
+} // namespace
+
+Server::Server(int port, Orderbook* orderbook, LowLatencyConfig lowLatency, BackpressureConfig backpressure)
+    : port_(port), orderbook_(orderbook), lowLatency_(std::move(lowLatency)), backpressure_(backpressure) {}
+
+void Server::enterLowLatencyMode(int cpu, const char* threadName) {
+    if (cpu >= 0 && !pinCurrentThread(cpu)) {
+        std::cerr << threadName << ": failed to pin to CPU " << cpu << "\n";
+    }
+    // mlockall itself is process-wide and done once at startup; only the stack is per thread.
+    if (lowLatency_.lockMemory) {
+        prefaultStack();
+    }
+}
 
 void Server::run() {
     // Notes:
@@ -60,6 +103,14 @@ void Server::run() {
 
     std::cout << "Server listening on port " << port_ << std::endl;
 
+    // The accept thread stays unpinned: it is off the hot path and would
+    // otherwise share a core with a client thread.
+    if (lowLatency_.enabled()) {
+        std::cout << "Low-latency mode: " << lowLatency_.cpus.size() << " pinned CPU(s)"
+                  << (lowLatency_.busySpin ? ", busy-spin recv" : "")
+                  << (lowLatency_.lockMemory ? ", mlockall" : "") << std::endl;
+    }
+
     while (true) {
         int client_fd = accept(server_fd, nullptr, nullptr);
         if (client_fd < 0) {
@@ -75,16 +126,41 @@ void Server::run() {
             continue;
         }
 
-        std::thread(&Server::handleClient, this, client_fd).detach();
+        const int cpu = lowLatency_.cpuFor(nextClientSlot_++);
+        if (lowLatency_.busySpin && !applyBusyPollSocketOptions(client_fd, lowLatency_.socketBusyPollUs, cpu)) {
+            std::cerr << "setsockopt(SO_BUSY_POLL/SO_INCOMING_CPU) failed, continuing without\n";
+        }
+
+        std::thread(&Server::handleClient, this, client_fd, cpu).detach();
     }
 
     close(server_fd);
 }
 
-void Server::handleClient(int clientSocket) {
+void Server::handleClient(int clientSocket, int cpu) {
     constexpr std::size_t kReadBufferSize = 64 * 1024;
     constexpr std::size_t kMaxFrameBytes = 4 * 1024;
 
+    if (lowLatency_.enabled()) {
+        enterLowLatencyMode(cpu, "client thread");
+    }
+
+    // Writes never block: a client that stops reading fills its own bounded queue
+    // and is then handled by the overflow policy instead of stalling this thread.
+    const int socketFlags = fcntl(clientSocket, F_GETFL, 0);
+    if (socketFlags < 0 || fcntl(clientSocket, F_SETFL, socketFlags | O_NONBLOCK) < 0) {
+        std::cerr << "fcntl(O_NONBLOCK) failed\n";
+        close(clientSocket);
+        return;
+    }
+
+    const ConnectionId connectionId = nextConnectionId_.fetch_add(1, std::memory_order_relaxed);
+    auto connection = std::make_shared<Connection>(clientSocket, connectionId, backpressure_, metrics_);
+    {
+        std::scoped_lock lock(connectionsMutex_);
+        connections_.emplace(connectionId, connection);
+    }
+
     char readBuffer[kReadBufferSize];
     std::string receiveBuffer;
     std::string sendBuffer;
@@ -92,14 +168,54 @@ void Server::handleClient(int clientSocket) {
     sendBuffer.reserve(kReadBufferSize);
 
     while (true) {
-        const ssize_t bytesRead = recv(clientSocket, readBuffer, sizeof(readBuffer), 0);
+        const bool paused = connection->readPaused();
+
+        if (!lowLatency_.busySpin) {
+            pollfd fds[2];
+            fds[0].fd = clientSocket;
+            fds[0].events = static_cast<short>((paused ? 0 : POLLIN) | (connection->hasPendingOutput() ? POLLOUT : 0));
+            fds[0].revents = 0;
+            fds[1].fd = connection->wakeFd();
+            fds[1].events = POLLIN;
+            fds[1].revents = 0;
+            if (poll(fds, 2, -1) < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                break;
+            }
+            if (fds[1].revents & POLLIN) {
+                connection->drainWakeups();
+            }
+            if (fds[0].revents & (POLLERR | POLLNVAL)) {
+                break;
+            }
+        }
+
+        if (!connection->flush()) {
+            break;
+        }
+        if (paused) {
+            if (lowLatency_.busySpin) {
+                cpuRelax();
+            }
+            continue;
+        }
+
+        const ssize_t bytesRead = recv(clientSocket, readBuffer, sizeof(readBuffer), MSG_DONTWAIT);
+        if (bytesRead < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+            if (lowLatency_.busySpin) {
+                cpuRelax(); // Busy-spin: stay on-core instead of sleeping in the kernel.
+            }
+            continue;
+        }
         if (bytesRead <= 0) {
-            close(clientSocket);
-            return;
+            break;
         }
 
         receiveBuffer.append(readBuffer, static_cast<std::size_t>(bytesRead));
 
+        const auto now = std::chrono::steady_clock::now();
         std::size_t frameEnd = receiveBuffer.find('\n');
         while (frameEnd != std::string::npos) {
             std::string_view frame(receiveBuffer.data(), frameEnd);
@@ -108,8 +224,12 @@ void Server::handleClient(int clientSocket) {
             }
 
             if (!frame.empty()) {
-                const std::string response = orderbook_->processFixMessage(frame);
-                sendBuffer.append(response);
+                if (!connection->admitInbound(now)) {
+                    // Rejected before it reaches the matcher.
+                    sendBuffer.append(kThrottledResponse);
+                } else {
+                    dispatchCommand(frame, connectionId, sendBuffer);
+                }
                 sendBuffer.push_back('\n');
             }
 
@@ -118,28 +238,406 @@ void Server::handleClient(int clientSocket) {
         }
 
         if (!sendBuffer.empty()) {
-            sendMessage(clientSocket, sendBuffer);
+            awaitReplication();
+            if (!connection->enqueue(sendBuffer) || !connection->flush()) {
+                break;
+            }
             sendBuffer.clear();
         }
 
         if (receiveBuffer.size() > kMaxFrameBytes) {
-            close(clientSocket);
-            return;
+            break;
+        }
+    }
+
+    connection->close();
+    {
+        std::scoped_lock lock(connectionsMutex_);
+        connections_.erase(connectionId);
+    }
+    if (cancelOnDisconnect_) {
+        cancelSessionOnDisconnect(connectionId);
+    }
+}
+
+void Server::reserveSessionIds(SessionId highest) {
+    if (highest >= nextConnectionId_.load(std::memory_order_relaxed)) {
+        nextConnectionId_.store(highest + 1, std::memory_order_relaxed);
+    }
+}
+
+void Server::dispatchCommand(std::string_view frame, SessionId session, std::string& out) {
+    if (frame == kMetricsCommand) {
+        out.append(metricsJson());
+    } else if (frame == kStatsCommand) {
+        out.append(statsJson());
+    } else if (frame.rfind(kTapeCommand, 0) == 0) {
+        out.append(tapeJson(frame.substr(kTapeCommand.size())));
+    } else {
+        out.append(processCommand(frame, session));
+    }
+}
+
+std::string Server::processCommand(std::string_view frame, SessionId session) {
+    if (replication_ == nullptr) {
+        return orderbook_->processFixMessage(frame, session);
+    }
+
+    // The standby replays in sequence order, so apply and publish must be one step.
+    std::scoped_lock lock(sequencerMutex_);
+    std::string response = orderbook_->processFixMessage(frame, session);
+    replication_->publish(frame, session);
+    return response;
+}
+
+void Server::cancelSessionOnDisconnect(ConnectionId connectionId) {
+    if (orderbook_->sessionOrderCount(connectionId) == 0) {
+        return; // Nothing resting: skip the journal entry too.
+    }
+
+    const std::string response = processCommand(kCancelOnDisconnectFrame, connectionId);
+    const std::string_view prefix = Response::kMassCancelled;
+    std::uint64_t cancelled = 0;
+    if (response.size() > prefix.size() && response.compare(0, prefix.size(), prefix) == 0) {
+        std::from_chars(response.data() + prefix.size(), response.data() + response.size(), cancelled);
+    }
+    metrics_.ordersCancelledOnDisconnect.fetch_add(cancelled, std::memory_order_relaxed);
+}
+
+void Server::runExpiry(std::chrono::milliseconds tick, int endOfDayMinuteUtc) {
+    const auto epochMillis = [] {
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count());
+    };
+    const std::uint64_t endOfDayOffset = static_cast<std::uint64_t>(std::max(endOfDayMinuteUtc, 0)) * kMillisPerMinute;
+
+    // Starting after today's cutoff must not sweep until tomorrow's.
+    const std::uint64_t startMs = epochMillis();
+    std::uint64_t lastSweptDay = startMs / kMillisPerDay - (startMs % kMillisPerDay < endOfDayOffset ? 1 : 0);
+
+    while (true) {
+        std::this_thread::sleep_for(tick);
+        const std::uint64_t nowMs = epochMillis();
+
+        bool endOfDay = false;
+        if (endOfDayMinuteUtc >= 0 && nowMs / kMillisPerDay > lastSweptDay && nowMs % kMillisPerDay >= endOfDayOffset) {
+            endOfDay = true;
+            lastSweptDay = nowMs / kMillisPerDay;
+        }
+        expireOrders(nowMs, endOfDay);
+    }
+}
+
+void Server::expireOrders(std::uint64_t nowMs, bool endOfDay) {
+    Orderbook::ExpiredOrders expired;
+    {
+        std::unique_lock<std::mutex> sequencer;
+        if (replication_ != nullptr) {
+            sequencer = std::unique_lock<std::mutex>(sequencerMutex_);
+        }
+        orderbook_->expireOrders(nowMs, &expired);
+        if (endOfDay) {
+            orderbook_->cancelDayOrders(&expired);
+        }
+        // Quiet ticks are not journalled: when the standby's clock catches up on
+        // the next published tick it expires exactly the orders the primary did.
+        if (replication_ != nullptr && !expired.empty()) {
+            replication_->publish(clockFrame(nowMs, endOfDay), kNoSession);
+        }
+    }
+    if (expired.empty()) {
+        return;
+    }
+
+    awaitReplication();
+    for (const auto& order : expired) {
+        // UDP sessions and unowned orders have no connection; sendTo skips them.
+        sendTo(order.sessionId_, std::string(Response::kExpired) + std::to_string(order.orderId_) + "\n");
+    }
+    metrics_.ordersExpired.fetch_add(expired.size(), std::memory_order_relaxed);
+}
+
+void Server::awaitReplication() {
+    // One wait per batch of replies; the standby acks cumulatively.
+    if (replication_ != nullptr && replication_->mode() == ReplicationMode::SemiSync) {
+        replication_->waitForAck(replication_->publishedSequence());
+    }
+}
+
+bool Server::sendTo(ConnectionId connectionId, std::string_view message) {
+    std::shared_ptr<Connection> connection;
+    {
+        std::scoped_lock lock(connectionsMutex_);
+        auto it = connections_.find(connectionId);
+        if (it == connections_.end()) {
+            return false;
+        }
+        connection = it->second;
+    }
+    return connection->enqueue(message, true);
+}
+
+std::string Server::metricsJson() const {
+    const auto load = [](const std::atomic<std::uint64_t>& counter) {
+        return counter.load(std::memory_order_relaxed);
+    };
+
+    const nlohmann::json json = {
+        {"connections_accepted", load(metrics_.connectionsAccepted)},
+        {"connections_open", load(metrics_.connectionsOpen)},
+        {"outbound_queued_bytes", load(metrics_.outboundQueuedBytes)},
+        {"outbound_queue_high_watermark", load(metrics_.outboundQueueHighWatermark)},
+        {"outbound_bytes_sent", load(metrics_.outboundBytesSent)},
+        {"overflow_disconnects", load(metrics_.overflowDisconnects)},
+        {"conflated_messages", load(metrics_.conflatedMessages)},
+        {"read_pauses", load(metrics_.readPauses)},
+        {"rate_limited_messages", load(metrics_.rateLimitedMessages)},
+        {"orders_cancelled_on_disconnect", load(metrics_.ordersCancelledOnDisconnect)},
+        {"orders_expired", load(metrics_.ordersExpired)},
+    };
+    return json.dump();
+}
+
+std::string Server::statsJson() const {
+    const OrderbookMemoryStats stats = orderbook_->memoryStats();
+
+    nlohmann::json symbols = nlohmann::json::array();
+    for (const auto& symbol : stats.symbols) {
+        symbols.push_back({
+            {"symbol", symbol.symbolId},
+            {"bid_levels", symbol.bidLevels},
+            {"ask_levels", symbol.askLevels},
+            {"orders", symbol.orders},
+        });
+    }
+
+    const nlohmann::json json = {
+        {"total_bytes", stats.totalBytes()},
+        {"bytes", {
+            {"order_pool", stats.orderPoolBytes},
+            {"order_index", stats.orderIndexBytes},
+            {"control_blocks", stats.controlBlockBytes},
+            {"level_queues", stats.levelQueueBytes},
+            {"price_levels", stats.priceLevelBytes},
+            {"stops", stats.stopBytes},
+            {"sessions", stats.sessionBytes},
+            {"expiry_wheel", stats.expiryWheelBytes},
+            {"symbol_books", stats.symbolBookBytes},
+            {"top_of_book", stats.topOfBookBytes},
+            {"trade_tape", stats.tradeTapeBytes},
+            {"risk", stats.riskBytes},
+        }},
+        {"order_slots", {
+            {"slot_bytes", stats.orderSlotBytes},
+            {"reserved", stats.orderSlotsReserved},
+            {"live", stats.orderSlotsLive},
+            {"high_water", stats.orderSlotsHighWater},
+        }},
+        {"order_index_overflow", stats.orderIndexOverflowEntries},
+        {"resting_orders", stats.restingOrders},
+        {"price_levels", stats.priceLevels},
+        {"pending_stops", stats.pendingStops},
+        {"active_books", stats.activeBooks},
+        {"symbols", std::move(symbols)},
+    };
+    return json.dump();
+}
+
+std::string Server::tapeJson(std::string_view request) const {
+    const auto* tape = orderbook_->tradeTape();
+    const std::size_t split = request.find(' ');
+    if (tape == nullptr || split == std::string_view::npos) {
+        return std::string(Response::kErr);
+    }
+    const SymbolId symbolId = orderbook_->resolveSymbol(request.substr(0, split));
+    std::uint64_t windowMs = 0;
+    const std::string_view window = request.substr(split + 1);
+    const auto [end, ec] = std::from_chars(window.data(), window.data() + window.size(), windowMs);
+    if (symbolId == kInvalidSymbolId || ec != std::errc() || end != window.data() + window.size() || windowMs == 0) {
+        return std::string(Response::kErr);
+    }
+
+    const std::int64_t to = Orderbook::TradeTape::now() + 1;
+    const auto bar = tape->summarize(symbolId, to - static_cast<std::int64_t>(windowMs) * 1'000'000, to);
+    const nlohmann::json json = {
+        {"symbol", symbolId},
+        {"window_ms", windowMs},
+        {"trades", bar.trades},
+        {"volume", bar.volume},
+        {"vwap", bar.vwap()},
+        {"open", bar.open},
+        {"high", bar.high},
+        {"low", bar.low},
+        {"close", bar.close},
+    };
+    return json.dump();
+}
+
+void Server::runUdp(int udpPort) {
+    int udp_fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (udp_fd == -1) {
+        std::cerr << "UDP socket creation failed\n";
+        return;
+    }
+
+    int opt = 1;
+    if (setsockopt(udp_fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0) {
+        std::cerr << "setsockopt(SO_REUSEADDR) failed\n";
+        close(udp_fd);
+        return;
+    }
+
+    sockaddr_in address;
+    std::memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = INADDR_ANY;
+    address.sin_port = htons(udpPort);
+
+    if (bind(udp_fd, (struct sockaddr*)&address, sizeof(address)) < 0) {
+        std::cerr << "UDP bind failed\n";
+        close(udp_fd);
+        return;
+    }
+
+    const int cpu = lowLatency_.cpuFor(nextClientSlot_++);
+    if (lowLatency_.enabled()) {
+        enterLowLatencyMode(cpu, "udp thread");
+        if (lowLatency_.busySpin) {
+            applyBusyPollSocketOptions(udp_fd, lowLatency_.socketBusyPollUs, cpu);
         }
     }
+
+    std::cout << "UDP order entry listening on port " << udpPort << std::endl;
+
+    // One recvmmsg fills up to kBatchSize datagrams; their replies go out in one sendmmsg.
+    static std::array<std::array<char, Udp::kMaxDatagramBytes>, Udp::kBatchSize> rxBuffers;
+    std::array<std::string, Udp::kBatchSize> replies;
+    std::array<sockaddr_in, Udp::kBatchSize> peers;
+    std::array<iovec, Udp::kBatchSize> rxIov;
+    std::array<iovec, Udp::kBatchSize> txIov;
+    std::array<mmsghdr, Udp::kBatchSize> rxMsgs;
+    std::array<mmsghdr, Udp::kBatchSize> txMsgs;
+
+    for (std::size_t i = 0; i < Udp::kBatchSize; ++i) {
+        replies[i].reserve(Udp::kMaxDatagramBytes);
+        rxIov[i] = iovec{rxBuffers[i].data(), rxBuffers[i].size()};
+    }
+
+    const int recvFlags = lowLatency_.busySpin ? MSG_DONTWAIT : MSG_WAITFORONE;
+
+    while (true) {
+        for (std::size_t i = 0; i < Udp::kBatchSize; ++i) {
+            std::memset(&rxMsgs[i], 0, sizeof(mmsghdr));
+            rxMsgs[i].msg_hdr.msg_name = &peers[i];
+            rxMsgs[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+            rxMsgs[i].msg_hdr.msg_iov = &rxIov[i];
+            rxMsgs[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        const int received = recvmmsg(udp_fd, rxMsgs.data(), Udp::kBatchSize, recvFlags, nullptr);
+        if (received < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                cpuRelax();
+                continue;
+            }
+            if (errno == EINTR) {
+                continue;
+            }
+            std::cerr << "recvmmsg failed\n";
+            break;
+        }
+
+        const auto now = Udp::Sequencer::Clock::now();
+        for (int i = 0; i < received; ++i) {
+            const std::string_view datagram(rxBuffers[i].data(), rxMsgs[i].msg_len);
+            if (rxMsgs[i].msg_hdr.msg_flags & MSG_TRUNC) {
+                Udp::Sequencer::reject(datagram, replies[i]); // larger than kMaxDatagramBytes
+            } else {
+                const std::uint64_t peer = Udp::peerKey(peers[i].sin_addr.s_addr, peers[i].sin_port);
+                udpSequencer_.handle(
+                    datagram, peer, now, replies[i],
+                    [this](std::string_view frame, SessionId session) { return processCommand(frame, session); },
+                    [this](SessionId session) {
+                        if (cancelOnDisconnect_) {
+                            cancelSessionOnDisconnect(session);
+                        }
+                    });
+            }
+
+            txIov[i] = iovec{replies[i].data(), replies[i].size()};
+            std::memset(&txMsgs[i], 0, sizeof(mmsghdr));
+            txMsgs[i].msg_hdr.msg_name = &peers[i];
+            txMsgs[i].msg_hdr.msg_namelen = rxMsgs[i].msg_hdr.msg_namelen;
+            txMsgs[i].msg_hdr.msg_iov = &txIov[i];
+            txMsgs[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        // One wait for the whole batch: no reply leaves before the standby has it.
+        awaitReplication();
+
+        int sentTotal = 0;
+        while (sentTotal < received) {
+            const int sent = sendmmsg(udp_fd, txMsgs.data() + sentTotal, received - sentTotal, 0);
+            if (sent <= 0) {
+                if (sent < 0 && errno == EINTR) {
+                    continue;
+                }
+                break; // Replies are best effort; clients resend by sequence.
+            }
+            sentTotal += sent;
+        }
+    }
+
+    close(udp_fd);
 }
 
-void Server::sendMessage(int clientSocket, std::string_view message) {
-    const char* data = message.data();
-    size_t totalSent = 0;
-    while (totalSent < message.size()) {
-        const ssize_t sent = send(clientSocket,
-                                  data + totalSent,
-                                  message.size() - totalSent,
-                                  MSG_NOSIGNAL);
-        if (sent <= 0) {
-            return;
+void Server::runShm(ShmGateway& gateway) {
+    constexpr auto kIdleSleep = std::chrono::milliseconds(100);
+    constexpr auto kReapInterval = std::chrono::milliseconds(250);
+
+    const int cpu = lowLatency_.cpuFor(nextClientSlot_++);
+    if (lowLatency_.enabled()) {
+        enterLowLatencyMode(cpu, "shm thread");
+    }
+
+    std::cout << "Shared-memory order entry on " << Shm::segmentPath(gateway.name()) << " ("
+              << gateway.slotCount() << " slots)" << std::endl;
+
+    const std::size_t idleSpins = Shm::spinBeforeSleep();
+    auto nextReap = std::chrono::steady_clock::now();
+    std::size_t idle = 0;
+    while (true) {
+        const std::size_t handled = gateway.poll([this](std::uint32_t slot, std::string_view frame, std::string& reply) {
+            dispatchCommand(frame, Shm::engineSessionId(slot), reply);
+        });
+        if (handled > 0) {
+            // Like a TCP batch: nothing is acknowledged before the standby has it.
+            awaitReplication();
+            idle = 0;
+        }
+        gateway.flush();
+
+        const auto now = std::chrono::steady_clock::now();
+        if (now >= nextReap) {
+            nextReap = now + kReapInterval;
+            for (const std::uint32_t slot : gateway.reapClosedSlots()) {
+                if (cancelOnDisconnect_) {
+                    cancelSessionOnDisconnect(Shm::engineSessionId(slot));
+                }
+            }
+        }
+
+        if (handled > 0) {
+            continue;
+        }
+        if (lowLatency_.busySpin || ++idle < idleSpins) {
+            cpuRelax();
+            continue;
         }
-        totalSent += static_cast<size_t>(sent);
+        // Nothing for a while: sleep until a client rings (bounded, so dead
+        // clients are still reaped).
+        gateway.wait(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::min<std::chrono::steady_clock::duration>(kIdleSleep, nextReap - std::chrono::steady_clock::now())));
+        nextReap = std::chrono::steady_clock::now(); // the wake-up may be a client detaching
     }
 }
\ No newline at end of file
@@ -1,17 +1,78 @@
 #pragma once
 
 #include "Orderbook.h"
+#include "Replication.h"
+#include "Connection.h"
+#include "LowLatency.h"
+#include "ServerMetrics.h"
+#include "ShmGateway.h"
+#include "UdpProtocol.h"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
 #include <string_view>
 #include <string>
+#include <unordered_map>
 
 class Server {
 public:
-    Server(int port, Orderbook* orderbook);
+    Server(int port, Orderbook* orderbook, LowLatencyConfig lowLatency = {}, BackpressureConfig backpressure = {});
     void run(); // Starts the server loop
+    void runUdp(int udpPort); // Datagram order entry, see UdpProtocol.h; blocks like run()
+    // Shared-memory order entry for local processes, see ShmTransport.h; blocks
+    // like run(). Slot n is engine session Shm::engineSessionId(n).
+    void runShm(ShmGateway& gateway);
+    // Order expiry ticker; blocks like run(). Every `tick` it expires due
+    // good-till-date orders and, once a day at endOfDayMinuteUtc (minutes after
+    // midnight UTC, negative to disable), sweeps Day orders. Owners get an
+    // "EXPIRED:<order id>" line per order.
+    void runExpiry(std::chrono::milliseconds tick, int endOfDayMinuteUtc = -1);
+
+    // Queues a message for another session without blocking the caller.
+    bool sendTo(ConnectionId connectionId, std::string_view message);
+    const ServerMetrics& metrics() const { return metrics_; }
+
+    // Streams every applied command to a hot standby. Must be set before run().
+    void setReplication(ReplicationPrimary* replication) { replication_ = replication; }
+    // On by default: a TCP session's resting orders are cancelled when its socket closes.
+    void setCancelOnDisconnect(bool enabled) { cancelOnDisconnect_ = enabled; }
+    // New TCP sessions are numbered above `highest`, so a promoted standby's
+    // clients never inherit the replayed orders of the old primary's sessions.
+    // Must be called before run().
+    void reserveSessionIds(SessionId highest);
+    std::string metricsJson() const; // also answered to a "METRICS" line from any client
+    // Engine memory footprint (Orderbook::memoryStats) as JSON, answered to a "STATS" line.
+    std::string statsJson() const;
+    // "TAPE <symbol> <windowMs>": OHLC, volume and VWAP of the symbol's trades in
+    // the last windowMs, read from the trade tape without taking the book lock.
+    std::string tapeJson(std::string_view request) const;
 
 private:
     int port_;
     Orderbook* orderbook_;
-    void handleClient(int clientSocket);
-    void sendMessage(int clientSocket, std::string_view message);
+    LowLatencyConfig lowLatency_;
+    std::atomic<std::size_t> nextClientSlot_{0}; // client, UDP and shm threads take CPUs in turn
+    Udp::Sequencer udpSequencer_; // UDP thread only
+
+    BackpressureConfig backpressure_;
+    ServerMetrics metrics_;
+    std::atomic<ConnectionId> nextConnectionId_{1};
+    std::mutex connectionsMutex_;
+    std::unordered_map<ConnectionId, std::shared_ptr<Connection>> connections_;
+
+    ReplicationPrimary* replication_ = nullptr;
+    std::mutex sequencerMutex_; // orders apply+publish when replicating
+    bool cancelOnDisconnect_ = true;
+
+    std::string processCommand(std::string_view frame, SessionId session);
+    // METRICS, STATS and TAPE are answered here; everything else goes to processCommand.
+    void dispatchCommand(std::string_view frame, SessionId session, std::string& out);
+    void cancelSessionOnDisconnect(ConnectionId connectionId);
+    void expireOrders(std::uint64_t nowMs, bool endOfDay);
+    void awaitReplication();
+    void handleClient(int clientSocket, int cpu);
+    void enterLowLatencyMode(int cpu, const char* threadName);
 };
\ No newline at end of file
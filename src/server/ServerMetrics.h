@@ -0,0 +1,28 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// Process-wide connection counters. Writers use relaxed increments; readers
+// get an approximate but tear-free view, which is all a metrics scrape needs.
+struct ServerMetrics {
+    std::atomic<std::uint64_t> connectionsAccepted{0};
+    std::atomic<std::uint64_t> connectionsOpen{0};
+    std::atomic<std::uint64_t> outboundQueuedBytes{0};      // current sum over connections
+    std::atomic<std::uint64_t> outboundQueueHighWatermark{0}; // largest single queue seen
+    std::atomic<std::uint64_t> outboundBytesSent{0};
+    std::atomic<std::uint64_t> overflowDisconnects{0};
+    std::atomic<std::uint64_t> conflatedMessages{0};
+    std::atomic<std::uint64_t> readPauses{0};
+    std::atomic<std::uint64_t> rateLimitedMessages{0};
+    std::atomic<std::uint64_t> ordersCancelledOnDisconnect{0};
+    std::atomic<std::uint64_t> ordersExpired{0}; // good-till-date expiry and end-of-day sweeps
+
+    void raiseHighWatermark(std::uint64_t depth)
+    {
+        std::uint64_t current = outboundQueueHighWatermark.load(std::memory_order_relaxed);
+        while (depth > current &&
+               !outboundQueueHighWatermark.compare_exchange_weak(current, depth, std::memory_order_relaxed)) {
+        }
+    }
+};
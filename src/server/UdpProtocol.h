@@ -0,0 +1,244 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// Datagram order entry for co-located clients.
+//
+// Every datagram starts with a fixed header followed by one or more
+// newline-delimited FIX frames. Replies echo the header (with status flags)
+// followed by one response line per frame, in order.
+//
+// Sequencing is per session: the server processes sequence N only after N-1.
+//  - seq == expected : frames are processed, the reply is cached, expected advances.
+//  - seq <  expected : resend. The cached reply is replayed if it is the last
+//                      sequence, otherwise a DUPLICATE reply is sent. Nothing is
+//                      re-applied to the book.
+//  - seq >  expected : GAP reply carrying the expected sequence; nothing is applied.
+// A session starts at sequence 1 and is bound to the address it came from;
+// datagrams for it from any other address are rejected. A session idle for
+// longer than the idle timeout expires: its id is free again, and the caller
+// cancels its orders before anything else runs under that id. The table holds
+// at most maxSessions; a new session that finds it full and nothing expired is
+// rejected.
+// Session state is not replicated: a standby that takes over expects sequence 1
+// from every session and, unless cancel-on-disconnect is off, has cancelled
+// their orders.
+namespace Udp {
+
+struct Header {
+    std::uint32_t sessionId;
+    std::uint16_t flags;
+    std::uint16_t reserved;
+    std::uint64_t sequence;
+};
+
+static_assert(sizeof(Header) == 16, "UDP header must stay 16 bytes");
+
+// Header flags.
+constexpr std::uint16_t kFlagReply = 1u << 0;
+constexpr std::uint16_t kFlagDuplicate = 1u << 1;
+constexpr std::uint16_t kFlagGap = 1u << 2;
+constexpr std::uint16_t kFlagResent = 1u << 3;
+constexpr std::uint16_t kFlagRejected = 1u << 4; // malformed, truncated or from the wrong peer
+
+// UDP sessions own orders in the engine under this bit, so they never collide
+// with TCP connection ids (which are allocated from 1 upwards).
+constexpr std::uint32_t kEngineSessionBit = 1u << 31;
+
+inline std::uint32_t engineSessionId(std::uint32_t sessionId)
+{
+    return sessionId | kEngineSessionBit;
+}
+
+constexpr std::size_t kMaxDatagramBytes = 8 * 1024;
+constexpr std::size_t kBatchSize = 64;
+
+// Each session caches its last reply (up to kMaxDatagramBytes), so this bounds
+// the table at 8 MiB.
+constexpr std::size_t kMaxSessions = 1024;
+constexpr std::chrono::seconds kSessionIdleTimeout{60};
+
+// The sender address a session is bound to: IPv4 address and port, as they
+// appear in sockaddr_in.
+inline std::uint64_t peerKey(std::uint32_t address, std::uint16_t port)
+{
+    return (std::uint64_t{address} << 16) | port;
+}
+
+struct SessionState {
+    std::uint64_t expectedSequence = 1;
+    std::uint64_t lastSequence = 0;
+    std::string lastReply; // full datagram, header included
+    std::uint64_t peer = 0;
+    std::chrono::steady_clock::time_point lastActive{};
+};
+
+// Per-session sequencing state of one listener, applying the rules above.
+// Not synchronised: the UDP thread owns it.
+class Sequencer {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit Sequencer(std::size_t maxSessions = kMaxSessions, Clock::duration idleTimeout = kSessionIdleTimeout)
+        : maxSessions_(maxSessions)
+        , idleTimeout_(idleTimeout)
+    {
+    }
+
+    // Builds the reply to one datagram received from peer at now. For an
+    // in-sequence datagram, apply(frame, engineSession) runs for each non-empty
+    // frame and returns its response line. expire(engineSession) runs for each
+    // session that expires on the way, before any frame is applied.
+    template <typename Apply, typename Expire>
+    void handle(std::string_view datagram, std::uint64_t peer, Clock::time_point now, std::string& reply,
+                Apply&& apply, Expire&& expire)
+    {
+        reply.clear();
+
+        Header header{};
+        if (datagram.size() < sizeof(Header)) {
+            reject(datagram, reply);
+            return;
+        }
+        std::memcpy(&header, datagram.data(), sizeof(header));
+
+        auto it = sessions_.find(header.sessionId);
+        if (it != sessions_.end() && it->second.peer != peer) {
+            if (now - it->second.lastActive < idleTimeout_) {
+                reject(datagram, reply);
+                return;
+            }
+            expire(engineSessionId(it->first));
+            sessions_.erase(it);
+            it = sessions_.end();
+        }
+
+        if (it == sessions_.end()) {
+            // Only sequence 1 opens a session; anything else is answered without
+            // taking a table entry.
+            if (header.sequence != 1) {
+                static const SessionState unopened{};
+                replyOutOfSequence(header, unopened, reply);
+                return;
+            }
+            if (sessions_.size() >= maxSessions_) {
+                expireIdle(now, expire);
+                if (sessions_.size() >= maxSessions_) {
+                    reject(datagram, reply);
+                    return;
+                }
+            }
+            it = sessions_.emplace(header.sessionId, SessionState{}).first;
+            it->second.peer = peer;
+        }
+
+        SessionState& session = it->second;
+        session.lastActive = now;
+        if (header.sequence != session.expectedSequence) {
+            replyOutOfSequence(header, session, reply);
+            return;
+        }
+
+        datagram.remove_prefix(sizeof(header));
+        header.flags = kFlagReply;
+        reply.append(reinterpret_cast<const char*>(&header), sizeof(header));
+
+        while (!datagram.empty()) {
+            std::size_t frameEnd = datagram.find('\n');
+            if (frameEnd == std::string_view::npos) {
+                frameEnd = datagram.size();
+            }
+
+            std::string_view frame = datagram.substr(0, frameEnd);
+            if (!frame.empty() && frame.back() == '\r') {
+                frame.remove_suffix(1);
+            }
+            if (!frame.empty()) {
+                reply.append(apply(frame, engineSessionId(header.sessionId)));
+                reply.push_back('\n');
+            }
+
+            datagram.remove_prefix(std::min(frameEnd + 1, datagram.size()));
+        }
+
+        session.lastSequence = header.sequence;
+        session.expectedSequence = header.sequence + 1;
+        session.lastReply = reply;
+    }
+
+    // Drops every session idle for the timeout, calling expire(engineSession)
+    // for each.
+    template <typename Expire>
+    void expireIdle(Clock::time_point now, Expire&& expire)
+    {
+        for (auto it = sessions_.begin(); it != sessions_.end();) {
+            if (now - it->second.lastActive >= idleTimeout_) {
+                expire(engineSessionId(it->first));
+                it = sessions_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    // Reply to a datagram that cannot be processed (too short, truncated by the
+    // receive buffer, or from the wrong peer): its header, if any, flagged
+    // rejected. The session's sequence does not advance, so the client can
+    // resend a smaller datagram.
+    static void reject(std::string_view datagram, std::string& reply)
+    {
+        reply.clear();
+        Header header{};
+        if (datagram.size() >= sizeof(Header)) {
+            std::memcpy(&header, datagram.data(), sizeof(header));
+        }
+        header.flags = kFlagReply | kFlagRejected;
+        reply.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    }
+
+    const SessionState* session(std::uint32_t sessionId) const
+    {
+        const auto it = sessions_.find(sessionId);
+        return it == sessions_.end() ? nullptr : &it->second;
+    }
+
+    std::size_t sessionCount() const { return sessions_.size(); }
+
+private:
+    // Reply to an out-of-sequence datagram; nothing is applied.
+    static void replyOutOfSequence(Header header, const SessionState& session, std::string& reply)
+    {
+        if (header.sequence < session.expectedSequence) {
+            if (header.sequence == session.lastSequence && !session.lastReply.empty()) {
+                reply = session.lastReply;
+                Header resent{};
+                std::memcpy(&resent, reply.data(), sizeof(resent));
+                resent.flags |= kFlagResent;
+                std::memcpy(reply.data(), &resent, sizeof(resent));
+                return;
+            }
+            header.flags = kFlagReply | kFlagDuplicate;
+            reply.append(reinterpret_cast<const char*>(&header), sizeof(header));
+            return;
+        }
+
+        header.flags = kFlagReply | kFlagGap;
+        reply.append(reinterpret_cast<const char*>(&header), sizeof(header));
+        reply.append("GAP:");
+        reply.append(std::to_string(session.expectedSequence));
+        reply.push_back('\n');
+    }
+
+    std::unordered_map<std::uint32_t, SessionState> sessions_;
+    std::size_t maxSessions_;
+    Clock::duration idleTimeout_;
+};
+
+} // namespace Udp
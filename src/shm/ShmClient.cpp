@@ -0,0 +1,99 @@
+#include "ShmClient.h"
+
+#include <stdexcept>
+
+#include <unistd.h>
+
+#include "../server/LowLatency.h"
+
+ShmClient::ShmClient(const std::string& name)
+    : segment_(Shm::Segment::open(name))
+{
+    const std::uint64_t claimed = Shm::slotOwner(Shm::SlotState::Claimed, static_cast<std::uint32_t>(::getpid()));
+    for (std::uint32_t slot = 0; slot < segment_.slotCount(); ++slot) {
+        Shm::SlotHeader& header = segment_.slot(slot);
+        std::uint64_t expected = Shm::slotOwner(Shm::SlotState::Free, 0);
+        if (header.owner.compare_exchange_strong(expected, claimed, std::memory_order_acq_rel)) {
+            slot_ = slot;
+            requests_ = segment_.requestRing(slot);
+            responses_ = segment_.responseRing(slot);
+            return;
+        }
+    }
+    throw std::runtime_error("No free shared-memory slot in " + Shm::segmentPath(name));
+}
+
+ShmClient::~ShmClient()
+{
+    // Only while we still own it: the engine may have freed and handed the slot on.
+    const auto pid = static_cast<std::uint32_t>(::getpid());
+    std::uint64_t claimed = Shm::slotOwner(Shm::SlotState::Claimed, pid);
+    segment_.slot(slot_).owner.compare_exchange_strong(claimed, Shm::slotOwner(Shm::SlotState::Closed, pid),
+                                                       std::memory_order_acq_rel);
+    segment_.header().requests.ring();
+}
+
+bool ShmClient::send(std::string_view frame)
+{
+    if (!requests_.tryPush(frame)) {
+        return false;
+    }
+    segment_.header().requests.ring();
+    return true;
+}
+
+bool ShmClient::peek(std::string_view& reply)
+{
+    return responses_.front(reply);
+}
+
+void ShmClient::release()
+{
+    responses_.pop();
+}
+
+bool ShmClient::receive(std::string& reply, std::chrono::microseconds timeout, std::size_t spin)
+{
+    std::string_view frame;
+    for (std::size_t i = 0; i < spin; ++i) {
+        if (responses_.front(frame)) {
+            reply.assign(frame);
+            responses_.pop();
+            return true;
+        }
+        cpuRelax();
+    }
+
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    Shm::Doorbell& doorbell = segment_.slot(slot_).responses;
+    while (true) {
+        if (responses_.front(frame)) {
+            reply.assign(frame);
+            responses_.pop();
+            return true;
+        }
+        const auto now = std::chrono::steady_clock::now();
+        if (now >= deadline) {
+            return false;
+        }
+        doorbell.wait([&] { return !responses_.empty(); },
+                      std::chrono::duration_cast<std::chrono::microseconds>(deadline - now));
+    }
+}
+
+bool ShmClient::request(std::string_view frame, std::string& reply, std::chrono::microseconds timeout)
+{
+    if (frame.size() > maxFrameBytes()) {
+        return false;
+    }
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (!send(frame)) {
+        if (std::chrono::steady_clock::now() >= deadline) {
+            return false;
+        }
+        cpuRelax();
+    }
+    const auto remaining = deadline - std::chrono::steady_clock::now();
+    return receive(reply, std::chrono::duration_cast<std::chrono::microseconds>(
+                              std::max<std::chrono::steady_clock::duration>(remaining, {})));
+}
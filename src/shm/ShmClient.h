@@ -0,0 +1,53 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "ShmTransport.h"
+
+// Client side of the shared-memory transport (see ShmTransport.h), for a
+// strategy process on the engine's host. Claims one slot for its lifetime;
+// the engine treats the slot as a session, so the orders entered through it
+// are cancelled when the client closes or its process dies (unless the engine
+// runs with --no-cancel-on-disconnect). One thread per client.
+class ShmClient {
+public:
+    // Maps the segment and claims a free slot. Throws std::runtime_error when
+    // the segment does not exist or every slot is taken.
+    explicit ShmClient(const std::string& name);
+    ~ShmClient(); // releases the slot
+
+    ShmClient(const ShmClient&) = delete;
+    ShmClient& operator=(const ShmClient&) = delete;
+
+    // Queues one frame (a FIX message or METRICS/STATS/TAPE, no newline) and
+    // rings the engine if it sleeps. False when the request ring is full or the
+    // frame exceeds maxFrameBytes(); nothing is queued then.
+    bool send(std::string_view frame);
+
+    // Next reply, in request order. Spins for `spin` iterations, then sleeps on
+    // the response doorbell until a reply or `timeout`. False on timeout.
+    bool receive(std::string& reply, std::chrono::microseconds timeout = std::chrono::seconds(1),
+                 std::size_t spin = Shm::spinBeforeSleep());
+
+    // Zero-copy receive: the reply stays valid until release(). False when empty.
+    bool peek(std::string_view& reply);
+    void release();
+
+    // send() then receive(); retries a full request ring until the timeout.
+    bool request(std::string_view frame, std::string& reply,
+                 std::chrono::microseconds timeout = std::chrono::seconds(1));
+
+    std::uint32_t slot() const { return slot_; }
+    std::uint32_t engineSession() const { return Shm::engineSessionId(slot_); }
+    std::size_t maxFrameBytes() const { return requests_.maxFrameBytes(); }
+
+private:
+    Shm::Segment segment_;
+    std::uint32_t slot_ = 0;
+    Shm::Ring requests_;
+    Shm::Ring responses_;
+};
@@ -0,0 +1,149 @@
+#include "ShmGateway.h"
+
+#include <cerrno>
+#include <cstring>
+
+#include <signal.h>
+
+namespace {
+
+// Replies over the ring's frame limit (a STATS dump of a huge universe) are
+// replaced rather than split, so the reply stream stays one frame per request.
+constexpr std::string_view kReplyTooLarge = "ERR";
+
+bool processAlive(std::uint32_t pid)
+{
+    // A claim always carries a pid; 0 would signal our own process group.
+    return pid != 0 && (::kill(static_cast<pid_t>(pid), 0) == 0 || errno != ESRCH);
+}
+
+} // namespace
+
+ShmGateway::ShmGateway(ShmGatewayConfig config)
+    : name_(config.name)
+    , segment_(Shm::Segment::create(config.name, config.slots, config.ringBytes))
+    , queues_(config.slots)
+{
+    for (std::uint32_t slot = 0; slot < queues_.size(); ++slot) {
+        queues_[slot].requests = segment_.requestRing(slot);
+        queues_[slot].responses = segment_.responseRing(slot);
+    }
+    maxFrameBytes_ = queues_.front().responses.maxFrameBytes();
+}
+
+bool ShmGateway::isClaimed(std::uint32_t slot) const
+{
+    return Shm::ownerState(segment_.slot(slot).owner.load(std::memory_order_acquire)) == Shm::SlotState::Claimed;
+}
+
+void ShmGateway::closeCorruptSlot(std::uint32_t slot)
+{
+    // Left for reapClosedSlots, so the caller cleans up the session as for a
+    // client that detached. A client that detached meanwhile already closed it.
+    std::uint64_t owner = segment_.slot(slot).owner.load(std::memory_order_acquire);
+    if (Shm::ownerState(owner) == Shm::SlotState::Claimed) {
+        segment_.slot(slot).owner.compare_exchange_strong(
+            owner, Shm::slotOwner(Shm::SlotState::Closed, Shm::ownerPid(owner)), std::memory_order_acq_rel);
+    }
+}
+
+void ShmGateway::queueReply(SlotQueue& queue, std::string_view reply)
+{
+    if (reply.size() > maxFrameBytes_) {
+        reply = kReplyTooLarge;
+    }
+    // Straight into the ring when nothing is queued ahead of it and it fits.
+    if (queue.pending.empty() && queue.responses.tryPush(reply)) {
+        queue.pushed = true;
+        return;
+    }
+    const std::uint32_t length = static_cast<std::uint32_t>(reply.size());
+    queue.pending.append(reinterpret_cast<const char*>(&length), sizeof(length));
+    queue.pending.append(reply);
+}
+
+void ShmGateway::drain(SlotQueue& queue)
+{
+    while (queue.offset < queue.pending.size()) {
+        std::uint32_t length;
+        std::memcpy(&length, queue.pending.data() + queue.offset, sizeof(length));
+        const std::string_view reply(queue.pending.data() + queue.offset + sizeof(length), length);
+        if (!queue.responses.tryPush(reply)) {
+            break;
+        }
+        queue.offset += sizeof(length) + length;
+        queue.pushed = true;
+    }
+    if (queue.offset == queue.pending.size()) {
+        queue.pending.clear();
+        queue.offset = 0;
+    }
+}
+
+bool ShmGateway::flush()
+{
+    bool drained = true;
+    for (std::uint32_t slot = 0; slot < queues_.size(); ++slot) {
+        SlotQueue& queue = queues_[slot];
+        if (!queue.pending.empty()) {
+            drain(queue);
+            drained = drained && !queue.blocked();
+        }
+        // One doorbell check per slot that got replies since the last flush;
+        // it only costs a syscall when the client is asleep.
+        if (queue.pushed) {
+            queue.pushed = false;
+            segment_.slot(slot).responses.ring();
+        }
+    }
+    return drained;
+}
+
+void ShmGateway::wait(std::chrono::microseconds timeout)
+{
+    segment_.header().requests.wait(
+        [&] {
+            for (std::uint32_t slot = 0; slot < queues_.size(); ++slot) {
+                const auto state = Shm::ownerState(segment_.slot(slot).owner.load(std::memory_order_acquire));
+                if (state == Shm::SlotState::Closed) {
+                    return true;
+                }
+                if (state == Shm::SlotState::Claimed && !queues_[slot].blocked() &&
+                    !queues_[slot].requests.empty()) {
+                    return true;
+                }
+            }
+            return false;
+        },
+        timeout);
+}
+
+std::vector<std::uint32_t> ShmGateway::reapClosedSlots()
+{
+    std::vector<std::uint32_t> closed;
+    for (std::uint32_t slot = 0; slot < queues_.size(); ++slot) {
+        Shm::SlotHeader& header = segment_.slot(slot);
+        const std::uint64_t owner = header.owner.load(std::memory_order_acquire);
+        const Shm::SlotState state = Shm::ownerState(owner);
+        if (state == Shm::SlotState::Closed ||
+            (state == Shm::SlotState::Claimed && !processAlive(Shm::ownerPid(owner)))) {
+            freeSlot(slot);
+            closed.push_back(slot);
+        }
+    }
+    return closed;
+}
+
+void ShmGateway::freeSlot(std::uint32_t slot)
+{
+    SlotQueue& queue = queues_[slot];
+    queue.pending.clear();
+    queue.offset = 0;
+    queue.pushed = false;
+    queue.requests.reset();
+    queue.responses.reset();
+
+    Shm::SlotHeader& header = segment_.slot(slot);
+    header.generation.fetch_add(1, std::memory_order_relaxed);
+    header.owner.store(Shm::slotOwner(Shm::SlotState::Free, 0), std::memory_order_release);
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "ShmTransport.h"
+
+struct ShmGatewayConfig {
+    std::string name;                  // segment name, /dev/shm/<name>
+    std::uint32_t slots = 8;           // concurrent clients
+    std::size_t ringBytes = 256 * 1024; // per direction and slot, a power of two
+};
+
+// Engine side of the shared-memory transport (see ShmTransport.h). Owns the
+// segment; one thread polls every slot, hands each request frame to a handler
+// and queues its reply. Replies are only made visible by flush(), so a caller
+// can put a replication wait between applying commands and acknowledging them.
+class ShmGateway {
+public:
+    // Creates the segment, replacing a stale one of the same name. Throws
+    // std::runtime_error or std::invalid_argument.
+    explicit ShmGateway(ShmGatewayConfig config);
+
+    ShmGateway(const ShmGateway&) = delete;
+    ShmGateway& operator=(const ShmGateway&) = delete;
+
+    // Takes up to maxPerSlot frames from each claimed slot and calls
+    // handler(slot, frame, reply); `reply` is empty on entry. A slot whose
+    // replies are still waiting for ring space is not read, so a client that
+    // stops reading only stalls itself. Returns how many frames were handled.
+    template <typename Handler>
+    std::size_t poll(Handler&& handler, std::size_t maxPerSlot = 64);
+
+    // Moves queued replies into the response rings and wakes sleeping clients.
+    // Returns false while some reply is still waiting for ring space.
+    bool flush();
+
+    // Sleeps until a client rings the request doorbell or `timeout` passes.
+    // Returns early when a claimed slot already has requests.
+    void wait(std::chrono::microseconds timeout);
+
+    // Frees slots whose client detached, whose process is gone or whose request
+    // ring poll() found corrupt, dropping their unread requests and replies,
+    // and returns them so the caller can clean up their sessions.
+    std::vector<std::uint32_t> reapClosedSlots();
+
+    const std::string& name() const { return name_; }
+    std::uint32_t slotCount() const { return segment_.slotCount(); }
+    std::size_t maxFrameBytes() const { return maxFrameBytes_; }
+
+private:
+    struct SlotQueue {
+        Shm::Ring requests;
+        Shm::Ring responses;
+        // Replies not yet in the response ring: [u32 length][bytes]... from `offset`.
+        std::string pending;
+        std::size_t offset = 0;
+        bool pushed = false; // replies reached the ring since the last flush
+
+        bool blocked() const { return offset < pending.size(); }
+    };
+
+    bool isClaimed(std::uint32_t slot) const;
+    void closeCorruptSlot(std::uint32_t slot);
+    void queueReply(SlotQueue& queue, std::string_view reply);
+    void drain(SlotQueue& queue);
+    void freeSlot(std::uint32_t slot);
+
+    std::string name_;
+    Shm::Segment segment_;
+    std::vector<SlotQueue> queues_;
+    std::size_t maxFrameBytes_ = 0;
+    std::string reply_; // reused by poll()
+};
+
+template <typename Handler>
+std::size_t ShmGateway::poll(Handler&& handler, std::size_t maxPerSlot)
+{
+    std::size_t handled = 0;
+    for (std::uint32_t slot = 0; slot < queues_.size(); ++slot) {
+        SlotQueue& queue = queues_[slot];
+        if (queue.blocked() || !isClaimed(slot)) {
+            continue;
+        }
+        std::string_view frame;
+        for (std::size_t taken = 0; taken < maxPerSlot && !queue.blocked() && queue.requests.front(frame); ++taken) {
+            reply_.clear();
+            handler(slot, frame, reply_);
+            queue.requests.pop();
+            queueReply(queue, reply_);
+            ++handled;
+        }
+        if (queue.requests.corrupt()) {
+            closeCorruptSlot(slot);
+        }
+    }
+    return handled;
+}
@@ -0,0 +1,193 @@
+#include "ShmTransport.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <new>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <ctime>
+#endif
+
+namespace Shm {
+
+void futexWait(std::atomic<std::uint32_t>& word, std::uint32_t expected, std::chrono::microseconds timeout)
+{
+#if defined(__linux__)
+    const auto seconds = std::chrono::duration_cast<std::chrono::seconds>(timeout);
+    timespec ts{};
+    ts.tv_sec = static_cast<time_t>(seconds.count());
+    ts.tv_nsec = static_cast<long>(std::chrono::duration_cast<std::chrono::nanoseconds>(timeout - seconds).count());
+    // Returns at once (EAGAIN) if the word already moved past `expected`.
+    ::syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&word), FUTEX_WAIT, expected, &ts, nullptr, 0);
+#else
+    if (word.load(std::memory_order_acquire) == expected) {
+        std::this_thread::sleep_for(std::min<std::chrono::microseconds>(timeout, std::chrono::microseconds(50)));
+    }
+#endif
+}
+
+void futexWake(std::atomic<std::uint32_t>& word)
+{
+#if defined(__linux__)
+    ::syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&word), FUTEX_WAKE, 1, nullptr, nullptr, 0);
+#else
+    (void)word;
+#endif
+}
+
+std::size_t spinBeforeSleep()
+{
+    static const std::size_t spins = std::thread::hardware_concurrency() > 1 ? 4'000 : 0;
+    return spins;
+}
+
+std::string segmentPath(const std::string& name)
+{
+    return name.empty() || name.front() != '/' ? "/" + name : name;
+}
+
+Segment Segment::create(const std::string& name, std::uint32_t slotCount, std::size_t ringBytes)
+{
+    if (slotCount == 0 || ringBytes < 64 || (ringBytes & (ringBytes - 1)) != 0) {
+        throw std::invalid_argument("Shared-memory rings need at least one slot and a power-of-two size >= 64");
+    }
+    const std::string path = segmentPath(name);
+    const std::size_t bytes = segmentBytesFor(slotCount, ringBytes);
+
+    ::shm_unlink(path.c_str()); // a segment left behind by a crashed engine
+    const int fd = ::shm_open(path.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0) {
+        throw std::runtime_error("shm_open(" + path + ") failed: " + std::to_string(errno));
+    }
+    if (::ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+        ::close(fd);
+        ::shm_unlink(path.c_str());
+        throw std::runtime_error("ftruncate(" + path + ") failed: " + std::to_string(errno));
+    }
+    void* base = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (base == MAP_FAILED) {
+        ::shm_unlink(path.c_str());
+        throw std::runtime_error("mmap(" + path + ") failed: " + std::to_string(errno));
+    }
+
+    Segment segment;
+    segment.base_ = base;
+    segment.bytes_ = bytes;
+    segment.unlinkName_ = path;
+
+    // ftruncate zero-fills; construct the atomics in place, then publish the magic last.
+    auto* header = new (base) SegmentHeader{};
+    header->version = kVersion;
+    header->slotCount = slotCount;
+    header->ringBytes = ringBytes;
+    header->slotBytes = slotBytesFor(ringBytes);
+    header->enginePid = static_cast<std::uint32_t>(::getpid());
+    for (std::uint32_t i = 0; i < slotCount; ++i) {
+        new (&segment.slot(i)) SlotHeader{};
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(header->magic, kSegmentMagic, sizeof(kSegmentMagic));
+    return segment;
+}
+
+Segment Segment::open(const std::string& name)
+{
+    const std::string path = segmentPath(name);
+    const int fd = ::shm_open(path.c_str(), O_RDWR, 0);
+    if (fd < 0) {
+        throw std::runtime_error("shm_open(" + path + ") failed: " + std::to_string(errno));
+    }
+    struct stat info{};
+    if (::fstat(fd, &info) != 0 || static_cast<std::size_t>(info.st_size) < sizeof(SegmentHeader)) {
+        ::close(fd);
+        throw std::runtime_error("Shared-memory segment " + path + " is not initialised");
+    }
+    const std::size_t bytes = static_cast<std::size_t>(info.st_size);
+    void* base = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (base == MAP_FAILED) {
+        throw std::runtime_error("mmap(" + path + ") failed: " + std::to_string(errno));
+    }
+
+    Segment segment;
+    segment.base_ = base;
+    segment.bytes_ = bytes;
+    const SegmentHeader& header = segment.header();
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (std::memcmp(header.magic, kSegmentMagic, sizeof(kSegmentMagic)) != 0 || header.version != kVersion ||
+        segmentBytesFor(header.slotCount, header.ringBytes) != bytes) {
+        throw std::runtime_error("Shared-memory segment " + path + " has an unknown layout");
+    }
+    return segment;
+}
+
+Segment::Segment(Segment&& other) noexcept
+    : base_(std::exchange(other.base_, nullptr))
+    , bytes_(std::exchange(other.bytes_, 0))
+    , unlinkName_(std::move(other.unlinkName_))
+{
+    other.unlinkName_.clear();
+}
+
+Segment& Segment::operator=(Segment&& other) noexcept
+{
+    if (this != &other) {
+        release();
+        base_ = std::exchange(other.base_, nullptr);
+        bytes_ = std::exchange(other.bytes_, 0);
+        unlinkName_ = std::move(other.unlinkName_);
+        other.unlinkName_.clear();
+    }
+    return *this;
+}
+
+Segment::~Segment()
+{
+    release();
+}
+
+void Segment::release()
+{
+    if (base_ != nullptr) {
+        ::munmap(base_, bytes_);
+        base_ = nullptr;
+    }
+    if (!unlinkName_.empty()) {
+        ::shm_unlink(unlinkName_.c_str());
+        unlinkName_.clear();
+    }
+}
+
+SlotHeader& Segment::slot(std::uint32_t index) const
+{
+    char* slots = static_cast<char*>(base_) + sizeof(SegmentHeader);
+    return *reinterpret_cast<SlotHeader*>(slots + index * header().slotBytes);
+}
+
+Ring Segment::requestRing(std::uint32_t index) const
+{
+    SlotHeader& header = slot(index);
+    char* data = reinterpret_cast<char*>(&header) + sizeof(SlotHeader);
+    return Ring(&header.request, data, this->header().ringBytes);
+}
+
+Ring Segment::responseRing(std::uint32_t index) const
+{
+    SlotHeader& header = slot(index);
+    const std::size_t ringBytes = this->header().ringBytes;
+    char* data = reinterpret_cast<char*>(&header) + sizeof(SlotHeader) + ringBytes;
+    return Ring(&header.response, data, ringBytes);
+}
+
+} // namespace Shm
@@ -0,0 +1,300 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+// Shared-memory order entry for processes on the engine's host.
+//
+// The engine creates one POSIX shared-memory segment (/dev/shm/<name>) holding
+// a fixed number of client slots. A client maps the segment, claims a free slot
+// and from then on exchanges frames with the engine through two single-producer
+// single-consumer rings in that slot: requests (client -> engine) and responses
+// (engine -> client). A frame is one command as sent over TCP (a FIX message,
+// METRICS, STATS or TAPE), without the trailing newline; every request gets
+// exactly one response frame, in order. Neither side makes a syscall on the
+// data path. A side that finds its ring empty may sleep on a futex doorbell;
+// the other side only pays for the wake-up when someone is actually asleep.
+//
+// Layout, host byte order:
+//   [SegmentHeader][slot 0][slot 1]...
+//   slot = [SlotHeader][request ring bytes][response ring bytes]
+// Ring records are [u32 length][payload], padded to 8 bytes. A length of
+// kPadRecord means "skip to the start of the ring". The engine does not trust
+// what a client wrote: a record that overruns the ring or the published bytes
+// marks the ring corrupt, and the engine frees the slot.
+namespace Shm {
+
+inline constexpr char kSegmentMagic[8] = {'O', 'M', 'S', 'H', 'M', '1', '\0', '\0'};
+inline constexpr std::uint32_t kVersion = 2;
+inline constexpr std::size_t kCacheLine = 64;
+inline constexpr std::uint32_t kPadRecord = 0xFFFFFFFFu;
+inline constexpr std::size_t kRecordAlignment = 8;
+
+// Engine sessions of shared-memory clients, one per slot. Kept apart from TCP
+// connection ids (allocated from 1 upwards) and UDP sessions (top bit).
+inline constexpr std::uint32_t kEngineSessionBit = 1u << 30;
+
+inline std::uint32_t engineSessionId(std::uint32_t slot)
+{
+    return slot | kEngineSessionBit;
+}
+
+static_assert(std::atomic<std::uint32_t>::is_always_lock_free && std::atomic<std::uint64_t>::is_always_lock_free,
+              "Shared-memory atomics must be lock-free to be address-free across processes");
+
+// How many times a side polls an empty ring before sleeping on its doorbell.
+// Zero on a single CPU, where spinning only delays the process it waits for.
+std::size_t spinBeforeSleep();
+
+// Futex on a word inside the shared mapping (not process-private). Elsewhere
+// than Linux the wait degrades to a short sleep.
+void futexWait(std::atomic<std::uint32_t>& word, std::uint32_t expected, std::chrono::microseconds timeout);
+void futexWake(std::atomic<std::uint32_t>& word);
+
+// One sleeping consumer, any number of producers. The consumer announces itself
+// before its last look at the ring and the producer checks for it after
+// publishing, both sequentially consistent, so a wake-up is never lost.
+struct alignas(kCacheLine) Doorbell {
+    std::atomic<std::uint32_t> sequence{0};
+    std::atomic<std::uint32_t> sleeping{0};
+
+    void ring()
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (sleeping.load(std::memory_order_relaxed) != 0) {
+            sequence.fetch_add(1, std::memory_order_release);
+            futexWake(sequence);
+        }
+    }
+
+    template <typename Ready>
+    void wait(Ready ready, std::chrono::microseconds timeout)
+    {
+        sleeping.store(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const std::uint32_t seen = sequence.load(std::memory_order_acquire);
+        if (!ready()) {
+            futexWait(sequence, seen, timeout);
+        }
+        sleeping.store(0, std::memory_order_relaxed);
+    }
+};
+
+// Positions only grow; the byte offset is position & (capacity - 1). Head and
+// tail sit on their own cache lines so producer and consumer never share one.
+struct RingPositions {
+    alignas(kCacheLine) std::atomic<std::uint64_t> head{0}; // consumer
+    alignas(kCacheLine) std::atomic<std::uint64_t> tail{0}; // producer
+};
+
+enum class SlotState : std::uint32_t {
+    Free = 0,
+    Claimed = 1, // a client owns the slot
+    Closed = 2,  // the client detached (or the engine gave up on it); the engine frees the slot
+};
+
+// A slot's state and its client's pid share one word, so a client claims a
+// slot and names itself in a single CAS: the engine never sees a claimed slot
+// without a pid to check for liveness.
+constexpr std::uint64_t slotOwner(SlotState state, std::uint32_t pid)
+{
+    return static_cast<std::uint64_t>(pid) << 32 | static_cast<std::uint32_t>(state);
+}
+
+constexpr SlotState ownerState(std::uint64_t owner)
+{
+    return static_cast<SlotState>(static_cast<std::uint32_t>(owner));
+}
+
+constexpr std::uint32_t ownerPid(std::uint64_t owner)
+{
+    return static_cast<std::uint32_t>(owner >> 32);
+}
+
+struct alignas(kCacheLine) SlotHeader {
+    std::atomic<std::uint64_t> owner{slotOwner(SlotState::Free, 0)};
+    std::atomic<std::uint32_t> generation{0}; // bumped every time the slot is freed
+    Doorbell responses;                       // the client sleeps here
+    RingPositions request;
+    RingPositions response;
+};
+
+struct alignas(kCacheLine) SegmentHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t slotCount;
+    std::uint64_t ringBytes; // per direction, a power of two
+    std::uint64_t slotBytes; // SlotHeader plus both rings
+    std::uint32_t enginePid;
+    Doorbell requests; // the engine sleeps here
+};
+
+constexpr std::size_t slotBytesFor(std::size_t ringBytes)
+{
+    return sizeof(SlotHeader) + 2 * ringBytes;
+}
+
+constexpr std::size_t segmentBytesFor(std::uint32_t slotCount, std::size_t ringBytes)
+{
+    return sizeof(SegmentHeader) + slotCount * slotBytesFor(ringBytes);
+}
+
+// View of one direction of a slot: positions in the slot header, bytes after it.
+// Exactly one thread pushes and one thread pops.
+class Ring {
+public:
+    Ring() = default;
+    Ring(RingPositions* positions, char* data, std::size_t capacity)
+        : positions_(positions), data_(data), capacity_(capacity)
+    {
+    }
+
+    // Largest payload that always fits an empty ring, wherever its positions are.
+    std::size_t maxFrameBytes() const { return capacity_ / 2 - sizeof(std::uint32_t); }
+
+    // False if the ring lacks room (retry later) or the frame is over maxFrameBytes().
+    bool tryPush(std::string_view frame)
+    {
+        if (frame.size() > maxFrameBytes()) {
+            return false;
+        }
+        const std::size_t need = recordBytes(frame.size());
+        std::uint64_t tail = positions_->tail.load(std::memory_order_relaxed);
+        const std::uint64_t head = positions_->head.load(std::memory_order_acquire);
+        const std::size_t offset = static_cast<std::size_t>(tail & (capacity_ - 1));
+        const std::size_t contiguous = capacity_ - offset;
+        const std::size_t pad = need > contiguous ? contiguous : 0;
+        if (tail + pad + need - head > capacity_) {
+            return false;
+        }
+        if (pad != 0) {
+            std::memcpy(data_ + offset, &kPadRecord, sizeof(kPadRecord));
+            tail += pad;
+        }
+        const std::uint32_t length = static_cast<std::uint32_t>(frame.size());
+        char* record = data_ + static_cast<std::size_t>(tail & (capacity_ - 1));
+        std::memcpy(record, &length, sizeof(length));
+        std::memcpy(record + sizeof(length), frame.data(), frame.size());
+        positions_->tail.store(tail + need, std::memory_order_release);
+        return true;
+    }
+
+    // The oldest frame, valid until pop(); false when the ring is empty or
+    // corrupt(). The length is read once and checked against the published
+    // bytes, so a producer that scribbles on the ring cannot make the consumer
+    // read outside it.
+    bool front(std::string_view& frame)
+    {
+        if (corrupt_) {
+            return false;
+        }
+        std::uint64_t head = positions_->head.load(std::memory_order_relaxed);
+        const std::uint64_t tail = positions_->tail.load(std::memory_order_acquire);
+        if (head == tail) {
+            return false;
+        }
+        if (tail - head > capacity_) {
+            corrupt_ = true;
+            return false;
+        }
+        std::size_t offset = static_cast<std::size_t>(head & (capacity_ - 1));
+        std::uint32_t length;
+        std::memcpy(&length, data_ + offset, sizeof(length));
+        if (length == kPadRecord) {
+            if (tail - head < capacity_ - offset) {
+                corrupt_ = true;
+                return false;
+            }
+            head += capacity_ - offset;
+            positions_->head.store(head, std::memory_order_release);
+            if (head == tail) {
+                return false;
+            }
+            offset = 0;
+            std::memcpy(&length, data_, sizeof(length));
+        }
+        if (length > maxFrameBytes() || recordBytes(length) > tail - head ||
+            recordBytes(length) > capacity_ - offset) {
+            corrupt_ = true;
+            return false;
+        }
+        frontBytes_ = recordBytes(length);
+        frame = std::string_view(data_ + offset + sizeof(length), length);
+        return true;
+    }
+
+    // Releases the frame returned by the last successful front().
+    void pop()
+    {
+        const std::uint64_t head = positions_->head.load(std::memory_order_relaxed);
+        positions_->head.store(head + frontBytes_, std::memory_order_release);
+    }
+
+    // The producer published a record front() refused; nothing more is read.
+    bool corrupt() const { return corrupt_; }
+
+    bool empty() const
+    {
+        return positions_->head.load(std::memory_order_acquire) == positions_->tail.load(std::memory_order_acquire);
+    }
+
+    // Engine only, while no client owns the slot.
+    void reset()
+    {
+        corrupt_ = false;
+        positions_->head.store(0, std::memory_order_relaxed);
+        positions_->tail.store(0, std::memory_order_release);
+    }
+
+private:
+    static std::size_t recordBytes(std::size_t payload)
+    {
+        return (sizeof(std::uint32_t) + payload + kRecordAlignment - 1) / kRecordAlignment * kRecordAlignment;
+    }
+
+    RingPositions* positions_ = nullptr;
+    char* data_ = nullptr;
+    std::size_t capacity_ = 0;
+    std::size_t frontBytes_ = 0; // record size seen by the last front()
+    bool corrupt_ = false;
+};
+
+// A mapped segment; the engine creates it, clients open it by name.
+class Segment {
+public:
+    // Creates /dev/shm/<name> (replacing a stale one) sized for the slots.
+    // Throws std::runtime_error (or std::invalid_argument for a bad size).
+    static Segment create(const std::string& name, std::uint32_t slotCount, std::size_t ringBytes);
+    // Maps an existing segment and checks its header. Throws std::runtime_error.
+    static Segment open(const std::string& name);
+
+    Segment() = default;
+    Segment(Segment&& other) noexcept;
+    Segment& operator=(Segment&& other) noexcept;
+    Segment(const Segment&) = delete;
+    Segment& operator=(const Segment&) = delete;
+    ~Segment(); // unmaps; the creator also unlinks the name
+
+    SegmentHeader& header() const { return *static_cast<SegmentHeader*>(base_); }
+    std::uint32_t slotCount() const { return header().slotCount; }
+    SlotHeader& slot(std::uint32_t index) const;
+    Ring requestRing(std::uint32_t index) const;
+    Ring responseRing(std::uint32_t index) const;
+
+private:
+    void release();
+
+    void* base_ = nullptr;
+    std::size_t bytes_ = 0;
+    std::string unlinkName_; // set for the creator only
+};
+
+// Normalises "name" or "/name" to the "/name" form shm_open expects.
+std::string segmentPath(const std::string& name);
+
+} // namespace Shm
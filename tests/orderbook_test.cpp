@@ -1,6 +1,25 @@
 #include "Orderbook.h"
+#include <atomic>
 #include <cassert>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <limits>
+#include <random>
+#include <thread>
+#include <vector>
+
+struct FixedUniverseTestPolicies : SingleThreadedOrderbookPolicies {
+    using SymbolCapacity = FixedSymbolCapacity<8>;
+};
+
+struct TimedItem {
+    std::uint64_t deadline = 0;
+    bool fired = false;
+    TimerHook<TimedItem> hook;
+};
 
 int main() {
     Orderbook ob;
@@ -50,6 +69,770 @@ int main() {
     ob.cancelOrder(100);
     assert(ob.getAsks(otherSymbol).empty());
 
+    // 6. FIX tag 55 resolves tickers from the symbol table; numeric ids still work.
+    Orderbook tickerBook(SymbolTable({"NVDA", "AAPL"}));
+    assert(tickerBook.processFixMessage("8=FIX.4.2|35=D|11=1|55=AAPL|54=1|44=13550|38=200|") == "ID:");
+    assert(tickerBook.getBids(1).size() == 1);
+    assert(tickerBook.processFixMessage("8=FIX.4.2|35=D|11=2|55=1|54=2|44=13550|38=200|") == "ID:");
+    assert(tickerBook.getBids(1).empty());
+    assert(tickerBook.processFixMessage("8=FIX.4.2|35=D|11=3|55=MSFT|54=1|44=13550|38=200|") == "ERR");
+
+    // 7. Large runtime universe: books are created lazily and idle ones reclaimed.
+    Orderbook wideBook(SymbolTable{}, 50'000);
+    assert(wideBook.symbolUniverseSize() == 50'000);
+    assert(wideBook.activeSymbolBookCount() == 0);
+    assert(wideBook.processFixMessage("8=FIX.4.2|35=D|11=1|55=49999|54=1|44=100|38=5|") == "ID:");
+    assert(wideBook.processFixMessage("8=FIX.4.2|35=D|11=2|55=50000|54=1|44=100|38=5|") == "ERR");
+    assert(wideBook.processFixMessage("8=FIX.4.2|35=D|11=3|55=7|54=1|44=100|38=5|") == "ID:");
+    assert(wideBook.activeSymbolBookCount() == 2);
+    assert(wideBook.getBids(123).empty()); // reading an untouched symbol does not create it
+    assert(wideBook.activeSymbolBookCount() == 2);
+    wideBook.cancelOrder(3);
+    assert(wideBook.reclaimIdleBooks() == 1);
+    assert(wideBook.activeSymbolBookCount() == 1);
+    assert(wideBook.getBids(49999).size() == 1);
+    // Top of book, risk exposures and slab chunks also follow the active books, not the universe.
+    assert(wideBook.topOfBook(123) == Orderbook::TopOfBook{} && wideBook.topOfBookVersion(123) == 0);
+    wideBook.enableRiskChecks();
+    const auto idleStats = wideBook.memoryStats();
+    assert(idleStats.topOfBookBytes < 50'000 * sizeof(std::uint64_t));
+    assert(idleStats.riskBytes < 50'000 * sizeof(std::uint64_t) + 256 * sizeof(RiskLimits) * 2);
+    for (int symbol = 0; symbol < 200; ++symbol) {
+        assert(wideBook.processFixMessage("8=FIX.4.2|35=D|11=" + std::to_string(100 + symbol) + "|55=" +
+                                          std::to_string(symbol) + "|54=1|44=100|38=5|1=1|") == "ID:");
+    }
+    assert(wideBook.activeSymbolBookCount() == 201 && wideBook.riskExposure(1, 150).openBuyQuantity == 5);
+    const std::size_t peakBookBytes = wideBook.memoryStats().symbolBookBytes;
+    for (int symbol = 0; symbol < 200; ++symbol) {
+        wideBook.cancelOrder(100 + symbol);
+    }
+    assert(wideBook.reclaimIdleBooks() == 200);
+    assert(wideBook.activeSymbolBookCount() == 1);
+    assert(wideBook.memoryStats().symbolBookBytes - idleStats.symbolBookBytes <
+           (peakBookBytes - idleStats.symbolBookBytes) / 2);
+    assert(wideBook.processFixMessage("8=FIX.4.2|35=D|11=4|55=7|54=1|44=100|38=5|") == "ID:");
+    assert(wideBook.getBids(7).size() == 1 && wideBook.activeSymbolBookCount() == 2);
+
+    // 8. Policy instantiations share the matching logic.
+    SingleThreadedOrderbook unlockedBook;
+    assert(unlockedBook.processFixMessage("8=FIX.4.2|35=D|11=1|55=0|54=1|44=100|38=5|") == "ID:");
+    assert(unlockedBook.processFixMessage("8=FIX.4.2|35=D|11=2|55=0|54=2|44=100|38=5|") == "ID:");
+    assert(unlockedBook.getBids(0).empty() && unlockedBook.getAsks(0).empty());
+
+    WideOrderbook wideTypesBook;
+    const WideOrderbook::Price widePrice = 10'000'000'000ULL;
+    wideTypesBook.addOrder(std::make_shared<WideOrderbook::Order>(1, widePrice, 6'000'000'000ULL, Side::BUY, symbol));
+    auto wideTrades = wideTypesBook.addOrder(std::make_shared<WideOrderbook::Order>(2, widePrice, 5'000'000'000ULL, Side::SELL, symbol));
+    assert(wideTrades.size() == 1);
+    assert(wideTrades[0].getBidTradeInfo().getQuantity() == 5'000'000'000ULL);
+    assert(wideTypesBook.getBids(symbol).begin()->first == widePrice);
+
+    BasicOrderbook<FixedUniverseTestPolicies> fixedBook;
+    assert(fixedBook.symbolUniverseSize() == 8);
+    assert(fixedBook.processFixMessage("8=FIX.4.2|35=D|11=1|55=7|54=1|44=100|38=5|") == "ID:");
+    assert(fixedBook.processFixMessage("8=FIX.4.2|35=D|11=2|55=8|54=1|44=100|38=5|") == "ERR");
+
+    // Each case below gets its own scope: every book preallocates its order pool.
+    const SessionId alice = 1;
+    const SessionId bob = 2;
+
+    // 9. Sessions own their orders: mass cancel by filter, cancel-on-disconnect style sweep.
+    {
+        Orderbook sessionBook;
+        assert(sessionBook.processFixMessage("8=FIX.4.2|35=D|11=1|55=0|54=1|44=100|38=5|", alice) == "ID:");
+        assert(sessionBook.processFixMessage("8=FIX.4.2|35=D|11=2|55=0|54=2|44=200|38=5|", alice) == "ID:");
+        assert(sessionBook.processFixMessage("8=FIX.4.2|35=D|11=3|55=1|54=1|44=100|38=5|", alice) == "ID:");
+        assert(sessionBook.processFixMessage("8=FIX.4.2|35=D|11=4|55=0|54=1|44=100|38=5|", bob) == "ID:");
+        assert(sessionBook.sessionOrderCount(alice) == 3);
+        assert(sessionBook.sessionOrderCount(bob) == 1);
+
+        // Modify keeps ownership; a fill removes the order from its session.
+        assert(sessionBook.processFixMessage("8=FIX.4.2|35=G|11=3|55=1|54=1|44=101|38=5|", alice) == "OK");
+        assert(sessionBook.sessionOrderCount(alice) == 3);
+        assert(sessionBook.processFixMessage("8=FIX.4.2|35=D|11=5|55=1|54=2|44=101|38=5|", bob) == "ID:");
+        assert(sessionBook.sessionOrderCount(alice) == 2);
+        assert(sessionBook.sessionOrderCount(bob) == 1);
+
+        assert(sessionBook.processFixMessage("8=FIX.4.2|35=q|530=1|55=0|54=2|", alice) == "CXL:1");
+        assert(sessionBook.getAsks(0).empty());
+        assert(sessionBook.getBids(0).begin()->second.size() == 2);
+        assert(sessionBook.processFixMessage("8=FIX.4.2|35=q|530=1|55=0|", alice) == "CXL:1");
+        assert(sessionBook.processFixMessage("8=FIX.4.2|35=q|530=7|", alice) == "CXL:0");
+        assert(sessionBook.processFixMessage("8=FIX.4.2|35=q|530=7|") == "ERR"); // needs a session
+        assert(sessionBook.processFixMessage("8=FIX.4.2|35=q|530=1|", bob) == "ERR"); // 530=1 needs 55
+        assert(sessionBook.getBids(0).begin()->second.size() == 1); // bob's order untouched
+        assert(sessionBook.sessionsWithOrders() == std::vector<SessionId>{ bob });
+        assert(sessionBook.cancelSessionOrders(bob) == 1);
+        assert(sessionBook.getBids(0).empty());
+        assert(sessionBook.sessionOrderCount(bob) == 0);
+    }
+
+    // 10. Stop and stop-limit orders fire after matching, including cascades.
+    {
+        Orderbook stopBook;
+        assert(stopBook.processFixMessage("8=FIX.4.2|35=D|11=1|55=0|54=2|44=101|38=5|") == "ID:");
+        assert(stopBook.processFixMessage("8=FIX.4.2|35=D|11=2|55=0|54=2|44=103|38=5|") == "ID:");
+        assert(stopBook.processFixMessage("8=FIX.4.2|35=D|11=3|55=0|54=2|44=105|38=5|") == "ID:");
+        assert(stopBook.processFixMessage("8=FIX.4.2|35=D|11=10|55=0|54=1|40=4|99=101|44=103|38=5|") == "ID:");
+        assert(stopBook.processFixMessage("8=FIX.4.2|35=D|11=11|55=0|54=1|40=3|99=103|38=3|") == "ID:");
+        assert(stopBook.processFixMessage("8=FIX.4.2|35=D|11=12|55=0|54=2|40=3|99=90|38=1|") == "ID:");
+        assert(stopBook.processFixMessage("8=FIX.4.2|35=D|11=12|55=0|54=1|44=100|38=1|") == "ERR"); // id held by a stop
+        assert(stopBook.processFixMessage("8=FIX.4.2|35=D|11=13|55=0|54=1|40=3|38=1|") == "ERR");   // no 99
+        assert(stopBook.processFixMessage("8=FIX.4.2|35=D|11=13|55=0|54=1|40=4|99=1|38=1|") == "ERR"); // no 44
+        assert(stopBook.processFixMessage("8=FIX.4.2|35=D|11=13|55=0|54=1|40=9|44=1|38=1|") == "ERR");
+        assert(stopBook.pendingStopCount(0) == 3);
+        assert(stopBook.getBids(0).empty());
+
+        // 20 lifts 101 -> stop-limit 10 fires and lifts 103 -> stop 11 fires and takes 3 @ 105.
+        auto stopTrades = stopBook.addOrder(std::make_shared<Order>(20, 101, 5, Side::BUY, symbol));
+        assert(stopTrades.size() == 3);
+        assert(stopTrades[1].getBidTradeInfo().getOrderId() == 10 && stopTrades[1].getAskTradeInfo().getPrice() == 103);
+        assert(stopTrades[2].getBidTradeInfo().getOrderId() == 11 && stopTrades[2].getAskTradeInfo().getPrice() == 105);
+        assert(stopTrades[2].getBidTradeInfo().getQuantity() == 3);
+        assert(stopBook.pendingStopCount(0) == 1);
+        assert(stopBook.getBids(0).empty());
+        assert(stopBook.getAsks(0).size() == 1 && stopBook.getAsks(0).begin()->second.front()->getUnfilledQuantity() == 2);
+
+        stopBook.cancelOrder(12);
+        assert(stopBook.pendingStopCount(0) == 0);
+        assert(stopBook.processFixMessage("8=FIX.4.2|35=D|11=30|55=0|54=2|40=3|99=50|38=1|", alice) == "ID:");
+        assert(stopBook.processFixMessage("8=FIX.4.2|35=q|530=7|", alice) == "CXL:1");
+        assert(stopBook.pendingStopCount(0) == 0);
+    }
+
+    // 11. Seqlock top of book: aggregate level quantity and last trade, read without locks.
+    {
+        Orderbook topBook;
+        assert(!topBook.topOfBook(3).hasBid() && !topBook.topOfBook(3).hasLastTrade());
+        topBook.addOrder(std::make_shared<Order>(1, 100, 5, Side::BUY, 3));
+        topBook.addOrder(std::make_shared<Order>(2, 100, 7, Side::BUY, 3));
+        topBook.addOrder(std::make_shared<Order>(3, 99, 1, Side::BUY, 3));
+        topBook.addOrder(std::make_shared<Order>(4, 102, 4, Side::SELL, 3));
+        auto top = topBook.topOfBook(3);
+        assert(top.bidPrice_ == 100 && top.bidQuantity_ == 12);
+        assert(top.askPrice_ == 102 && top.askQuantity_ == 4);
+        const auto versionBefore = topBook.topOfBookVersion(3);
+        topBook.addOrder(std::make_shared<Order>(5, 100, 6, Side::SELL, 3)); // fills 5 of #1, 1 of #2
+        top = topBook.topOfBook(3);
+        assert(top.bidPrice_ == 100 && top.bidQuantity_ == 6);
+        assert(top.lastTradePrice_ == 100 && top.lastTradeQuantity_ == 1);
+        assert(topBook.topOfBookVersion(3) > versionBefore);
+        topBook.cancelOrder(2);
+        top = topBook.topOfBook(3);
+        assert(top.bidPrice_ == 99 && top.bidQuantity_ == 1 && top.lastTradePrice_ == 100);
+        const auto versionAfterCancel = topBook.topOfBookVersion(3);
+        topBook.addOrder(std::make_shared<Order>(6, 90, 1, Side::BUY, 3)); // behind the best bid
+        assert(topBook.topOfBookVersion(3) == versionAfterCancel); // unchanged snapshot is not republished
+
+        // Readers never observe a torn snapshot: every published bid has price == quantity.
+        // Versions polled mid-write stay even and never go backwards.
+        std::atomic<bool> writing{true};
+        std::atomic<bool> torn{false};
+        std::vector<std::thread> readers;
+        for (int r = 0; r < 2; ++r) {
+            readers.emplace_back([&] {
+                std::uint64_t lastVersion = 0;
+                while (writing.load(std::memory_order_relaxed)) {
+                    const auto version = topBook.topOfBookVersion(4);
+                    const auto snapshot = topBook.topOfBook(4);
+                    if (snapshot.bidPrice_ != snapshot.bidQuantity_ || (version & 1) != 0 || version < lastVersion) {
+                        torn = true;
+                    }
+                    lastVersion = version;
+                }
+            });
+        }
+        for (OrderId id = 100; id < 20'000; ++id) {
+            const auto price = static_cast<Price>(id);
+            topBook.addOrder(std::make_shared<Order>(id, price, price, Side::BUY, 4));
+        }
+        writing = false;
+        for (auto& reader : readers) {
+            reader.join();
+        }
+        assert(!torn);
+        assert(topBook.topOfBook(4).bidPrice_ == 19'999);
+    }
+
+    // 12. Time in force: good-till-date expiry on the timer wheel, end-of-day sweep of Day orders.
+    {
+        // The wheel fires each item exactly on its deadline across level and overflow boundaries.
+        {
+            std::vector<TimedItem> items(2'000);
+            TimerWheel<TimedItem, &TimedItem::hook> wheel(1'000);
+            std::uint64_t seed = 42;
+            for (auto& item : items) {
+                seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+                item.deadline = 1'001 + (seed >> 33) % (std::uint64_t{1} << (8 * (1 + (seed >> 20) % 5)));
+                wheel.schedule(item, item.deadline);
+            }
+            for (std::size_t i = 0; i < items.size(); i += 7) {
+                wheel.cancel(items[i]);
+            }
+            std::uint64_t now = 1'000;
+            // Tick by tick through the first two levels: every item fires on its exact deadline.
+            while (now < 1'000 + (1u << 17)) {
+                ++now;
+                wheel.advance(now, [&](TimedItem& item) {
+                    assert(!item.fired && item.deadline == now);
+                    item.fired = true;
+                });
+            }
+            // Then in growing jumps across the upper levels and the overflow list.
+            for (std::uint64_t step = 1; now < (std::uint64_t{1} << 41); step *= 3) {
+                now += step;
+                wheel.advance(now, [&](TimedItem& item) {
+                    assert(!item.fired && item.deadline <= now);
+                    item.fired = true;
+                });
+                for (std::size_t i = 0; i < items.size(); ++i) {
+                    assert(items[i].fired == (i % 7 != 0 && items[i].deadline <= now));
+                }
+            }
+            assert(wheel.empty());
+        }
+
+        // Seeded from an epoch clock, a near deadline sits in level 0 and fires on time;
+        // an idle wheel follows the clock it is fed.
+        {
+            constexpr std::uint64_t kEpochMs = 1'760'000'000'000;
+            TimerWheel<TimedItem, &TimedItem::hook> wheel(kEpochMs);
+            TimedItem item;
+            item.deadline = kEpochMs + 300;
+            wheel.schedule(item, item.deadline);
+            for (std::uint64_t now = kEpochMs + 1; now <= kEpochMs + 300; ++now) {
+                assert(wheel.advance(now, [&](TimedItem& fired) { fired.fired = true; }) == (now == item.deadline));
+            }
+            assert(item.fired && wheel.empty() && wheel.now() == kEpochMs + 300);
+
+            TimerWheel<TimedItem, &TimedItem::hook> unseeded;
+            assert(unseeded.advance(kEpochMs, [](TimedItem&) { assert(false); }) == 0);
+            assert(unseeded.now() == kEpochMs);
+        }
+
+        Orderbook tifBook;
+        assert(tifBook.processFixMessage("8=FIX.4.2|35=D|11=1|55=0|54=1|44=100|38=5|59=6|126=5000|", bob) == "ID:");
+        assert(tifBook.processFixMessage("8=FIX.4.2|35=D|11=2|55=0|54=1|44=100|38=5|59=6|126=9000|", bob) == "ID:");
+        assert(tifBook.processFixMessage("8=FIX.4.2|35=D|11=3|55=1|54=2|44=200|38=5|59=0|", bob) == "ID:");
+        assert(tifBook.processFixMessage("8=FIX.4.2|35=D|11=4|55=1|54=2|44=200|38=5|59=1|", bob) == "ID:");
+        assert(tifBook.processFixMessage("8=FIX.4.2|35=D|11=5|55=0|54=2|40=3|99=50|38=1|59=0|", bob) == "ID:");
+        assert(tifBook.processFixMessage("8=FIX.4.2|35=D|11=6|55=0|54=1|44=100|38=5|59=6|", bob) == "ERR"); // no 126
+        assert(tifBook.processFixMessage("8=FIX.4.2|35=D|11=6|55=0|54=1|44=100|38=5|59=2|", bob) == "ERR"); // unsupported
+        assert(tifBook.processFixMessage("8=FIX.4.2|35=U|60=6000|", bob) == "ERR"); // engine-only
+        assert(tifBook.pendingExpiryCount() == 2);
+
+        // A modify keeps the expiry; a fill or cancel drops the timer.
+        assert(tifBook.processFixMessage("8=FIX.4.2|35=G|11=2|55=0|54=1|44=101|38=5|", bob) == "OK");
+        assert(tifBook.pendingExpiryCount() == 2);
+        Orderbook::ExpiredOrders expired;
+        assert(tifBook.expireOrders(4'999, &expired) == 0);
+        assert(tifBook.expireOrders(5'000, &expired) == 1);
+        assert(expired.size() == 1 && expired[0].orderId_ == 1 && expired[0].sessionId_ == bob);
+        assert(tifBook.getBids(0).size() == 1 && tifBook.getBids(0).begin()->first == 101);
+        assert(tifBook.processFixMessage("8=FIX.4.2|35=U|60=9000|") == "EXPIRED:1");
+        assert(tifBook.getBids(0).empty() && tifBook.pendingExpiryCount() == 0);
+
+        assert(tifBook.processFixMessage("8=FIX.4.2|35=D|11=7|55=0|54=1|44=100|38=5|59=6|126=20000|", bob) == "ID:");
+        tifBook.addOrder(std::make_shared<Order>(8, 100, 5, Side::SELL, 0));
+        assert(tifBook.pendingExpiryCount() == 0);
+        assert(tifBook.processFixMessage("8=FIX.4.2|35=D|11=9|55=0|54=1|44=100|38=5|59=6|126=20000|", bob) == "ID:");
+        tifBook.cancelOrder(9);
+        assert(tifBook.pendingExpiryCount() == 0);
+        assert(tifBook.expireOrders(30'000) == 0);
+
+        // End of day: Day orders go, resting and pending stops alike; GTC stays.
+        expired.clear();
+        assert(tifBook.sessionOrderCount(bob) == 3);
+        assert(tifBook.cancelDayOrders(&expired) == 2);
+        assert(expired.size() == 2);
+        assert(tifBook.getAsks(1).size() == 1 && tifBook.getAsks(1).begin()->second.front()->getOrderId() == 4);
+        assert(tifBook.getAsks(1).begin()->second.totalQuantity() == 5);
+        assert(tifBook.pendingStopCount(0) == 0);
+        assert(tifBook.sessionOrderCount(bob) == 1);
+        assert(tifBook.topOfBook(1).askQuantity_ == 5);
+        assert(tifBook.processFixMessage("8=FIX.4.2|35=D|11=3|55=1|54=2|44=200|38=5|59=0|", bob) == "ID:"); // id reusable
+        assert(tifBook.processFixMessage("8=FIX.4.2|35=U|60=40000|59=0|") == "EXPIRED:1");
+    }
+
+    // 13. Memory accounting: live vs reserved slots, high-water mark, per-symbol usage.
+    {
+        Orderbook memoryBook;
+        const auto empty = memoryBook.memoryStats();
+        assert(empty.orderSlotsReserved >= 5'000'000 && empty.orderSlotsLive == 0);
+        assert(empty.orderPoolBytes >= empty.orderSlotsReserved * sizeof(Order));
+        assert(empty.restingOrders == 0 && empty.activeBooks == 0 && empty.controlBlockBytes == 0);
+
+        for (int i = 1; i <= 6; ++i) {
+            const std::string price = std::to_string(100 + i % 3);
+            assert(memoryBook.processFixMessage("8=FIX.4.2|35=D|11=" + std::to_string(i) + "|55=2|54=1|44=" + price +
+                                                "|38=5|") == "ID:");
+        }
+        assert(memoryBook.processFixMessage("8=FIX.4.2|35=D|11=7|55=3|54=2|44=500|38=5|") == "ID:");
+        assert(memoryBook.processFixMessage("8=FIX.4.2|35=D|11=8|55=3|54=2|40=3|99=400|38=5|") == "ID:");
+        auto stats = memoryBook.memoryStats();
+        assert(stats.orderSlotsLive == 8 && stats.orderSlotsHighWater == 8);
+        assert(stats.restingOrders == 7 && stats.priceLevels == 4 && stats.pendingStops == 1);
+        assert(stats.activeBooks == 2 && stats.symbols.size() == 2);
+        assert(stats.symbols[0].symbolId == 2 && stats.symbols[0].bidLevels == 3 && stats.symbols[0].orders == 6);
+        assert(stats.symbols[1].symbolId == 3 && stats.symbols[1].askLevels == 1 && stats.symbols[1].orders == 1);
+        assert(stats.controlBlockBytes > 0 && stats.levelQueueBytes > 0 && stats.priceLevelBytes > 0);
+        assert(stats.totalBytes() > empty.totalBytes());
+
+        memoryBook.cancelOrder(1);
+        memoryBook.cancelOrder(8);
+        stats = memoryBook.memoryStats();
+        assert(stats.orderSlotsLive == 6 && stats.orderSlotsHighWater == 8 && stats.pendingStops == 0);
+    }
+
+    // 14. Trade tape: columnar segments, window queries, spill files, lock-free readers.
+    {
+        using Tape = BasicTradeTape<Price, Quantity>;
+        Tape tape(4, TradeTapeConfig{4, 2, {}});
+        const std::int64_t prices[] = {100, 104, 98, 101, 103, 99, 102};
+        for (std::int64_t i = 0; i < 7; ++i) {
+            tape.append(1, static_cast<Price>(prices[i]), static_cast<Quantity>(i + 1), i % 2 ? Side::SELL : Side::BUY,
+                        1'000 + i * 10);
+        }
+        auto bar = tape.summarize(1, 0, 2'000);
+        assert(bar.trades == 7 && bar.volume == 28 && bar.open == 100 && bar.close == 102);
+        assert(bar.high == 104 && bar.low == 98);
+        assert(bar.notional == 100 * 1 + 104 * 2 + 98 * 3 + 101 * 4 + 103 * 5 + 99 * 6 + 102 * 7);
+        bar = tape.summarize(1, 1'010, 1'030); // [1010, 1030): trades 1 and 2
+        assert(bar.trades == 2 && bar.open == 104 && bar.close == 98 && bar.volume == 5);
+        assert(tape.vwap(1, 1'010, 1'030) == (104.0 * 2 + 98.0 * 3) / 5);
+        assert(tape.summarize(0, 0, 2'000).empty() && tape.summarize(1, 2'000, 3'000).empty());
+        const auto bars = tape.bars(1, 1'000, 1'070, 30);
+        assert(bars.size() == 3 && bars[0].trades == 3 && bars[1].trades == 3 && bars[2].trades == 1);
+        assert(bars[2].endNs == 1'070 && bars[1].open == 101 && bars[1].high == 103);
+
+        // Two segments of four: the ninth trade recycles the first segment.
+        tape.append(1, 100, 1, Side::BUY, 1'070);
+        tape.append(1, 100, 1, Side::BUY, 500); // clock stepped back: kept in order
+        assert(tape.summarize(1, 1'070, 1'071).trades == 2);
+        assert(tape.tradeCount(1) == 9 && tape.summarize(1, 0, 2'000).trades == 5);
+        assert(tape.memoryBytes() > 0 && tape.spilledSegments() == 0);
+
+        // Spilled segments: each segment is a mapped file, unmapped once out of the window.
+        const auto spillDirectory = std::filesystem::temp_directory_path() / "om_trade_tape_test";
+        std::filesystem::remove_all(spillDirectory);
+        std::filesystem::create_directories(spillDirectory);
+        {
+            Tape spilling(4, TradeTapeConfig{4, 2, spillDirectory.string()});
+            for (std::int64_t i = 0; i < 13; ++i) {
+                spilling.append(3, 200, 1, Side::SELL, i);
+            }
+            assert(spilling.spilledSegments() == 2 && spilling.spillFailures() == 0);
+            assert(spilling.summarize(3, 0, 100).trades == 5 && spilling.tradeCount(3) == 13);
+        }
+        for (int sequence = 0; sequence < 4; ++sequence) {
+            std::ifstream file(spillDirectory / ("3-" + std::to_string(sequence) + ".tape"), std::ios::binary);
+            TapeSegmentHeader header{};
+            assert(file.read(reinterpret_cast<char*>(&header), sizeof(header)));
+            assert(std::memcmp(header.magic, kTapeSegmentMagic, sizeof(header.magic)) == 0);
+            assert(header.symbolId == 3 && header.sequence == static_cast<std::uint64_t>(sequence));
+            assert(header.count == (sequence < 3 ? 4u : 1u) && header.priceBytes == sizeof(Price));
+        }
+        // The file mapped ahead for the next segment is removed, as it never held a trade.
+        assert(!std::filesystem::exists(spillDirectory / "3-4.tape"));
+
+        // Rotating faster than the helper maps: segments it has not mapped in time
+        // start on the heap and still reach their files complete.
+        {
+            Tape racing(4, TradeTapeConfig{1, 2, spillDirectory.string()});
+            racing.prepareSymbol(2);
+            for (std::int64_t i = 0; i < 300; ++i) {
+                racing.append(2, static_cast<Price>(i + 1), 1, Side::BUY, i);
+            }
+            assert(racing.summarize(2, 0, 300).trades == 2 && racing.spilledSegments() == 298);
+        }
+        for (int sequence = 0; sequence < 300; ++sequence) {
+            std::ifstream file(spillDirectory / ("2-" + std::to_string(sequence) + ".tape"), std::ios::binary);
+            TapeSegmentHeader header{};
+            assert(file.read(reinterpret_cast<char*>(&header), sizeof(header)));
+            assert(std::memcmp(header.magic, kTapeSegmentMagic, sizeof(header.magic)) == 0);
+            assert(header.sequence == static_cast<std::uint64_t>(sequence) && header.count == 1);
+        }
+        assert(!std::filesystem::exists(spillDirectory / "2-300.tape"));
+        std::filesystem::remove_all(spillDirectory);
+
+        // Readers summarising back to back while the writer recycles segments
+        // underneath them. Each pins only the segment it scans, so overlapping
+        // queries do not stop retired segments from being recycled.
+        Tape shared(1, TradeTapeConfig{64, 4, {}});
+        shared.append(0, 10, 2, Side::BUY, 0);
+        const std::size_t segmentBytes = shared.memoryBytes();
+        std::atomic<bool> done{false};
+        const auto poll = [&] {
+            while (!done.load()) {
+                const auto seen = shared.summarize(0, 0, std::numeric_limits<std::int64_t>::max());
+                assert(seen.trades <= 256 && seen.volume == seen.trades * 2);
+                assert(seen.empty() || (seen.low >= 10 && seen.high <= 20));
+            }
+        };
+        std::thread reader(poll);
+        std::thread otherReader(poll);
+        for (std::int64_t i = 1; i < 200'000; ++i) {
+            shared.append(0, static_cast<Price>(10 + i % 11), 2, Side::BUY, i);
+        }
+        done = true;
+        reader.join();
+        otherReader.join();
+        assert(shared.tradeCount(0) == 200'000);
+        // The window, plus at most one pinned segment per reader and one spare.
+        assert(shared.memoryBytes() <= (4 + 2 + 2) * segmentBytes);
+
+        // The engine records each print at the resting price with the aggressor's side.
+        Orderbook tapeBook;
+        tapeBook.enableTradeTape(TradeTapeConfig{16, 4, {}});
+        bool rejected = false;
+        try {
+            tapeBook.enableTradeTape();
+        } catch (const std::logic_error&) {
+            rejected = true;
+        }
+        assert(rejected);
+        tapeBook.addOrder(std::make_shared<Order>(1, 100, 5, Side::SELL, 2));
+        tapeBook.addOrder(std::make_shared<Order>(2, 101, 5, Side::SELL, 2));
+        tapeBook.addOrder(std::make_shared<Order>(3, 105, 7, Side::BUY, 2));
+        tapeBook.addStopOrder(std::make_shared<Order>(4, 0, 3, Side::BUY, 2), OrderType::Stop, 101);
+        assert(tapeBook.addOrder(std::make_shared<Order>(5, 101, 1, Side::SELL, 2)).empty());
+        tapeBook.addOrder(std::make_shared<Order>(6, 101, 1, Side::BUY, 2)); // prints 101, fires the stop
+        const Orderbook::TradeTape* recorded = tapeBook.tradeTape();
+        assert(recorded->tradeCount(2) == 5);
+        bar = recorded->summarize(2, 0, std::numeric_limits<std::int64_t>::max());
+        assert(bar.trades == 5 && bar.volume == 5 + 2 + 1 + 2 + 1 && bar.open == 100 && bar.close == 101);
+        assert(bar.notional == 100 * 5 + 101 * 6);
+        assert(tapeBook.memoryStats().tradeTapeBytes == recorded->memoryBytes());
+    }
+
+    // 15. Profiled lock policy: acquisitions and waits on the book and pool locks.
+    {
+        ProfiledLock<std::mutex> lock;
+        lock.lock();
+        std::thread waiter([&] {
+            lock.lock();
+            lock.unlock();
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        lock.unlock();
+        waiter.join();
+        const auto waited = lock.contention();
+        assert(waited.acquisitions == 2 && waited.contended == 1 && waited.waitNs > 0);
+        assert(lock.try_lock());
+        lock.unlock();
+        assert(lock.contention().acquisitions == 3);
+
+        ProfiledOrderbook profiledBook;
+        const auto before = profiledBook.lockContention();
+        std::vector<std::thread> producers;
+        for (int t = 0; t < 2; ++t) {
+            producers.emplace_back([&profiledBook, t] {
+                for (int i = 0; i < 1'000; ++i) {
+                    profiledBook.processFixMessage("8=FIX.4.2|35=D|11=" + std::to_string(i * 2 + t + 1) +
+                                                   "|55=4|54=" + (t == 0 ? "1" : "2") + "|44=100|38=1|");
+                }
+            });
+        }
+        for (auto& producer : producers) {
+            producer.join();
+        }
+        const auto contention = profiledBook.lockContention();
+        assert((contention.book - before.book).acquisitions >= 2'000);
+        assert(contention.orderPool.acquisitions - before.orderPool.acquisitions >= 2'000);
+        assert(contention.book.contended <= contention.book.acquisitions);
+    }
+
+    // 16. Structure-of-arrays levels: tombstones, stable handles across compaction, bulk consume,
+    //     and the same trades as the list levels on a randomized flow.
+    {
+        using SoAOrder = SoALevelOrderbook::Order;
+        SoALevel<std::shared_ptr<SoAOrder>> level;
+        std::vector<SoALevel<std::shared_ptr<SoAOrder>>::Handle> handles;
+        for (OrderId id = 1; id <= 100; ++id) {
+            handles.push_back(level.push_back(std::make_shared<SoAOrder>(id, 100, 2, Side::SELL, 0)));
+        }
+        assert(level.size() == 100 && level.totalQuantity() == 200);
+        for (OrderId id = 2; id <= 100; id += 2) {
+            level.erase(handles[id - 1]); // even ids: tombstones, then a compaction
+        }
+        assert(level.size() == 50 && level.totalQuantity() == 100);
+        level.erase(handles[98]); // id 99, located after compaction
+        level.erase(handles[0]);  // id 1, the front
+        assert(level.size() == 48 && level.front()->getOrderId() == 3);
+        std::size_t visited = 0;
+        for (const auto& order : level) {
+            assert(order->getOrderId() % 2 == 1);
+            ++visited;
+        }
+        assert(visited == 48);
+
+        std::vector<std::pair<OrderId, Quantity>> fills;
+        const auto record = [&](const std::shared_ptr<SoAOrder>& order, Quantity quantity) {
+            order->fill(quantity);
+            fills.emplace_back(order->getOrderId(), quantity);
+        };
+        assert(level.consume(73, record) == 73); // 36 whole orders (ids 3..73) and 1 of id 75
+        assert(fills.size() == 37 && fills.front().first == 3 && fills[35] == std::make_pair(OrderId{73}, Quantity{2}));
+        assert(fills.back() == std::make_pair(OrderId{75}, Quantity{1}));
+        assert(level.size() == 12 && level.totalQuantity() == 23 && level.front()->getOrderId() == 75);
+        level.reduce(1);
+        level.front()->fill(1);
+        level.pop_front();
+        assert(level.eraseIf([](const auto& order) { return order->getOrderId() % 4 == 1; }) == 6);
+        assert(level.size() == 5 && level.totalQuantity() == 10 && level.front()->getOrderId() == 79);
+        fills.clear();
+        assert(level.consume(100, record) == 10 && level.empty() && fills.size() == 5);
+        assert(level.memoryBytes() >= level.size());
+
+        // Same flow into both engines: identical trades and books.
+        Orderbook listBook;
+        SoALevelOrderbook soaBook;
+        std::mt19937 rng(7);
+        std::vector<OrderId> placed;
+        for (OrderId id = 1; id <= 20'000; ++id) {
+            const auto action = rng() % 10;
+            const SymbolId symbolId = static_cast<SymbolId>(rng() % 3);
+            const Side side = rng() % 2 == 0 ? Side::BUY : Side::SELL;
+            const Price price = 95 + static_cast<Price>(rng() % 11);
+            const Quantity quantity = 1 + static_cast<Quantity>(rng() % (action == 0 ? 200 : 20));
+            if (action == 1 && !placed.empty()) {
+                const OrderId target = placed[rng() % placed.size()];
+                listBook.cancelOrder(target);
+                soaBook.cancelOrder(target);
+                continue;
+            }
+            if (action == 2) {
+                listBook.addStopOrder(std::make_shared<Order>(id, 0, quantity, side, symbolId), OrderType::Stop, price);
+                soaBook.addStopOrder(std::make_shared<SoAOrder>(id, 0, quantity, side, symbolId), OrderType::Stop, price);
+                continue;
+            }
+            const auto listTrades = listBook.addOrder(std::make_shared<Order>(id, price, quantity, side, symbolId));
+            const auto soaTrades = soaBook.addOrder(std::make_shared<SoAOrder>(id, price, quantity, side, symbolId));
+            assert(listTrades.size() == soaTrades.size());
+            for (std::size_t i = 0; i < listTrades.size(); ++i) {
+                const auto& l = listTrades[i];
+                const auto& r = soaTrades[i];
+                assert(l.getBidTradeInfo().getOrderId() == r.getBidTradeInfo().getOrderId());
+                assert(l.getAskTradeInfo().getOrderId() == r.getAskTradeInfo().getOrderId());
+                assert(l.getBidTradeInfo().getPrice() == r.getBidTradeInfo().getPrice());
+                assert(l.getAskTradeInfo().getPrice() == r.getAskTradeInfo().getPrice());
+                assert(l.getBidTradeInfo().getQuantity() == r.getBidTradeInfo().getQuantity());
+            }
+            placed.push_back(id);
+        }
+        for (SymbolId symbolId = 0; symbolId < 3; ++symbolId) {
+            const auto listTop = listBook.topOfBook(symbolId);
+            const auto soaTop = soaBook.topOfBook(symbolId);
+            assert(listTop.bidPrice_ == soaTop.bidPrice_ && listTop.bidQuantity_ == soaTop.bidQuantity_);
+            assert(listTop.askPrice_ == soaTop.askPrice_ && listTop.askQuantity_ == soaTop.askQuantity_);
+            assert(listTop.lastTradePrice_ == soaTop.lastTradePrice_);
+            assert(listBook.getBids(symbolId).size() == soaBook.getBids(symbolId).size());
+            auto soaLevel = soaBook.getBids(symbolId).begin();
+            for (const auto& [price, orders] : listBook.getBids(symbolId)) {
+                assert(soaLevel->first == price && soaLevel->second.size() == orders.size());
+                assert(soaLevel->second.totalQuantity() == orders.totalQuantity());
+                ++soaLevel;
+            }
+            assert(listBook.pendingStopCount(symbolId) == soaBook.pendingStopCount(symbolId));
+        }
+        assert(listBook.memoryStats().restingOrders == soaBook.memoryStats().restingOrders);
+    }
+
+    // 17. Pre-trade risk checks: each limit, exposure through fills, cancels and stops.
+    {
+        Orderbook book;
+        const auto order = [](std::uint64_t id, int side, std::uint32_t price, std::uint32_t qty, int account) {
+            return "8=FIX.4.2|35=D|11=" + std::to_string(id) + "|55=1|54=" + std::to_string(side) +
+                   "|44=" + std::to_string(price) + "|38=" + std::to_string(qty) + "|1=" + std::to_string(account) + "|";
+        };
+        // Without risk checks tag 1 is accepted and nothing is limited.
+        assert(book.processFixMessage(order(1, 1, 100, 1'000'000, 7)) == "ID:");
+        book.cancelOrder(1);
+        assert(!book.riskChecksEnabled());
+
+        RiskConfig config;
+        config.accountCount = 4;
+        config.defaultLimits.maxOrderQuantity = 100;
+        book.enableRiskChecks(config);
+        assert(book.riskChecksEnabled());
+        RiskLimits limits;
+        limits.maxOrderQuantity = 50;
+        limits.maxOrderNotional = 4'000;
+        limits.priceBandBps = 1'000; // 10%
+        limits.maxOpenOrders = 3;
+        limits.maxNetPosition = 60;
+        book.setAccountLimits(1, limits);
+
+        assert(book.processFixMessage(order(2, 1, 100, 101, 0)) == "RISK:ORDER_QTY");
+        assert(book.processFixMessage(order(3, 1, 100, 10, 9)) == "RISK:UNKNOWN_ACCOUNT");
+        assert(book.processFixMessage(order(4, 1, 100, 51, 1)) == "RISK:ORDER_QTY");
+        assert(book.processFixMessage(order(5, 1, 100, 41, 1)) == "RISK:ORDER_NOTIONAL");
+        assert(book.processFixMessage("8=FIX.4.2|35=D|11=6|55=1|54=1|44=100|38=1|1=x|") == "ERR");
+        assert(book.memoryStats().restingOrders == 0);
+
+        // No trade and an empty book: no reference price, so no band yet.
+        assert(book.processFixMessage(order(10, 1, 100, 20, 1)) == "ID:");
+        assert(book.processFixMessage(order(11, 2, 110, 20, 1)) == "ID:"); // banded around the bid
+        assert(book.processFixMessage(order(12, 1, 94, 20, 1)) == "RISK:PRICE_BAND"); // mid 105 is the reference
+        assert(book.processFixMessage(order(13, 1, 95, 20, 1)) == "ID:");
+        assert(book.accountOpenOrders(1) == 3);
+        assert(book.processFixMessage(order(14, 2, 110, 1, 1)) == "RISK:OPEN_ORDERS");
+        RiskExposure exposure = book.riskExposure(1, 1);
+        assert(exposure.position == 0 && exposure.openBuyQuantity == 40 && exposure.openSellQuantity == 20);
+
+        // Fills move open quantity into the position of both accounts.
+        assert(book.processFixMessage(order(20, 2, 100, 15, 2)) == "ID:");
+        exposure = book.riskExposure(1, 1);
+        assert(exposure.position == 15 && exposure.openBuyQuantity == 25 && exposure.openSellQuantity == 20);
+        assert(book.accountOpenOrders(1) == 3);
+        assert(book.riskExposure(2, 1).position == -15 && book.accountOpenOrders(2) == 0);
+
+        // Last trade (100) is now the reference; a buy counts every open buy as filled.
+        book.cancelOrder(11);
+        assert(book.accountOpenOrders(1) == 2 && book.riskExposure(1, 1).openSellQuantity == 0);
+        assert(book.processFixMessage(order(21, 1, 100, 21, 1)) == "RISK:NET_POSITION"); // 15 + 25 + 21 > 60
+        assert(book.processFixMessage(order(22, 1, 100, 20, 1)) == "ID:");
+        assert(book.processFixMessage(order(23, 1, 111, 1, 1)) == "RISK:PRICE_BAND");
+        // Sells are limited on the short side, where the long position helps: 39 - 15 is within 60.
+        book.cancelOrder(10);
+        book.cancelOrder(13);
+        assert(book.accountOpenOrders(1) == 1 && book.riskExposure(1, 1).openBuyQuantity == 20);
+        assert(book.processFixMessage(order(24, 2, 101, 39, 1)) == "ID:");
+
+        // A modify is re-checked as a new order; a refused replacement leaves the original resting.
+        assert(book.processFixMessage("8=FIX.4.2|35=G|11=22|55=1|54=1|44=100|38=45|") == "RISK:ORDER_NOTIONAL");
+        assert(book.accountOpenOrders(1) == 2 && book.riskExposure(1, 1).openBuyQuantity == 20);
+        const auto bid = book.getBids(1).find(100);
+        assert(bid != book.getBids(1).end() && bid->second.size() == 1);
+        // The original's exposure is not counted against its replacement: 15 + 40 is within 60.
+        assert(book.processFixMessage("8=FIX.4.2|35=G|11=22|55=1|54=1|44=100|38=40|") == "OK");
+        assert(book.accountOpenOrders(1) == 2 && book.riskExposure(1, 1).openBuyQuantity == 40);
+        book.cancelOrder(22);
+        assert(book.accountOpenOrders(1) == 1);
+        assert(book.processFixMessage("8=FIX.4.2|35=G|11=24|55=1|54=2|44=102|38=30|") == "OK");
+        exposure = book.riskExposure(1, 1);
+        assert(exposure.openBuyQuantity == 0 && exposure.openSellQuantity == 30);
+
+        // Stops are checked when parked and hold exposure until they fire or cancel.
+        assert(book.processFixMessage("8=FIX.4.2|35=D|11=30|55=1|54=2|40=3|99=80|38=5|1=1|") == "RISK:PRICE_BAND");
+        assert(book.processFixMessage("8=FIX.4.2|35=D|11=31|55=1|54=2|40=3|99=95|38=5|1=1|") == "ID:");
+        assert(book.accountOpenOrders(1) == 2 && book.riskExposure(1, 1).openSellQuantity == 35);
+        assert(book.processFixMessage(order(32, 1, 95, 3, 3)) == "ID:");   // resting bid for the stop
+        assert(book.processFixMessage(order(33, 2, 95, 1, 3)) == "ID:");   // prints 95, fires the stop
+        exposure = book.riskExposure(1, 1);
+        assert(exposure.position == 13 && exposure.openSellQuantity == 30); // stop sold 2, rest dropped
+        assert(book.accountOpenOrders(1) == 1);
+        assert(book.riskExposure(3, 1).position == 2 && book.accountOpenOrders(3) == 0);
+
+        assert(book.memoryStats().riskBytes > 0);
+        bool threw = false;
+        try {
+            book.setAccountLimits(4, limits);
+        } catch (const std::out_of_range&) {
+            threw = true;
+        }
+        assert(threw);
+        threw = false;
+        try {
+            book.enableRiskChecks();
+        } catch (const std::logic_error&) {
+            threw = true;
+        }
+        assert(threw);
+
+        // A modify racing trades that move the band reference is refused or
+        // applied whole; it never loses the original.
+        Orderbook racedBook;
+        racedBook.enableRiskChecks();
+        RiskLimits band;
+        band.priceBandBps = 1'000;
+        racedBook.setAccountLimits(1, band);
+        assert(racedBook.processFixMessage("8=FIX.4.2|35=D|11=1|55=0|54=1|44=95|38=1|1=1|") == "ID:");
+        std::atomic<bool> trading{true};
+        std::thread printer([&] {
+            for (OrderId id = 10; trading.load(); id += 2) {
+                const bool high = id % 4 == 0; // prints alternate at 130 (band shut) and 100 (band open)
+                const std::string price = high ? "130" : "100";
+                const std::string first = high ? "2" : "1";
+                const std::string second = high ? "1" : "2";
+                racedBook.processFixMessage("8=FIX.4.2|35=D|11=" + std::to_string(id) + "|55=0|54=" + first +
+                                            "|44=" + price + "|38=1|1=2|");
+                racedBook.processFixMessage("8=FIX.4.2|35=D|11=" + std::to_string(id + 1) + "|55=0|54=" + second +
+                                            "|44=" + price + "|38=1|1=2|");
+            }
+        });
+        for (int i = 0; i < 2'000; ++i) {
+            const std::string reply = racedBook.processFixMessage("8=FIX.4.2|35=G|11=1|55=0|54=1|44=" +
+                                                                  std::to_string(95 + i % 2) + "|38=1|");
+            assert(reply == "OK" || reply == "RISK:PRICE_BAND");
+            assert(racedBook.accountOpenOrders(1) == 1);
+        }
+        trading = false;
+        printer.join();
+        assert(racedBook.accountOpenOrders(2) == 0 && racedBook.riskExposure(2, 0).position == 0);
+    }
+
+    // 18. IOC, FOK and market orders sweep without resting, on list and structure-of-arrays levels.
+    {
+        const auto immediateOrders = [](auto& book) {
+            book.enableRiskChecks();
+            assert(book.processFixMessage("8=FIX.4.2|35=D|11=1|55=0|54=2|44=101|38=5|") == "ID:");
+            assert(book.processFixMessage("8=FIX.4.2|35=D|11=2|55=0|54=2|44=102|38=5|") == "ID:");
+            assert(book.processFixMessage("8=FIX.4.2|35=D|11=3|55=0|54=2|44=104|38=5|") == "ID:");
+            assert(book.processFixMessage("8=FIX.4.2|35=D|11=4|55=0|54=1|44=99|38=5|") == "ID:");
+
+            // IOC takes what crosses its price and leaves nothing behind.
+            assert(book.processFixMessage("8=FIX.4.2|35=D|11=10|55=0|54=1|44=102|38=8|59=3|1=1|") == "FILL:8");
+            assert(book.memoryStats().restingOrders == 3);
+            assert(book.getBids(0).size() == 1 && book.topOfBook(0).askPrice_ == 102);
+            assert(book.topOfBook(0).askQuantity_ == 2 && book.topOfBook(0).lastTradePrice_ == 102);
+            assert(book.riskExposure(1, 0).position == 8 && book.riskExposure(1, 0).openBuyQuantity == 0);
+            assert(book.accountOpenOrders(1) == 0);
+
+            // FOK: 7 available up to 104, so 8 is killed untouched and 7 fills.
+            assert(book.processFixMessage("8=FIX.4.2|35=D|11=11|55=0|54=1|44=104|38=8|59=4|") == "FILL:0");
+            assert(book.memoryStats().restingOrders == 3 && book.topOfBook(0).askQuantity_ == 2);
+            assert(book.processFixMessage("8=FIX.4.2|35=D|11=12|55=0|54=1|44=104|38=7|59=4|") == "FILL:7");
+            assert(book.getAsks(0).empty());
+
+            // Market orders need no price and are IOC unless FOK.
+            assert(book.processFixMessage("8=FIX.4.2|35=D|11=13|55=0|54=2|40=1|38=10|") == "FILL:5");
+            assert(book.getBids(0).empty() && book.memoryStats().restingOrders == 0);
+            assert(book.processFixMessage("8=FIX.4.2|35=D|11=14|55=0|54=2|40=1|38=10|") == "FILL:0");
+            assert(book.processFixMessage("8=FIX.4.2|35=D|11=15|55=0|54=1|38=1|59=3|") == "ERR");
+            assert(book.processFixMessage("8=FIX.4.2|35=D|11=16|55=0|54=1|40=3|99=100|38=1|59=3|") == "ERR");
+
+            // The ids never went live and can be reused.
+            assert(book.processFixMessage("8=FIX.4.2|35=D|11=10|55=0|54=2|44=100|38=4|") == "ID:");
+            const auto trades = book.addOrder([] {
+                auto order = std::make_shared<typename std::remove_reference_t<decltype(book)>::Order>(
+                    20, 101, 3, Side::BUY, 0);
+                order->setTimeInForce(TimeInForce::ImmediateOrCancel);
+                return order;
+            }());
+            assert(trades.size() == 1 && trades[0].getBidTradeInfo().getPrice() == 101);
+            assert(trades[0].getAskTradeInfo().getPrice() == 100 && trades[0].getAskTradeInfo().getQuantity() == 3);
+            assert(book.topOfBook(0).askQuantity_ == 1 && book.memoryStats().restingOrders == 1);
+        };
+        Orderbook listBook;
+        immediateOrders(listBook);
+        SoALevelOrderbook soaBook;
+        immediateOrders(soaBook);
+
+        // A market order's notional is what its sweep takes across levels, not the touch times its quantity.
+        Orderbook sweepBook;
+        RiskConfig config;
+        config.defaultLimits.maxOrderNotional = 1'000;
+        sweepBook.enableRiskChecks(config);
+        assert(sweepBook.processFixMessage("8=FIX.4.2|35=D|11=1|55=0|54=2|44=100|38=5|") == "ID:");
+        assert(sweepBook.processFixMessage("8=FIX.4.2|35=D|11=2|55=0|54=2|44=190|38=5|") == "ID:");
+        assert(sweepBook.processFixMessage("8=FIX.4.2|35=D|11=3|55=0|54=1|44=190|38=10|59=3|") == "RISK:ORDER_NOTIONAL");
+        assert(sweepBook.processFixMessage("8=FIX.4.2|35=D|11=3|55=0|54=1|40=1|38=10|") == "RISK:ORDER_NOTIONAL"); // 1450
+        assert(sweepBook.getAsks(0).size() == 2);
+        assert(sweepBook.processFixMessage("8=FIX.4.2|35=D|11=3|55=0|54=1|40=1|38=7|") == "FILL:7"); // 500 + 380
+        assert(sweepBook.topOfBook(0).askPrice_ == 190 && sweepBook.topOfBook(0).askQuantity_ == 3);
+    }
+
     std::cout << "All tests passed!\n";
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,178 @@
+#include "Orderbook.h"
+#include "Replication.h"
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+namespace {
+
+bool sameLevels(const Orderbook& a, const Orderbook& b, SymbolId symbol) {
+    const auto& bidsA = a.getBids(symbol);
+    const auto& bidsB = b.getBids(symbol);
+    const auto& asksA = a.getAsks(symbol);
+    const auto& asksB = b.getAsks(symbol);
+    if (bidsA.size() != bidsB.size() || asksA.size() != asksB.size()) {
+        return false;
+    }
+    for (auto itA = bidsA.begin(), itB = bidsB.begin(); itA != bidsA.end(); ++itA, ++itB) {
+        if (itA->first != itB->first || itA->second.size() != itB->second.size()) {
+            return false;
+        }
+    }
+    for (auto itA = asksA.begin(), itB = asksB.begin(); itA != asksA.end(); ++itA, ++itB) {
+        if (itA->first != itB->first || itA->second.size() != itB->second.size()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string newOrder(std::uint64_t id) {
+    return "8=FIX.4.2|35=D|11=" + std::to_string(id) + "|55=1|54=1|44=50|38=1|";
+}
+
+// Trimming runs on the streaming thread, so give it a few idle polls.
+bool waitForTrim(const ReplicationPrimary& primary) {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (primary.firstJournaledSequence() == 1) {
+        if (std::chrono::steady_clock::now() >= deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    return true;
+}
+
+} // namespace
+
+int main() {
+    const std::string endpoint = "unix:/tmp/orderbook_replication_test_" + std::to_string(getpid()) + ".sock";
+
+    Orderbook primaryBook;
+    Orderbook standbyBook;
+
+    ReplicationPrimary primary(endpoint, ReplicationMode::SemiSync, std::chrono::seconds(5));
+    primary.start();
+
+    std::uint64_t standbyApplied = 0;
+    std::thread standbyThread([&] {
+        ReplicationStandby standby(endpoint, standbyBook, 16);
+        standbyApplied = standby.run(std::chrono::seconds(5));
+    });
+
+    // 1. Commands published before the standby attaches are replayed from the journal.
+    const std::string early = "8=FIX.4.2|35=D|11=1|55=0|54=1|44=100|38=5|";
+    primaryBook.processFixMessage(early);
+    primary.publish(early);
+
+    // 2. Semi-sync: wait for the standby to ack each burst.
+    for (int i = 2; i <= 200; ++i) {
+        const std::string side = (i % 3 == 0) ? "2" : "1";
+        const std::string message = "8=FIX.4.2|35=D|11=" + std::to_string(i) + "|55=" + std::to_string(i % 4) +
+                                    "|54=" + side + "|44=" + std::to_string(95 + i % 10) + "|38=3|";
+        primaryBook.processFixMessage(message);
+        primary.publish(message);
+    }
+    // Session ownership travels with each command, so mass cancels replay identically.
+    const SessionId session = 7;
+    for (int i = 500; i < 503; ++i) {
+        const std::string owned = "8=FIX.4.2|35=D|11=" + std::to_string(i) + "|55=0|54=1|44=90|38=1|";
+        primaryBook.processFixMessage(owned, session);
+        primary.publish(owned, session);
+        if (i == 501) {
+            const std::string massCancel = "8=FIX.4.2|35=q|530=7|";
+            assert(primaryBook.processFixMessage(massCancel, session) == "CXL:2");
+            primary.publish(massCancel, session);
+        }
+    }
+
+    // Expiry replays through published clock ticks; quiet ticks stay off the journal.
+    for (int i = 600; i < 603; ++i) {
+        const std::string timed = "8=FIX.4.2|35=D|11=" + std::to_string(i) + "|55=3|54=1|44=80|38=1|59=6|126=" +
+                                  std::to_string(1'000 * (i - 599)) + "|";
+        primaryBook.processFixMessage(timed, session);
+        primary.publish(timed, session);
+    }
+    const std::string dayOrder = "8=FIX.4.2|35=D|11=603|55=3|54=2|44=300|38=1|59=0|";
+    primaryBook.processFixMessage(dayOrder, session);
+    primary.publish(dayOrder, session);
+    assert(primaryBook.expireOrders(500) == 0);
+    const std::string tick = "8=FIX.4.2|35=U|60=2500|59=0|";
+    assert(primaryBook.processFixMessage(tick) == "EXPIRED:3");
+    primary.publish(tick);
+
+    const std::string cancel = "8=FIX.4.2|35=F|11=1|";
+    primaryBook.processFixMessage(cancel);
+    const std::uint64_t last = primary.publish(cancel);
+
+    while (!primary.standbyAttached()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    assert(primary.waitForAck(last));
+    assert(primary.ackedSequence() == last);
+
+    // 3. Primary goes away; the standby returns with identical state.
+    primary.stop();
+    standbyThread.join();
+    assert(standbyApplied == last);
+    for (SymbolId symbol = 0; symbol < 4; ++symbol) {
+        assert(sameLevels(primaryBook, standbyBook, symbol));
+    }
+    assert(standbyBook.sessionOrderCount(session) == 2);
+    assert(standbyBook.pendingExpiryCount() == 1);
+
+    // 4. The journal is trimmed once the standby has acked, past a retention window.
+    const std::size_t retained = 8;
+    const std::uint64_t commands = 20'000;
+    {
+        Orderbook book;
+        ReplicationPrimary trimmed(endpoint, ReplicationMode::Async, std::chrono::seconds(5), retained);
+        trimmed.start();
+        std::uint64_t applied = 0;
+        std::thread follower([&] {
+            ReplicationStandby standby(endpoint, book);
+            applied = standby.run(std::chrono::seconds(5));
+        });
+        while (!trimmed.standbyAttached()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        for (std::uint64_t i = 0; i < commands; ++i) {
+            trimmed.publish(newOrder(10'000 + i));
+        }
+        assert(trimmed.waitForAck(commands));
+        assert(waitForTrim(trimmed));
+        assert(trimmed.firstJournaledSequence() <= commands - retained + 1);
+        trimmed.stop();
+        follower.join();
+        assert(applied == commands);
+    }
+
+    // 5. A standby attaching after a trim cannot rebuild the book, so it reports
+    //    divergence instead of returning as if it could take over.
+    {
+        Orderbook book;
+        ReplicationPrimary trimmed(endpoint, ReplicationMode::Async, std::chrono::seconds(5), retained);
+        trimmed.start();
+        for (std::uint64_t i = 0; i < commands; ++i) {
+            trimmed.publish(newOrder(10'000 + i));
+        }
+        assert(waitForTrim(trimmed));
+
+        ReplicationStandby late(endpoint, book);
+        bool diverged = false;
+        try {
+            late.run(std::chrono::seconds(5));
+        } catch (const ReplicationDivergence&) {
+            diverged = true;
+        }
+        assert(diverged);
+        assert(late.appliedSequence() == 0);
+        trimmed.stop();
+    }
+
+    std::cout << "All tests passed!\n";
+    return 0;
+}
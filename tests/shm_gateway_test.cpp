@@ -0,0 +1,230 @@
+#include "Orderbook.h"
+#include "ShmClient.h"
+#include "ShmGateway.h"
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+
+namespace {
+
+// Answered by pump() with a reply far larger than the request.
+constexpr std::string_view kBigReplyRequest = "BIG";
+const std::string kBigReply(200, 'r');
+
+// One engine step, as Server::runShm does it.
+std::size_t pump(ShmGateway& gateway, Orderbook& book) {
+    const std::size_t handled = gateway.poll([&](std::uint32_t slot, std::string_view frame, std::string& reply) {
+        reply = frame == kBigReplyRequest ? kBigReply : book.processFixMessage(frame, Shm::engineSessionId(slot));
+    });
+    gateway.flush();
+    return handled;
+}
+
+std::string newOrder(int id, const char* side, int price, int quantity) {
+    return "8=FIX.4.2|35=D|11=" + std::to_string(id) + "|55=0|54=" + side + "|44=" + std::to_string(price) +
+           "|38=" + std::to_string(quantity) + "|";
+}
+
+} // namespace
+
+int main() {
+    const std::string name = "orderbook_shm_test_" + std::to_string(getpid());
+
+    // 1. Rings wrap with a pad record and refuse frames that do not fit.
+    {
+        Shm::Segment segment = Shm::Segment::create(name + "_ring", 1, 64);
+        Shm::Ring producer = segment.requestRing(0);
+        Shm::Ring consumer = segment.requestRing(0);
+        assert(producer.maxFrameBytes() == 28);
+        assert(!producer.tryPush(std::string(29, 'x')));
+
+        std::string_view frame;
+        assert(!consumer.front(frame));
+        for (int round = 0; round < 20; ++round) {
+            const std::string a(1 + round % 20, 'a');
+            const std::string b(1 + (round * 7) % 20, 'b');
+            assert(producer.tryPush(a));
+            assert(producer.tryPush(b));
+            assert(consumer.front(frame) && frame == a);
+            consumer.pop();
+            assert(consumer.front(frame) && frame == b);
+            consumer.pop();
+            assert(consumer.empty());
+        }
+
+        // Full: 64 bytes hold two 24-byte records but not a third.
+        assert(producer.tryPush(std::string(20, 'c')));
+        assert(producer.tryPush(std::string(20, 'd')));
+        assert(!producer.tryPush(std::string(20, 'e')));
+        assert(consumer.front(frame) && frame == std::string(20, 'c'));
+        consumer.pop();
+        assert(producer.tryPush(std::string(20, 'e')));
+    }
+
+    Orderbook book;
+    ShmGatewayConfig config;
+    config.name = name;
+    config.slots = 2;
+    config.ringBytes = 4096;
+    ShmGateway gateway(config);
+    assert(gateway.slotCount() == 2);
+
+    // 2. Orders round-trip and belong to the slot's session.
+    {
+        ShmClient client(name);
+        assert(client.slot() == 0);
+        assert(client.send(newOrder(1, "1", 100, 5)));
+        assert(client.send(newOrder(2, "2", 105, 5)));
+        assert(pump(gateway, book) == 2);
+
+        std::string reply;
+        assert(client.receive(reply) && reply == "ID:");
+        assert(client.receive(reply) && reply == "ID:");
+        assert(!client.receive(reply, std::chrono::microseconds(0), 0));
+        assert(book.sessionOrderCount(client.engineSession()) == 2);
+
+        // 3. A second client gets its own slot; a third finds none.
+        ShmClient other(name);
+        assert(other.slot() == 1 && other.engineSession() != client.engineSession());
+        bool threw = false;
+        try {
+            ShmClient third(name);
+        } catch (const std::runtime_error&) {
+            threw = true;
+        }
+        assert(threw);
+        assert(gateway.reapClosedSlots().empty());
+    }
+
+    // 4. Detached clients are reaped and their slot is reused.
+    {
+        const auto closed = gateway.reapClosedSlots();
+        assert(closed.size() == 2 && closed[0] == 0 && closed[1] == 1);
+        assert(book.cancelSessionOrders(Shm::engineSessionId(0)) == 2);
+        ShmClient client(name);
+        assert(client.slot() == 0);
+    }
+    assert(gateway.reapClosedSlots().size() == 1);
+
+    // 5. A client process that dies without detaching is reaped too.
+    {
+        const pid_t child = fork();
+        if (child == 0) {
+            ShmClient client(name);
+            _exit(client.send(newOrder(3, "1", 99, 1)) ? 0 : 1);
+        }
+        int status = 0;
+        assert(waitpid(child, &status, 0) == child && WIFEXITED(status) && WEXITSTATUS(status) == 0);
+        const auto closed = gateway.reapClosedSlots();
+        assert(closed.size() == 1 && closed[0] == 0);
+        assert(pump(gateway, book) == 0); // its unread request went with it
+    }
+
+    // 6. A client that stops reading stalls only itself.
+    {
+        ShmClient slow(name);
+        ShmClient fast(name);
+        std::size_t sent = 0;
+        while (slow.send(kBigReplyRequest)) {
+            ++sent;
+        }
+        assert(sent == 4096 / 8);
+        // 19 replies of 208 bytes fill the response ring; the 20th is queued
+        // and the slot is not read again until it drains.
+        assert(pump(gateway, book) == 20);
+        assert(!gateway.flush());
+        assert(pump(gateway, book) == 0);
+
+        assert(fast.send(newOrder(4, "1", 98, 1)));
+        assert(pump(gateway, book) == 1);
+        std::string reply;
+        assert(fast.receive(reply) && reply == "ID:");
+
+        std::size_t received = 0;
+        while (received < sent) {
+            if (slow.receive(reply, std::chrono::microseconds(0), 0)) {
+                assert(reply == kBigReply);
+                ++received;
+            } else {
+                pump(gateway, book);
+            }
+        }
+        assert(gateway.flush());
+    }
+    gateway.reapClosedSlots();
+
+    // 7. Both sides sleep on their doorbells when idle and are woken by the other.
+    {
+        std::atomic<bool> stop{false};
+        std::thread engine([&] {
+            while (!stop.load()) {
+                if (pump(gateway, book) == 0) {
+                    gateway.wait(std::chrono::milliseconds(50));
+                }
+            }
+        });
+
+        ShmClient client(name);
+        std::string reply;
+        for (int i = 0; i < 200; ++i) {
+            assert(client.request(newOrder(100 + i, "2", 200 + i % 5, 1), reply, std::chrono::seconds(5)));
+            assert(reply == "ID:");
+            if (i % 50 == 0) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(60)); // let the engine fall asleep
+            }
+        }
+        assert(client.request("8=FIX.4.2|35=q|530=7|", reply, std::chrono::seconds(5)) && reply == "CXL:200");
+
+        stop.store(true);
+        client.send(kBigReplyRequest); // wake the engine so it sees the flag
+        engine.join();
+    }
+
+    // 8. Opening a missing segment fails.
+    {
+        bool threw = false;
+        try {
+            ShmClient client(name + "_missing");
+        } catch (const std::runtime_error&) {
+            threw = true;
+        }
+        assert(threw);
+    }
+
+    // 9. A claim names its process in the same word, and a client that
+    //    publishes a record the ring cannot hold loses its slot.
+    gateway.reapClosedSlots();
+    {
+        ShmClient client(name);
+        Shm::Segment view = Shm::Segment::open(name);
+        Shm::SlotHeader& header = view.slot(client.slot());
+        const std::uint64_t owner = header.owner.load();
+        assert(Shm::ownerState(owner) == Shm::SlotState::Claimed && Shm::ownerPid(owner) == std::uint32_t(getpid()));
+
+        assert(client.send(newOrder(5, "1", 97, 1)));
+        char* ring = reinterpret_cast<char*>(&header) + sizeof(Shm::SlotHeader);
+        const std::uint64_t tail = header.request.tail.load();
+        const std::uint32_t bogusLength = 3000; // past maxFrameBytes() of a 4096-byte ring
+        std::memcpy(ring + (tail & 4095), &bogusLength, sizeof(bogusLength));
+        header.request.tail.store(tail + 8);
+
+        assert(pump(gateway, book) == 1); // the good frame ahead of it is still served
+        std::string reply;
+        assert(client.receive(reply) && reply == "ID:");
+        assert(Shm::ownerState(header.owner.load()) == Shm::SlotState::Closed);
+        const auto closed = gateway.reapClosedSlots();
+        assert(closed.size() == 1 && closed[0] == client.slot());
+        assert(book.cancelSessionOrders(client.engineSession()) == 1);
+    }
+    assert(gateway.reapClosedSlots().empty()); // the freed slot is not closed a second time
+
+    std::cout << "All shared-memory gateway tests passed!" << std::endl;
+    return 0;
+}
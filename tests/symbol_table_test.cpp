@@ -0,0 +1,76 @@
+#include "SymbolTable.h"
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+int main() {
+    // 1. Empty table resolves nothing.
+    SymbolTable empty;
+    assert(empty.resolve("NVDA") == kInvalidSymbolId);
+
+    // 2. Tickers get dense ids in load order.
+    SymbolTable table({"NVDA", "AAPL", "BRK.B", "ABCDEFGHIJKLMNOP"});
+    assert(table.size() == 4);
+    assert(table.resolve("NVDA") == 0);
+    assert(table.resolve("AAPL") == 1);
+    assert(table.resolve("BRK.B") == 2);
+    assert(table.resolve("ABCDEFGHIJKLMNOP") == 3); // full 16-byte key
+    assert(table.ticker(1) == "AAPL");
+
+    // 3. Misses: unknown, prefix, too long, empty.
+    assert(table.resolve("MSFT") == kInvalidSymbolId);
+    assert(table.resolve("NVD") == kInvalidSymbolId);
+    assert(table.resolve("NVDAX") == kInvalidSymbolId);
+    assert(table.resolve("ABCDEFGHIJKLMNOPQ") == kInvalidSymbolId);
+    assert(table.resolve("") == kInvalidSymbolId);
+
+    // 4. Realistic universes (random 1-5 letter tickers, some with a class
+    //    suffix) stay collision-free with about one slot per ticker.
+    std::mt19937 rng(26);
+    std::set<std::string> unique;
+    while (unique.size() < 30'000) {
+        std::string ticker;
+        const std::size_t length = 1 + rng() % 5;
+        for (std::size_t i = 0; i < length; ++i) {
+            ticker.push_back(static_cast<char>('A' + rng() % 26));
+        }
+        if (rng() % 20 == 0) {
+            ticker += rng() % 2 == 0 ? ".A" : ".B";
+        }
+        unique.insert(ticker);
+    }
+    std::vector<std::string> tickers(unique.begin(), unique.end());
+    std::shuffle(tickers.begin(), tickers.end(), rng);
+    const auto buildStart = std::chrono::steady_clock::now();
+    SymbolTable big(tickers);
+    const auto buildTime = std::chrono::steady_clock::now() - buildStart;
+    assert(buildTime < std::chrono::seconds(2)); // a one-level perfect hash took minutes here
+    assert(big.memoryBytes() < tickers.size() * 40);
+    for (std::size_t i = 0; i < tickers.size(); ++i) {
+        assert(big.resolve(tickers[i]) == static_cast<SymbolId>(i));
+    }
+    std::size_t misses = 0;
+    for (int i = 0; i < 10'000; ++i) {
+        const std::string probe = "Q" + std::to_string(i);
+        misses += big.resolve(probe) == kInvalidSymbolId ? 1 : 0;
+    }
+    assert(misses == 10'000);
+
+    // 5. Duplicates are rejected at load time.
+    bool threw = false;
+    try {
+        SymbolTable dup({"NVDA", "NVDA"});
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    assert(threw);
+
+    std::cout << "All tests passed!\n";
+    return 0;
+}
@@ -0,0 +1,163 @@
+#include "UdpProtocol.h"
+#include <cassert>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+std::string datagram(std::uint32_t sessionId, std::uint64_t sequence, std::string_view body) {
+    Udp::Header header{};
+    header.sessionId = sessionId;
+    header.sequence = sequence;
+    std::string out(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.append(body);
+    return out;
+}
+
+Udp::Header headerOf(const std::string& reply) {
+    assert(reply.size() >= sizeof(Udp::Header));
+    Udp::Header header{};
+    std::memcpy(&header, reply.data(), sizeof(header));
+    return header;
+}
+
+std::string_view bodyOf(const std::string& reply) {
+    return std::string_view(reply).substr(sizeof(Udp::Header));
+}
+
+// Records what the sequencer applies and answers with a numbered line.
+struct Recorder {
+    std::vector<std::string> frames;
+    std::vector<std::uint32_t> sessions;
+
+    std::string operator()(std::string_view frame, std::uint32_t session) {
+        frames.emplace_back(frame);
+        sessions.push_back(session);
+        return "R" + std::to_string(frames.size());
+    }
+};
+
+} // namespace
+
+int main() {
+    Udp::Sequencer sequencer;
+    Recorder recorder;
+    std::vector<std::uint32_t> expired;
+    std::string reply;
+    const std::uint64_t client = Udp::peerKey(0x0100007f, 4000);
+    auto now = Udp::Sequencer::Clock::now();
+    const auto expire = [&](std::uint32_t session) {
+        expired.push_back(session);
+        recorder.frames.emplace_back("EXPIRED");
+        recorder.sessions.push_back(session);
+    };
+    const auto handleFrom = [&](Udp::Sequencer& target, std::uint64_t peer, const std::string& input) {
+        target.handle(
+            input, peer, now, reply,
+            [&](std::string_view frame, std::uint32_t session) { return recorder(frame, session); }, expire);
+    };
+    const auto handle = [&](const std::string& input) { handleFrom(sequencer, client, input); };
+
+    // 1. The expected sequence applies every non-empty frame under the engine session.
+    handle(datagram(7, 1, "A\r\nB\n\nC"));
+    assert(recorder.frames == (std::vector<std::string>{"A", "B", "C"}));
+    assert(recorder.sessions[0] == Udp::engineSessionId(7) && (recorder.sessions[0] & Udp::kEngineSessionBit));
+    Udp::Header header = headerOf(reply);
+    assert(header.flags == Udp::kFlagReply && header.sessionId == 7 && header.sequence == 1);
+    assert(bodyOf(reply) == "R1\nR2\nR3\n");
+    const std::string firstReply = reply;
+    assert(sequencer.session(7)->expectedSequence == 2);
+
+    // 2. Resending the last sequence replays its reply without re-applying.
+    handle(datagram(7, 1, "A\nB\nC"));
+    assert(recorder.frames.size() == 3);
+    header = headerOf(reply);
+    assert(header.flags == (Udp::kFlagReply | Udp::kFlagResent) && header.sequence == 1);
+    assert(bodyOf(reply) == bodyOf(firstReply));
+
+    handle(datagram(7, 2, "D"));
+    assert(recorder.frames.size() == 4 && bodyOf(reply) == "R4\n");
+
+    // 3. Older sequences are duplicates: header only, nothing applied.
+    handle(datagram(7, 1, "A"));
+    header = headerOf(reply);
+    assert(header.flags == (Udp::kFlagReply | Udp::kFlagDuplicate) && header.sequence == 1);
+    assert(reply.size() == sizeof(Udp::Header) && recorder.frames.size() == 4);
+
+    // 4. A sequence ahead of the expected one reports the gap and changes nothing.
+    handle(datagram(7, 5, "E"));
+    header = headerOf(reply);
+    assert(header.flags == (Udp::kFlagReply | Udp::kFlagGap) && header.sequence == 5);
+    assert(bodyOf(reply) == "GAP:3\n" && recorder.frames.size() == 4);
+    assert(sequencer.session(7)->expectedSequence == 3);
+    handle(datagram(7, 3, "E"));
+    assert(headerOf(reply).flags == Udp::kFlagReply && recorder.frames.back() == "E");
+
+    // 5. Sessions sequence independently.
+    assert(sequencer.session(8) == nullptr);
+    handle(datagram(8, 2, "X"));
+    assert(bodyOf(reply) == "GAP:1\n" && sequencer.session(8) == nullptr); // no entry until sequence 1
+    handle(datagram(8, 1, "X"));
+    assert(headerOf(reply).flags == Udp::kFlagReply && recorder.sessions.back() == Udp::engineSessionId(8));
+    assert(sequencer.session(7)->expectedSequence == 4 && sequencer.session(8)->expectedSequence == 2);
+
+    // 6. Malformed datagrams are rejected. A short one has no header to echo; a
+    //    truncated one echoes its header and does not advance the session.
+    handle(std::string(sizeof(Udp::Header) - 1, 'x'));
+    header = headerOf(reply);
+    assert(header.flags == (Udp::kFlagReply | Udp::kFlagRejected) && header.sessionId == 0);
+    assert(reply.size() == sizeof(Udp::Header));
+
+    const std::size_t applied = recorder.frames.size();
+    Udp::Sequencer::reject(datagram(7, 4, "partial fra"), reply);
+    header = headerOf(reply);
+    assert(header.flags == (Udp::kFlagReply | Udp::kFlagRejected) && header.sessionId == 7 && header.sequence == 4);
+    assert(reply.size() == sizeof(Udp::Header) && recorder.frames.size() == applied);
+    handle(datagram(7, 4, "F"));
+    assert(headerOf(reply).flags == Udp::kFlagReply && recorder.frames.back() == "F");
+
+    // 7. A session belongs to the address that opened it. Another peer is rejected
+    //    without touching it until the session has been idle for the timeout; then
+    //    the session expires (its orders are cancelled first) and the new peer
+    //    opens it again from sequence 1.
+    const std::uint64_t intruder = Udp::peerKey(0x0100007f, 4001);
+    handleFrom(sequencer, intruder, datagram(7, 5, "G"));
+    header = headerOf(reply);
+    assert(header.flags == (Udp::kFlagReply | Udp::kFlagRejected) && header.sessionId == 7);
+    handleFrom(sequencer, intruder, datagram(7, 1, "G"));
+    assert(headerOf(reply).flags == (Udp::kFlagReply | Udp::kFlagRejected));
+    assert(recorder.frames.back() == "F" && sequencer.session(7)->expectedSequence == 5 && expired.empty());
+
+    now += Udp::kSessionIdleTimeout;
+    handleFrom(sequencer, intruder, datagram(7, 1, "G"));
+    assert(expired == std::vector<std::uint32_t>{Udp::engineSessionId(7)});
+    assert(recorder.frames.size() >= 2 && recorder.frames[recorder.frames.size() - 2] == "EXPIRED");
+    assert(recorder.frames.back() == "G" && sequencer.session(7)->peer == intruder);
+    handle(datagram(7, 2, "H"));
+    assert(headerOf(reply).flags == (Udp::kFlagReply | Udp::kFlagRejected) && recorder.frames.back() == "G");
+
+    // 8. The table is capped. A new session that finds it full is rejected unless
+    //    an idle session can expire to make room.
+    Udp::Sequencer small(2, std::chrono::seconds(1));
+    expired.clear();
+    handleFrom(small, client, datagram(1, 1, "A"));
+    handleFrom(small, client, datagram(2, 1, "B"));
+    handleFrom(small, client, datagram(3, 1, "C"));
+    assert(headerOf(reply).flags == (Udp::kFlagReply | Udp::kFlagRejected) && recorder.frames.back() == "B");
+    assert(small.sessionCount() == 2 && small.session(3) == nullptr && expired.empty());
+
+    now += std::chrono::seconds(1);
+    handleFrom(small, client, datagram(2, 2, "B2")); // keeps session 2 active
+    now += std::chrono::milliseconds(500);
+    handleFrom(small, client, datagram(3, 1, "C"));
+    assert(headerOf(reply).flags == Udp::kFlagReply && recorder.frames.back() == "C");
+    assert(expired == std::vector<std::uint32_t>{Udp::engineSessionId(1)});
+    assert(small.sessionCount() == 2 && small.session(1) == nullptr && small.session(2) != nullptr);
+
+    std::cout << "All UDP protocol tests passed!" << std::endl;
+    return 0;
+}